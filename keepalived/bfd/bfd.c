@@ -129,7 +129,7 @@ bfd_copy_state(bfd_t *bfd, const bfd_t *bfd_old, bool all_fields)
 	 */
 	if (all_fields) {
 		bfd->local_diag = bfd_old->local_diag;
-		bfd->local_discr = bfd_old->local_discr;
+		bfd_set_local_discr(bfd, bfd_old->local_discr);
 		bfd->remote_min_tx_intv = bfd_old->remote_min_tx_intv;
 		bfd->remote_min_rx_intv = bfd_old->remote_min_rx_intv;
 		bfd->remote_detect_mult = bfd_old->remote_detect_mult;
@@ -158,7 +158,7 @@ bfd_init_state(bfd_t *bfd)
 	assert(bfd);
 
 	bfd_copy_state(bfd, &bfd0, true);
-	bfd->local_discr = bfd_get_random_discr(bfd_data);
+	bfd_set_local_discr(bfd, bfd_get_random_discr(bfd_data));
 	bfd->local_tx_intv = bfd->local_idle_tx_intv;
 }
 
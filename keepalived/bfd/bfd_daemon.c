@@ -59,8 +59,8 @@
 
 
 /* Global variables */
-int bfd_vrrp_event_pipe[2] = { -1, -1};
-int bfd_checker_event_pipe[2] = { -1, -1};
+bfd_event_chan_t bfd_vrrp_event_chan = { .name = "vrrp", .fd = -1 };
+bfd_event_chan_t bfd_checker_event_chan = { .name = "checker", .fd = -1 };
 
 /* Local variables */
 static const char *bfd_syslog_ident;
@@ -114,22 +114,18 @@ stop_bfd(int status)
 
 /* Daemon init sequence */
 bool
-open_bfd_pipes(void)
+open_bfd_event_chans(void)
 {
 #ifdef _WITH_VRRP_
-	/* Open BFD VRRP control pipe */
-	if (open_pipe(bfd_vrrp_event_pipe) == -1) {
-		log_message(LOG_ERR, "Unable to create BFD vrrp event pipe: %m");
+	/* Open BFD VRRP event ring */
+	if (!bfd_event_chan_open(&bfd_vrrp_event_chan))
 		return false;
-	}
 #endif
 
 #ifdef _WITH_LVS_
-	/* Open BFD checker control pipe */
-	if (open_pipe(bfd_checker_event_pipe) == -1) {
-		log_message(LOG_ERR, "Unable to create BFD checker event pipe: %m");
+	/* Open BFD checker event ring */
+	if (!bfd_event_chan_open(&bfd_checker_event_chan))
 		return false;
-	}
 #endif
 
 	return true;
@@ -267,6 +263,7 @@ reload_bfd_thread(__attribute__((unused)) thread_ref_t thread)
 
 	/* Destroy master thread */
 	bfd_dispatcher_release(bfd_data);
+	bfd_event_flush();
 	thread_cleanup_master(master, true);
 	thread_add_base_threads(master, false);
 
@@ -340,6 +337,7 @@ register_bfd_thread_addresses(void)
 	register_signal_thread_addresses();
 
 	register_bfd_scheduler_addresses();
+	register_bfd_event_addresses();
 
 	register_thread_address("bfd_dispatcher_init", bfd_dispatcher_init);
 	register_thread_address("reload_bfd_thread", reload_bfd_thread);
@@ -396,16 +394,10 @@ start_bfd_child(void)
 
 	prog_type = PROG_TYPE_BFD;
 
-	/* Close the read end of the event notification pipes, and the track_process fd */
-#ifdef _WITH_VRRP_
-	close(bfd_vrrp_event_pipe[0]);
-#ifdef _WITH_TRACK_PROCESS_
+	/* Close the track_process fd */
+#if defined _WITH_VRRP_ && defined _WITH_TRACK_PROCESS_
 	close_track_processes();
 #endif
-#endif
-#ifdef _WITH_LVS_
-	close(bfd_checker_event_pipe[0]);
-#endif
 
 #ifdef THREAD_DUMP
 	/* Remove anything we might have inherited from parent */
@@ -30,6 +30,7 @@
 #include "memory.h"
 #include "utils.h"
 #include "main.h"
+#include "rbtree.h"
 #include "assert_debug.h"
 
 /* Global vars */
@@ -86,6 +87,7 @@ alloc_bfd(const char *name)
 	bfd->sands_out = TIMER_NEVER;
 	bfd->sands_exp = TIMER_NEVER;
 	bfd->sands_rst = TIMER_NEVER;
+	RB_CLEAR_NODE(&bfd->rb_tx);
 
 	return bfd;
 }
@@ -94,8 +96,49 @@ void
 free_bfd(bfd_t *bfd)
 {
 	list_del_init(&bfd->e_list);
+	hlist_del_init(&bfd->e_discr);
+	hlist_del_init(&bfd->e_addr);
+	name_hash_del(&bfd->e_name);
 	FREE(bfd);
+}
 
+static unsigned __attribute__ ((const))
+bfd_hash(uint32_t val)
+{
+	return (val * 2654435761U) >> (32 - BFD_HASH_BITS);
+}
+
+static unsigned __attribute__ ((pure))
+bfd_addr_hash(const sockaddr_t *addr)
+{
+	const struct sockaddr_in6 *addr6;
+
+	if (addr->ss_family == AF_INET6) {
+		addr6 = PTR_CAST_CONST(struct sockaddr_in6, addr);
+		return bfd_hash(addr6->sin6_addr.s6_addr32[0] ^ addr6->sin6_addr.s6_addr32[1] ^
+				addr6->sin6_addr.s6_addr32[2] ^ addr6->sin6_addr.s6_addr32[3]);
+	}
+
+	return bfd_hash(PTR_CAST_CONST(struct sockaddr_in, addr)->sin_addr.s_addr);
+}
+
+/* Add a configured instance, which must have its neighbor address set */
+void
+add_bfd(bfd_t *bfd)
+{
+	list_add_tail(&bfd->e_list, &bfd_data->bfd);
+	name_hash_add(&bfd_data->name_hash, &bfd->e_name, bfd->iname);
+	hlist_add_head(&bfd->e_addr, &bfd_data->addr_hash[bfd_addr_hash(&bfd->nbr_addr)]);
+}
+
+/* The local discriminator must only be set by this, to keep the hash table up to date */
+void
+bfd_set_local_discr(bfd_t *bfd, uint32_t discr)
+{
+	hlist_del_init(&bfd->e_discr);
+	bfd->local_discr = discr;
+	if (discr)
+		hlist_add_head(&bfd->e_discr, &bfd_data->discr_hash[bfd_hash(discr)]);
 }
 static void
 free_bfd_list(list_head_t *l)
@@ -157,7 +200,7 @@ dump_bfd(FILE *fp, const bfd_t *bfd)
 #endif
 	/* If this is not at startup time, write some state variables */
 	if (fp) {
-		conf_write(fp, "   fd_out %d", bfd->fd_out);
+		conf_write(fp, "   fd_out %d%s", bfd->fd_out, bfd->tx_sock ? " (shared)" : "");
 		conf_write(fp, "   thread_open_fd_out 0x%p", bfd->thread_open_fd_out);
 		conf_write(fp, "   thread_out 0x%p", bfd->thread_out);
 		conf_write_sands(fp, "sands_out", bfd->sands_out);
@@ -205,17 +248,10 @@ dump_bfd_list(FILE *fp, const list_head_t *l)
 static bfd_t * __attribute__ ((pure))
 find_bfd_by_name2(const char *name, const bfd_data_t *data)
 {
-	bfd_t *bfd;
-
 	assert(name);
 	assert(data);
 
-	list_for_each_entry(bfd, &data->bfd, e_list) {
-		if (!strcmp(name, bfd->iname))
-			return bfd;
-	}
-
-	return NULL;
+	return name_hash_find_entry(&data->name_hash, name, bfd_t, e_name);
 }
 
 bfd_t * __attribute__ ((pure))
@@ -256,6 +292,7 @@ free_bfd_data(bfd_data_t *data)
 	assert(data);
 
 	free_bfd_list(&data->bfd);
+	name_hash_free(&data->name_hash);
 	FREE(data);
 }
 
@@ -353,11 +390,12 @@ bfd_t * __attribute__ ((pure))
 find_bfd_by_addr(const sockaddr_t *nbr_addr, const sockaddr_t *local_addr)
 {
 	bfd_t *bfd;
+	hlist_node_t *n;
 	assert(nbr_addr);
 	assert(local_addr);
 	assert(bfd_data);
 
-	list_for_each_entry(bfd, &bfd_data->bfd, e_list) {
+	hlist_for_each_entry(bfd, n, &bfd_data->addr_hash[bfd_addr_hash(nbr_addr)], e_addr) {
 		if (&bfd->nbr_addr == nbr_addr)
 			continue;
 
@@ -381,12 +419,13 @@ find_bfd_by_addr(const sockaddr_t *nbr_addr, const sockaddr_t *local_addr)
 }
 
 /* Looks up bfd instance by local discriminator */
-bfd_t * __attribute__ ((pure))
-find_bfd_by_discr(const uint32_t discr)
+static bfd_t * __attribute__ ((pure))
+find_bfd_by_discr2(const uint32_t discr, const bfd_data_t *data)
 {
 	bfd_t *bfd;
+	hlist_node_t *n;
 
-	list_for_each_entry(bfd, &bfd_data->bfd, e_list) {
+	hlist_for_each_entry(bfd, n, &data->discr_hash[bfd_hash(discr)], e_discr) {
 		if (bfd->local_discr == discr)
 			return bfd;
 	}
@@ -394,6 +433,12 @@ find_bfd_by_discr(const uint32_t discr)
 	return NULL;
 }
 
+bfd_t * __attribute__ ((pure))
+find_bfd_by_discr(const uint32_t discr)
+{
+	return find_bfd_by_discr2(discr, bfd_data);
+}
+
 /*
  *	Utility functions
  */
@@ -419,7 +464,6 @@ rand_intv(uint32_t min, uint32_t max)
 uint32_t
 bfd_get_random_discr(bfd_data_t *data)
 {
-	bfd_t *bfd;
 	uint32_t discr;
 
 	assert(data);
@@ -430,12 +474,8 @@ bfd_get_random_discr(bfd_data_t *data)
 		discr = (rand_intv(1, UINT32_MAX) & ~1) | (time_now.tv_sec & 1);
 
 		/* Check for collisions */
-		list_for_each_entry(bfd, &data->bfd, e_list) {
-			if (bfd->local_discr == discr) {
-				discr = 0;
-				break;
-			}
-		}
+		if (find_bfd_by_discr2(discr, data))
+			discr = 0;
 	} while (!discr);
 
 	return discr;
@@ -23,6 +23,9 @@
 #include "config.h"
 
 #include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
 
 #include "bfd.h"
 #include "bfd_event.h"
@@ -35,11 +38,110 @@
 #include "global_data.h"
 #include "assert_debug.h"
 
+/* Creates the ring and its eventfd. Must be called before the BFD process
+ * and the consumer are forked */
+bool
+bfd_event_chan_open(bfd_event_chan_t *chan)
+{
+	chan->ring = mmap(NULL, sizeof(bfd_event_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (chan->ring == MAP_FAILED) {
+		chan->ring = NULL;
+		log_message(LOG_ERR, "Unable to map BFD %s event ring: %m", chan->name);
+		return false;
+	}
+
+	if ((chan->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
+		log_message(LOG_ERR, "Unable to create BFD %s event fd: %m", chan->name);
+		bfd_event_chan_close(chan);
+		return false;
+	}
+
+	return true;
+}
+
+void
+bfd_event_chan_close(bfd_event_chan_t *chan)
+{
+	if (chan->ring) {
+		munmap(chan->ring, sizeof(bfd_event_ring_t));
+		chan->ring = NULL;
+	}
+
+	if (chan->fd != -1) {
+		close(chan->fd);
+		chan->fd = -1;
+	}
+}
+
+static void
+bfd_event_ring_doorbell(bfd_event_chan_t *chan)
+{
+	uint64_t one = 1;
+
+	chan->doorbell = false;
+
+	if (write(chan->fd, &one, sizeof(one)) == -1 && __test_bit(LOG_DETAIL_BIT, &debug))
+		log_message(LOG_ERR, "BFD %s eventfd write() error %m", chan->name);
+}
+
+/* Wakes the consumer once for all the events queued since it last ran */
+static void
+bfd_event_doorbell_thread(thread_ref_t thread)
+{
+	bfd_event_ring_doorbell(THREAD_ARG(thread));
+}
+
+static void
+bfd_event_put(bfd_event_chan_t *chan, const bfd_event_t *evt, const char *iname)
+{
+	bfd_event_ring_t *ring = chan->ring;
+	uint32_t head = ring->head;
+
+	if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= BFD_EVENT_RING_SIZE) {
+		if (!chan->overflow) {
+			log_message(LOG_ERR, "(%s) BFD %s event ring full, event lost", iname, chan->name);
+			chan->overflow = true;
+		}
+		return;
+	}
+	chan->overflow = false;
+
+	ring->evt[head & (BFD_EVENT_RING_SIZE - 1)] = *evt;
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+	if (!chan->doorbell) {
+		chan->doorbell = true;
+		thread_add_event(master, bfd_event_doorbell_thread, chan, 0);
+	}
+}
+
+/* Handles all the events in the ring. Called by the consumer when the
+ * eventfd is readable */
+void
+bfd_event_receive(bfd_event_chan_t *chan, void (*handler)(const bfd_event_t *))
+{
+	bfd_event_ring_t *ring = chan->ring;
+	bfd_event_t evt;
+	uint64_t count;
+	uint32_t tail;
+
+	/* Reset the eventfd before emptying the ring, so that an event added
+	 * after we have finished will wake us again */
+	if (read(chan->fd, &count, sizeof(count)) == -1 && !check_EAGAIN(errno))
+		log_message(LOG_INFO, "BFD %s eventfd read() error %m", chan->name);
+
+	for (tail = ring->tail; tail != __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE); ) {
+		evt = ring->evt[tail & (BFD_EVENT_RING_SIZE - 1)];
+		__atomic_store_n(&ring->tail, ++tail, __ATOMIC_RELEASE);
+
+		handler(&evt);
+	}
+}
+
 void
 bfd_event_send(bfd_t *bfd)
 {
 	bfd_event_t evt;
-	int ret;
 #ifdef _WITH_VRRP_
 	bool vrrp_running = running_vrrp();
 #endif
@@ -66,20 +168,35 @@ bfd_event_send(bfd_t *bfd)
 	evt.sent_time = timer_now();
 
 #ifdef _WITH_VRRP_
-	if (vrrp_running && bfd->vrrp) {
-		ret = write(bfd_vrrp_event_pipe[1], &evt, sizeof evt);
-		if (ret == -1 && __test_bit(LOG_DETAIL_BIT, &debug))
-			log_message(LOG_ERR, "(%s) vrrp pipe write() error %m",
-				    bfd->iname);
-	}
+	if (vrrp_running && bfd->vrrp)
+		bfd_event_put(&bfd_vrrp_event_chan, &evt, bfd->iname);
 #endif
 
 #ifdef _WITH_LVS_
-	if (checker_running && bfd->checker) {
-		ret = write(bfd_checker_event_pipe[1], &evt, sizeof evt);
-		if (ret == -1 && __test_bit(LOG_DETAIL_BIT, &debug))
-			log_message(LOG_ERR, "(%s) checker pipe write() error %m",
-				    bfd->iname);
-	}
+	if (checker_running && bfd->checker)
+		bfd_event_put(&bfd_checker_event_chan, &evt, bfd->iname);
 #endif
 }
+
+/* Wakes the consumers now for any events still waiting for a doorbell
+ * thread, since the threads are about to be discarded on a reload */
+void
+bfd_event_flush(void)
+{
+#ifdef _WITH_VRRP_
+	if (bfd_vrrp_event_chan.doorbell)
+		bfd_event_ring_doorbell(&bfd_vrrp_event_chan);
+#endif
+#ifdef _WITH_LVS_
+	if (bfd_checker_event_chan.doorbell)
+		bfd_event_ring_doorbell(&bfd_checker_event_chan);
+#endif
+}
+
+#ifdef THREAD_DUMP
+void
+register_bfd_event_addresses(void)
+{
+	register_thread_address("bfd_event_doorbell_thread", bfd_event_doorbell_thread);
+}
+#endif
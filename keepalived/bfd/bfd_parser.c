@@ -272,6 +272,7 @@ bfd_vrrp_end_handler(void)
 	}
 
 	list_add_tail(&tbfd->e_list, &vrrp_data->vrrp_track_bfds);
+	name_hash_add(&vrrp_data->vrrp_track_bfd_by_name, &tbfd->e_name, tbfd->bname);
 }
 #endif
 
@@ -287,6 +288,7 @@ bfd_checker_end_handler(void)
 	}
 
 	list_add_tail(&cbfd->e_list, &check_data->track_bfds);
+	name_hash_add(&check_data->track_bfd_by_name, &cbfd->e_name, cbfd->bname);
 }
 #endif
 
@@ -357,7 +359,7 @@ bfd_end_handler(void)
 #endif
 #endif
 
-	list_add_tail(&bfd->e_list, &bfd_data->bfd);
+	add_bfd(bfd);
 }
 
 #ifdef _WITH_VRRP_
@@ -368,7 +370,7 @@ bfd_vrrp_handler(const vector_t *strvec)
 	if (!strvec)
 		return;
 
-	current_bfd = alloc_vrrp_tracked_bfd(strvec_slot(strvec, 1), &vrrp_data->vrrp_track_bfds);
+	current_bfd = alloc_vrrp_tracked_bfd(strvec_slot(strvec, 1));
 
 	specified_event_processes = 0;
 }
@@ -420,12 +422,10 @@ bfd_checker_handler(const vector_t *strvec)
 
 	name = vector_slot(strvec, 1);
 
-	list_for_each_entry(cbfd, &check_data->track_bfds, e_list) {
-		if (!strcmp(name, cbfd->bname)) {
-			report_config_error(CONFIG_GENERAL_ERROR, "BFD %s already specified", name);
-			skip_block(true);
-			return;
-		}
+	if (name_hash_find(&check_data->track_bfd_by_name, name)) {
+		report_config_error(CONFIG_GENERAL_ERROR, "BFD %s already specified", name);
+		skip_block(true);
+		return;
 	}
 
 	PMALLOC(cbfd);
@@ -41,13 +41,42 @@
 #include "bitops.h"
 #include "utils.h"
 #include "signals.h"
+#include "global_data.h"
+#include "rbtree.h"
 #include "assert_debug.h"
 
 
+/* An output socket shared by all sessions with the same address family,
+ * source address and TTL */
+struct _bfd_tx_sock {
+	sa_family_t		family;
+	sockaddr_t		src_addr;	/* Bound address and port, if any */
+	uint8_t			ttl;
+	int			fd;
+	unsigned		refcnt;
+	list_head_t		e_list;
+};
+
 /* Locals */
+static bool bfd_shared_tx;
+static LIST_HEAD_INITIALIZE(bfd_tx_socks);
+
+/* Sessions using shared sockets, by next transmit time */
+static rb_root_cached_t bfd_tx_queue = RB_ROOT_CACHED;
+static thread_ref_t bfd_tx_timer;
+static unsigned long bfd_tx_max_early;
+
+/* Control packets sent by a single sendmmsg() */
+static struct mmsghdr bfd_tx_mmsg[BFD_SEND_BATCH];
+static struct iovec bfd_tx_iov[BFD_SEND_BATCH];
+static bfdhdr_t bfd_tx_hdr[BFD_SEND_BATCH];
+static bfd_t *bfd_tx_bfd[BFD_SEND_BATCH];
+static bfd_t *bfd_tx_batch[BFD_SEND_BATCH];
+
 static int bfd_send_packet(int, bfdpkt_t *, bool);
 static void bfd_sender_schedule(bfd_t *);
 static int bfd_open_fd_out(bfd_t *);
+static void bfd_tx_thread(thread_ref_t);
 
 static void bfd_state_down(bfd_t *, uint8_t diag);
 
@@ -130,6 +159,187 @@ get_jitter(bfd_t * bfd)
 	return rand_intv(min_jitter, bfd->local_tx_intv / 4);	/* 25% <=> / 4 */
 }
 
+/*
+ * Shared socket transmit queue
+ *
+ * Sessions using a shared output socket are not given a sender thread
+ * each, but are queued by their next (jittered) transmit time. When the
+ * first becomes due, every queued session which is due within
+ * 1/BFD_TX_EARLY_DIV of its transmit interval is sent in the same
+ * sendmmsg() call. A session's randomly jittered interval is therefore
+ * shortened by at most 5%, so the intervals stay spread over the range
+ * RFC5880 requires, rather than clustering at its lower bound.
+ */
+#define BFD_TX_EARLY_DIV	20
+
+/* Declare bfd_timer_less() rbtree compare function */
+RB_TIMER_LESS(bfd, rb_tx);
+
+/* Queues a session to send its next periodic packet in delay usecs */
+static void
+bfd_tx_enqueue(bfd_t *bfd, unsigned long delay)
+{
+	assert(RB_EMPTY_NODE(&bfd->rb_tx));
+
+	bfd->sands = timer_add_long(time_now, delay);
+
+	/* The furthest ahead of its due time a session's packet can be sent */
+	if (bfd->local_tx_intv / BFD_TX_EARLY_DIV > bfd_tx_max_early)
+		bfd_tx_max_early = bfd->local_tx_intv / BFD_TX_EARLY_DIV;
+
+	/* Adjust the timer if this is now the first to send */
+	if (rb_add_cached(&bfd->rb_tx, &bfd_tx_queue, bfd_timer_less)) {
+		if (bfd_tx_timer)
+			timer_thread_update_timeout(bfd_tx_timer, delay);
+		else
+			bfd_tx_timer = thread_add_timer(master, bfd_tx_thread, NULL, delay);
+	}
+}
+
+static void
+bfd_tx_dequeue(bfd_t *bfd)
+{
+	assert(!RB_EMPTY_NODE(&bfd->rb_tx));
+
+	rb_erase_cached(&bfd->rb_tx, &bfd_tx_queue);
+	RB_CLEAR_NODE(&bfd->rb_tx);
+
+	if (bfd_tx_timer && RB_EMPTY_ROOT(&bfd_tx_queue.rb_root)) {
+		thread_cancel(bfd_tx_timer);
+		bfd_tx_timer = NULL;
+	}
+}
+
+/* Returns true if the session's next periodic packet is due, or can be
+ * sent early with a batch. It is only sent early if it is due within
+ * 1/BFD_TX_EARLY_DIV of local_tx_intv, and its interval then remains at
+ * least 75% of local_tx_intv (RFC5880 6.8.7). */
+static bool __attribute__ ((pure))
+bfd_tx_in_window(const bfd_t *bfd)
+{
+	timeval_t earliest;
+
+	if (!timercmp(&time_now, &bfd->sands, <))
+		return true;
+
+	/* The session has not sent a periodic packet since it was started,
+	 * resumed or reloaded, so there is no interval to keep to */
+	if (!timerisset(&bfd->last_tx))
+		return false;
+
+	earliest = timer_sub_long(bfd->sands, bfd->local_tx_intv / BFD_TX_EARLY_DIV);
+	if (timercmp(&time_now, &earliest, <))
+		return false;
+
+	earliest = timer_add_long(bfd->last_tx, bfd->local_tx_intv - bfd->local_tx_intv / 4);
+
+	return !timercmp(&time_now, &earliest, <);
+}
+
+/* Sends the packets for all the batched sessions using the same socket as
+ * the first, and queues their next packets */
+static unsigned
+bfd_tx_send_batch(unsigned num)
+{
+	bfd_tx_sock_t *sock = NULL;
+	bfdpkt_t pkt;
+	bfd_t *bfd;
+	unsigned i, n = 0, sent = 0;
+	int ret;
+
+	for (i = 0; i < num; i++) {
+		bfd = bfd_tx_batch[i];
+
+		if (!sock)
+			sock = bfd->tx_sock;
+		else if (bfd->tx_sock != sock) {
+			/* Keep this one for the next sendmmsg() */
+			bfd_tx_batch[i - n] = bfd;
+			continue;
+		}
+
+		bfd_build_packet(&pkt, bfd, PTR_CAST(char, &bfd_tx_hdr[n]), sizeof(bfd_tx_hdr[n]));
+		bfd_tx_iov[n].iov_base = &bfd_tx_hdr[n];
+		bfd_tx_iov[n].iov_len = pkt.len;
+		bfd_tx_mmsg[n].msg_hdr.msg_name = &bfd->nbr_addr;
+		bfd_tx_mmsg[n].msg_hdr.msg_namelen = bfd->nbr_addr.ss_family == AF_INET ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
+		bfd_tx_mmsg[n].msg_hdr.msg_iov = &bfd_tx_iov[n];
+		bfd_tx_mmsg[n].msg_hdr.msg_iovlen = 1;
+		bfd_tx_bfd[n++] = bfd;
+	}
+
+	while (sent < n) {
+		ret = sendmmsg(sock->fd, &bfd_tx_mmsg[sent], n - sent, 0);
+		if (ret > 0) {
+			for (i = sent; i < sent + (unsigned)ret; i++)
+				bfd_tx_bfd[i]->send_error = false;
+			sent += (unsigned)ret;
+			continue;
+		}
+
+		/* The first unsent message failed */
+		bfd = bfd_tx_bfd[sent++];
+		if (!bfd->send_error) {
+			log_message(LOG_ERR, "(%s) Error sending packet (%m)", bfd->iname);
+			bfd->send_error = true;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		bfd = bfd_tx_bfd[i];
+
+		/* Reset final flag if set */
+		bfd->final = 0;
+
+		bfd->last_tx = time_now;
+		bfd_sender_schedule(bfd);
+	}
+
+	return num - n;
+}
+
+/* Sends the periodic packets of all sessions that are due, together with
+ * those of any other session for which now is within its jitter window */
+static void
+bfd_tx_thread(__attribute__((unused)) thread_ref_t thread)
+{
+	rb_node_t *node, *next;
+	timeval_t window_end;
+	bfd_t *bfd;
+	unsigned num = 0;
+
+	bfd_tx_timer = NULL;
+
+	window_end = timer_add_long(time_now, bfd_tx_max_early);
+
+	for (node = rb_first_cached(&bfd_tx_queue); node; node = next) {
+		bfd = rb_entry(node, bfd_t, rb_tx);
+		if (timercmp(&bfd->sands, &window_end, >))
+			break;
+
+		next = rb_next(node);
+
+		if (!bfd_tx_in_window(bfd))
+			continue;
+
+		rb_erase_cached(node, &bfd_tx_queue);
+		RB_CLEAR_NODE(node);
+
+		bfd_tx_batch[num++] = bfd;
+		if (num == BFD_SEND_BATCH)
+			num = bfd_tx_send_batch(num);
+	}
+
+	while (num)
+		num = bfd_tx_send_batch(num);
+
+	if (!bfd_tx_timer && (node = rb_first_cached(&bfd_tx_queue))) {
+		bfd = rb_entry(node, bfd_t, rb_tx);
+		bfd_tx_timer = thread_add_timer(master, bfd_tx_thread, NULL,
+						timercmp(&bfd->sands, &time_now, >) ? timer_long(bfd->sands) - timer_long(time_now) : 1);
+	}
+}
+
 /* Schedules bfd_sender_thread to run in local_tx_intv minus applied jitter */
 static void
 bfd_sender_schedule(bfd_t *bfd)
@@ -137,6 +347,11 @@ bfd_sender_schedule(bfd_t *bfd)
 	assert(bfd);
 	assert(!bfd->thread_out);
 
+	if (bfd->tx_sock) {
+		bfd_tx_enqueue(bfd, bfd->local_tx_intv - get_jitter(bfd));
+		return;
+	}
+
 	bfd->thread_out =
 	    thread_add_timer(master, bfd_sender_thread, bfd,
 			     bfd->local_tx_intv - get_jitter(bfd));
@@ -147,6 +362,12 @@ static void
 bfd_sender_cancel(bfd_t *bfd)
 {
 	assert(bfd);
+
+	if (!RB_EMPTY_NODE(&bfd->rb_tx)) {
+		bfd_tx_dequeue(bfd);
+		return;
+	}
+
 	assert(bfd->thread_out);
 
 	thread_cancel(bfd->thread_out);
@@ -158,6 +379,13 @@ static void
 bfd_sender_reschedule(bfd_t *bfd)
 {
 	assert(bfd);
+
+	if (!RB_EMPTY_NODE(&bfd->rb_tx)) {
+		bfd_tx_dequeue(bfd);
+		bfd_tx_enqueue(bfd, bfd->local_tx_intv - get_jitter(bfd));
+		return;
+	}
+
 	assert(bfd->thread_out);
 
 	timer_thread_update_timeout(bfd->thread_out, bfd->local_tx_intv - get_jitter(bfd));
@@ -169,7 +397,7 @@ bfd_sender_scheduled(bfd_t *bfd)
 {
 	assert(bfd);
 
-	return bfd->thread_out != NULL;
+	return bfd->thread_out != NULL || !RB_EMPTY_NODE(&bfd->rb_tx);
 }
 
 /* Suspends sender thread. Needs freshly updated time_now */
@@ -177,10 +405,15 @@ static void
 bfd_sender_suspend(bfd_t * bfd)
 {
 	assert(bfd);
-	assert(bfd->thread_out);
+	assert(bfd_sender_scheduled(bfd));
 	assert(bfd->sands_out == TIMER_NEVER);
 
-	bfd->sands_out = thread_time_to_wakeup(bfd->thread_out);
+	if (bfd->thread_out)
+		bfd->sands_out = thread_time_to_wakeup(bfd->thread_out);
+	else if (timercmp(&bfd->sands, &time_now, >))
+		bfd->sands_out = timer_long(bfd->sands) - timer_long(time_now);
+	else
+		bfd->sands_out = 1;
 	bfd_sender_cancel(bfd);
 }
 
@@ -189,12 +422,18 @@ static void
 bfd_sender_resume(bfd_t *bfd)
 {
 	assert(bfd);
-	assert(!bfd->thread_out);
+	assert(!bfd_sender_scheduled(bfd));
 	assert(bfd->sands_out != TIMER_NEVER);
 
-	if (!bfd->passive || bfd->local_state == BFD_STATE_UP)
-		bfd->thread_out =
-		    thread_add_timer(master, bfd_sender_thread, bfd, bfd->sands_out);
+	if (!bfd->passive || bfd->local_state == BFD_STATE_UP) {
+		if (bfd->tx_sock) {
+			/* Don't send early with a batch until it has sent again */
+			timerclear(&bfd->last_tx);
+			bfd_tx_enqueue(bfd, bfd->sands_out);
+		} else
+			bfd->thread_out =
+			    thread_add_timer(master, bfd_sender_thread, bfd, bfd->sands_out);
+	}
 	bfd->sands_out = TIMER_NEVER;
 }
 
@@ -502,7 +741,7 @@ bfd_state_down(bfd_t *bfd, uint8_t diag)
 	int old_state = bfd->local_state;
 
 	if (bfd->local_state == BFD_STATE_UP)
-		bfd->local_discr = bfd_get_random_discr(bfd_data);
+		bfd_set_local_discr(bfd, bfd_get_random_discr(bfd_data));
 
 	if (bfd->local_state == BFD_STATE_UP ||
 	    __test_bit(LOG_EXTRA_DETAIL_BIT, &debug))
@@ -1057,10 +1296,11 @@ read_local_port_range(uint32_t port_limits[2])
 	return true;
 }
 
-/* Prepares UDP socket for sending data to neighbor */
+/* Prepares UDP socket for sending data to neighbor, returns -1 on error */
 static int
-bfd_open_fd_out(bfd_t *bfd)
+bfd_open_socket_out(bfd_t *bfd)
 {
+	int fd;
 	int ttl;
 	int ret;
 	uint32_t port_limits[2];
@@ -1068,13 +1308,12 @@ bfd_open_fd_out(bfd_t *bfd)
 	socklen_t sockaddr_len;
 
 	assert(bfd);
-	assert(bfd->fd_out == -1);
 
-	bfd->fd_out = socket(bfd->nbr_addr.ss_family, SOCK_DGRAM, IPPROTO_UDP);
-	if (bfd->fd_out == -1) {
+	fd = socket(bfd->nbr_addr.ss_family, SOCK_DGRAM, IPPROTO_UDP);
+	if (fd == -1) {
 		log_message(LOG_ERR, "(%s) socket() error (%m)",
 			    bfd->iname);
-		return 1;
+		return -1;
 	}
 
 	if (bfd->src_addr.ss_family) {
@@ -1102,7 +1341,7 @@ bfd_open_fd_out(bfd_t *bfd)
 			else
 				PTR_CAST(struct sockaddr_in6, &bfd->src_addr)->sin6_port = htons(port);
 
-			ret = bind(bfd->fd_out, PTR_CAST(struct sockaddr, &bfd->src_addr), sockaddr_len);
+			ret = bind(fd, PTR_CAST(struct sockaddr, &bfd->src_addr), sockaddr_len);
 
 			if (ret == -1 && errno == EADDRINUSE) {
 				/* Port already in use, try next */
@@ -1118,9 +1357,8 @@ bfd_open_fd_out(bfd_t *bfd)
 
 		if (ret == -1) {
 			log_message(LOG_ERR, "(%s) bind() error (%m)", bfd->iname);
-			close(bfd->fd_out);
-			bfd->fd_out = -1;
-			return 1;
+			close(fd);
+			return -1;
 		}
 	} else {
 		/* We have a problem here - we do not have a source address, and so
@@ -1131,20 +1369,103 @@ bfd_open_fd_out(bfd_t *bfd)
 
 	ttl = bfd->ttl;
 	if (bfd->nbr_addr.ss_family == AF_INET)
-		ret = setsockopt(bfd->fd_out, IPPROTO_IP, IP_TTL, &ttl, sizeof (ttl));
+		ret = setsockopt(fd, IPPROTO_IP, IP_TTL, &ttl, sizeof (ttl));
 	else
-		ret = setsockopt(bfd->fd_out, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &ttl, sizeof (ttl));
+		ret = setsockopt(fd, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &ttl, sizeof (ttl));
 
 	if (ret == -1) {
 		log_message(LOG_ERR, "(%s) setsockopt() error (%m)", bfd->iname);
-		close(bfd->fd_out);
-		bfd->fd_out = -1;
-		return 1;
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/* Returns the shared socket for the session's address family, source
+ * address and TTL, if there is one */
+static bfd_tx_sock_t * __attribute__ ((pure))
+bfd_find_tx_sock(const bfd_t *bfd)
+{
+	bfd_tx_sock_t *sock;
+
+	list_for_each_entry(sock, &bfd_tx_socks, e_list) {
+		if (sock->family == bfd->nbr_addr.ss_family &&
+		    sock->ttl == bfd->ttl &&
+		    sock->src_addr.ss_family == bfd->src_addr.ss_family &&
+		    (!sock->src_addr.ss_family || !inet_sockaddrcmp(&sock->src_addr, &bfd->src_addr)))
+			return sock;
 	}
 
+	return NULL;
+}
+
+/* Attaches the session to its shared socket, opening the socket if there
+ * isn't one yet */
+static int
+bfd_open_tx_sock(bfd_t *bfd)
+{
+	bfd_tx_sock_t *sock;
+	int fd;
+
+	if (!(sock = bfd_find_tx_sock(bfd))) {
+		if ((fd = bfd_open_socket_out(bfd)) == -1)
+			return 1;
+
+		PMALLOC(sock);
+		INIT_LIST_HEAD(&sock->e_list);
+		sock->family = bfd->nbr_addr.ss_family;
+		sock->src_addr = bfd->src_addr;
+		sock->ttl = bfd->ttl;
+		sock->fd = fd;
+		list_add_tail(&sock->e_list, &bfd_tx_socks);
+	} else if (sock->src_addr.ss_family) {
+		/* Use the port the socket is bound to */
+		bfd->src_addr = sock->src_addr;
+	}
+
+	sock->refcnt++;
+	bfd->tx_sock = sock;
+	bfd->fd_out = sock->fd;
+
+	return 0;
+}
+
+/* Opens the output socket for the session */
+static int
+bfd_open_fd_out(bfd_t *bfd)
+{
+	assert(bfd);
+	assert(bfd->fd_out == -1);
+
+	if (bfd_shared_tx)
+		return bfd_open_tx_sock(bfd);
+
+	if ((bfd->fd_out = bfd_open_socket_out(bfd)) == -1)
+		return 1;
+
 	return 0;
 }
 
+/* Closes the session's output socket, or detaches it from its shared socket */
+static void
+bfd_close_fd_out(bfd_t *bfd)
+{
+	bfd_tx_sock_t *sock = bfd->tx_sock;
+
+	if (sock) {
+		bfd->tx_sock = NULL;
+		if (!--sock->refcnt) {
+			close(sock->fd);
+			list_del_init(&sock->e_list);
+			FREE(sock);
+		}
+	} else
+		close(bfd->fd_out);
+
+	bfd->fd_out = -1;
+}
+
 /* Opens all needed sockets */
 static int
 bfd_open_fds(bfd_data_t *data)
@@ -1285,10 +1606,8 @@ bfd_dispatcher_release(bfd_data_t *data)
 		if (bfd_open_fd_out_scheduled(bfd))
 			bfd_open_fd_out_cancel(bfd);
 
-		if (bfd->fd_out != -1) {
-			close(bfd->fd_out);
-			bfd->fd_out = -1;
-		}
+		if (bfd->fd_out != -1)
+			bfd_close_fd_out(bfd);
 	}
 
 	cancel_signal_read_thread();
@@ -1303,6 +1622,12 @@ bfd_dispatcher_init(thread_ref_t thread)
 	assert(thread);
 
 	data = THREAD_ARG(thread);
+
+	/* Sessions keep their sockets until the dispatcher is released, so
+	 * this is only changed when none are open */
+	bfd_shared_tx = global_data->bfd_shared_socket;
+	bfd_tx_max_early = 0;
+
 	if (bfd_open_fds(data))
 		exit(EXIT_FAILURE);
 
@@ -1315,6 +1640,7 @@ void
 register_bfd_scheduler_addresses(void)
 {
 	register_thread_address("bfd_sender_thread", bfd_sender_thread);
+	register_thread_address("bfd_tx_thread", bfd_tx_thread);
 	register_thread_address("bfd_expire_thread", bfd_expire_thread);
 	register_thread_address("bfd_reset_thread", bfd_reset_thread);
 	register_thread_address("bfd_receiver_thread", bfd_receiver_thread);
@@ -62,6 +62,16 @@ bool do_checker_debug;
 #endif
 checker_t *current_checker;
 
+/* Histogram of the number of checkers launched per tick, with buckets
+ * for 0, 1, 2-3, 4-7, ... launches */
+#define CHECKER_LAUNCH_TICK	(TIMER_HZ / 10)
+#define CHECKER_LAUNCH_BUCKETS	8
+
+static unsigned long launch_hist[CHECKER_LAUNCH_BUCKETS];
+static unsigned long launch_tick;
+static unsigned launch_tick_count;
+static unsigned launch_tick_max;
+
 /* free checker data */
 void
 free_checker(checker_t *checker)
@@ -455,6 +465,23 @@ install_checker_common_keywords(bool connection_keywords)
 	install_keyword("log_all_failures", &log_all_failures_handler);
 }
 
+static void
+dump_launch_histogram(FILE *fp)
+{
+	unsigned i;
+
+	conf_write(fp, "------< Checker launches per %d ms >------", CHECKER_LAUNCH_TICK / (TIMER_HZ / 1000));
+	for (i = 0; i < CHECKER_LAUNCH_BUCKETS; i++) {
+		if (i <= 1)
+			conf_write(fp, " %u: %lu", i, launch_hist[i]);
+		else if (i == CHECKER_LAUNCH_BUCKETS - 1)
+			conf_write(fp, " %u+: %lu", 1U << (i - 1), launch_hist[i]);
+		else
+			conf_write(fp, " %u-%u: %lu", 1U << (i - 1), (1U << i) - 1, launch_hist[i]);
+	}
+	conf_write(fp, " Max = %u", launch_tick_max);
+}
+
 /* dump the checkers_queue */
 void
 dump_checkers_queue(FILE *fp)
@@ -462,6 +489,7 @@ dump_checkers_queue(FILE *fp)
 	if (!list_empty(&checkers_queue)) {
 		conf_write(fp, "------< Health checkers >------");
 		dump_checker_list(fp, &checkers_queue);
+		dump_launch_histogram(fp);
 	}
 }
 
@@ -507,12 +535,94 @@ free_checkers_queue(void)
 	free_checker_list(&checkers_queue);
 }
 
+/* Add the number of launches in the last tick to the histogram */
+static void
+checker_count_launch(void)
+{
+	unsigned long tick = timer_long(time_now) / CHECKER_LAUNCH_TICK;
+	unsigned bucket;
+
+	if (tick != launch_tick) {
+		if (launch_tick) {
+			for (bucket = 0; launch_tick_count >> bucket && bucket < CHECKER_LAUNCH_BUCKETS - 1; bucket++);
+			launch_hist[bucket]++;
+
+			/* Ticks with no launches */
+			launch_hist[0] += tick - launch_tick - 1;
+		}
+		launch_tick = tick;
+		launch_tick_count = 0;
+	}
+
+	if (++launch_tick_count > launch_tick_max)
+		launch_tick_max = launch_tick_count;
+}
+
+static void
+checker_launch_thread(thread_ref_t thread)
+{
+	checker_t *checker = THREAD_ARG(thread);
+
+	checker_count_launch();
+
+	(*checker->launch)(thread);
+}
+
+static uint32_t __attribute__ ((pure))
+fnv1a_str(uint32_t hash, const char *str)
+{
+	for (; *str; str++)
+		hash = (hash ^ (unsigned char)*str) * 16777619U;
+
+	return hash;
+}
+
+/* Consistent hash of the checker, so that it keeps the same phase
+ * slot across restarts and reloads */
+static uint32_t
+checker_hash(const checker_t *checker)
+{
+	uint32_t hash = 2166136261U;
+
+	/* FMT_VS and FMT_RS may share a static buffer */
+	hash = fnv1a_str(hash, FMT_VS(checker->vs));
+	hash = fnv1a_str(hash, FMT_RS(checker->rs, checker->vs));
+	if (checker->co)
+		hash = fnv1a_str(hash, inet_sockaddrtopair(&checker->co->dst));
+
+	return (hash ^ checker->checker_funcs->type) * 16777619U;
+}
+
+/* Schedule the next run of a checker. A run after delay_loop is moved
+ * to the nearest time in the checker's phase slot, so that the checkers
+ * stay evenly spread over their delay_loop rather than drifting into
+ * synchronised bursts as the time taken by each check varies. */
+void
+checker_add_timer(checker_t *checker, unsigned long delay)
+{
+	unsigned long now, target, rem;
+
+	if (delay && delay == checker->delay_loop) {
+		now = timer_long(time_now);
+		target = now + delay;
+		rem = (target % delay + delay - checker->phase) % delay;
+		if (rem <= delay / 2)
+			target -= rem;
+		else
+			target += delay - rem;
+		delay = target - now;
+	}
+
+	thread_add_timer(master, checker_launch_thread, checker, delay);
+}
+
 /* register checkers to the global I/O scheduler */
 void
 register_checkers_thread(void)
 {
 	checker_t *checker;
 	unsigned long warmup;
+	uint32_t hash;
 
 	list_for_each_entry(checker, &checkers_queue, e_list) {
 		if (checker->launch) {
@@ -524,16 +634,16 @@ register_checkers_thread(void)
 					    , FMT_RS(checker->rs, checker->vs)
 					    , FMT_VS(checker->vs));
 
-			/* wait for a random timeout to begin checker thread.
-			   It helps avoiding multiple simultaneous checks to
-			   the same RS.
+			/* Wait for a timeout derived from a hash of the checker
+			   to begin the checker thread. It helps avoiding multiple
+			   simultaneous checks to the same RS. Subsequent runs are
+			   moved to the checker's phase slot in the delay_loop.
 			*/
-			warmup = checker->warmup;
-			if (warmup) {
-				/* coverity[dont_call] */
-				warmup = warmup * (unsigned)random() / RAND_MAX;
-			}
-			thread_add_timer(master, checker->launch, checker,
+			hash = checker_hash(checker);
+			warmup = checker->warmup ? hash % checker->warmup : 0;
+			if (checker->delay_loop)
+				checker->phase = hash % checker->delay_loop;
+			thread_add_timer(master, checker_launch_thread, checker,
 					 BOOTSTRAP_DELAY + warmup);
 		}
 	}
@@ -713,3 +823,11 @@ install_checkers_keyword(void)
 	install_bfd_check_keyword();
 #endif
 }
+
+#ifdef THREAD_DUMP
+void
+register_check_api_addresses(void)
+{
+	register_thread_address("checker_launch_thread", checker_launch_thread);
+}
+#endif
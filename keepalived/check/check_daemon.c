@@ -34,6 +34,7 @@
 #include "snmp.h"
 #endif
 #include "scheduler.h"
+#include "notify.h"
 #include "smtp.h"
 #include "check_dns.h"
 #include "check_http.h"
@@ -48,6 +49,7 @@
 #include "check_ssl.h"
 #include "check_api.h"
 #include "check_ping.h"
+#include "check_udp_pool.h"
 #include "check_file.h"
 #include "global_data.h"
 #include "pidfile.h"
@@ -61,6 +63,7 @@
 #include "keepalived_netlink.h"
 #include "check_print.h"
 #ifdef _WITH_SNMP_CHECKER_
+  #include "snmp.h"
   #include "check_snmp.h"
 #endif
 #include "utils.h"
@@ -68,6 +71,10 @@
 #include "bfd_daemon.h"
 #include "check_bfd.h"
 #endif
+#ifdef _WITH_JSON_
+#include "check_json.h"
+#include "json_socket.h"
+#endif
 #include "timer.h"
 #include "track_file.h"
 #ifdef _WITH_TRACK_PROCESS_
@@ -132,6 +139,8 @@ checker_dispatcher_release(void)
 #ifdef _WITH_BFD_
 	checker_bfd_dispatcher_release();
 #endif
+	checker_ping_dispatcher_release();
+	udp_pool_release();
 	cancel_signal_read_thread();
 	cancel_kernel_netlink_threads();
 }
@@ -154,6 +163,10 @@ checker_terminate_phase2(void)
 	/* Remove the notify fifo */
 	notify_fifo_close(&global_data->notify_fifo, &global_data->lvs_notify_fifo);
 
+#ifdef _WITH_JSON_
+	check_json_socket_close();
+#endif
+
 #ifdef _WITH_SNMP_CHECKER_
 	if (global_data && global_data->enable_snmp_checker)
 		check_snmp_agent_close();
@@ -391,6 +404,10 @@ start_check(list_head_t *old_checkers_queue, data_t *prev_global_data)
 	/* Create a notify FIFO if needed, and open it */
 	notify_fifo_open(&global_data->notify_fifo, &global_data->lvs_notify_fifo, lvs_notify_fifo_script_exit, "lvs_");
 
+#ifdef _WITH_JSON_
+	check_json_socket_open();
+#endif
+
 	/* Get current active addresses, and start update process */
 	if (using_ha_suspend || __test_bit(LOG_ADDRESS_CHANGES, &debug)) {
 		if (reload)
@@ -410,6 +427,9 @@ start_check(list_head_t *old_checkers_queue, data_t *prev_global_data)
 			snmp_epoll_info(master);
 		else
 			check_snmp_agent_init(global_data->snmp_socket);
+
+		/* The table indices refer to the previous configuration */
+		snmp_index_invalidate();
 	}
 #endif
 
@@ -495,6 +515,10 @@ reload_check_thread(__attribute__((unused)) thread_ref_t thread)
 	/* Remove the notify fifo - we don't know if it will be the same after a reload */
 	notify_fifo_close(&global_data->notify_fifo, &global_data->lvs_notify_fifo);
 
+#ifdef _WITH_JSON_
+	check_json_socket_close();
+#endif
+
 #if !defined _ONE_PROCESS_DEBUG_ && defined _WITH_SNMP_CHECKER_
 	if (prog_type == PROG_TYPE_CHECKER && global_data->enable_snmp_checker)
 		with_snmp = true;
@@ -627,6 +651,7 @@ register_check_thread_addresses(void)
 	register_snmp_addresses();
 #endif
 
+	register_check_api_addresses();
 	register_check_dns_addresses();
 	register_check_http_addresses();
 	register_check_misc_addresses();
@@ -635,10 +660,14 @@ register_check_thread_addresses(void)
 	register_check_tcp_addresses();
 	register_check_ping_addresses();
 	register_check_udp_addresses();
+	register_check_udp_pool_addresses();
 	register_check_file_addresses();
 #ifdef _WITH_BFD_
 	register_check_bfd_addresses();
 #endif
+#ifdef _WITH_JSON_
+	register_json_socket_addresses();
+#endif
 
 #ifndef _ONE_PROCESS_DEBUG_
 	register_thread_address("reload_check_thread", reload_check_thread);
@@ -708,12 +737,9 @@ start_check_child(void)
 #endif
 
 #ifdef _WITH_BFD_
-	/* Close the write end of the BFD checker event notification pipe and the track_process fd */
-	close(bfd_checker_event_pipe[1]);
-
 #ifdef _WITH_VRRP_
-	close(bfd_vrrp_event_pipe[0]);
-	close(bfd_vrrp_event_pipe[1]);
+	/* Close the BFD vrrp event ring */
+	bfd_event_chan_close(&bfd_vrrp_event_chan);
 #endif
 #endif
 #ifdef _WITH_TRACK_PROCESS_
@@ -763,6 +789,9 @@ start_check_child(void)
 	/* Create the new master thread */
 	thread_destroy_master(master);	/* This destroys any residual settings from the parent */
 	master = thread_make_master();
+
+	/* Start the helper that runs scripts before our memory usage grows */
+	script_helper_start();
 #endif
 
 	/* If last process died during a reload, we can get there and we
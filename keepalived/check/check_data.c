@@ -37,6 +37,7 @@
 #include "logger.h"
 #include "utils.h"
 #include "ipwrapper.h"
+#include "ipvswrapper.h"
 #include "parser.h"
 #include "libipvs.h"
 #include "keepalived_magic.h"
@@ -144,6 +145,7 @@ void
 free_vsg(virtual_server_group_t *vsg)
 {
 	list_del_init(&vsg->e_list);
+	name_hash_del(&vsg->e_name);
 	FREE_PTR(vsg->gname);
 	free_vsg_entry_list(&vsg->addr_range);
 	free_vsg_entry_list(&vsg->vfwmark);
@@ -896,6 +898,7 @@ void
 free_checker_bfd(checker_tracked_bfd_t *cbfd)
 {
 	list_del_init(&cbfd->e_list);
+	name_hash_del(&cbfd->e_name);
 	FREE(cbfd->bname);
 	free_bfds_rs_list(&cbfd->tracking_rs);
 	FREE(cbfd);
@@ -933,9 +936,11 @@ free_check_data(check_data_t *data)
 {
 	free_vs_list(&data->vs);
 	free_vsg_list(&data->vs_group);
+	name_hash_free(&data->vs_group_by_name);
 	free_track_file_list(&data->track_files);
 #ifdef _WITH_BFD_
 	free_checker_bfd_list(&data->track_bfds);
+	name_hash_free(&data->track_bfd_by_name);
 #endif
 	FREE(data);
 }
@@ -955,6 +960,7 @@ dump_check_data(FILE *fp, const check_data_t *data)
 		if (!list_empty(&data->vs_group))
 			dump_vsg_list(fp, &data->vs_group);
 		dump_vs_list(fp, &data->vs);
+		dump_ipvs_queue(fp);
 	}
 	dump_checkers_queue(fp);
 
@@ -41,6 +41,7 @@
 #include "layer4.h"
 #include "scheduler.h"
 #include "check_parser.h"
+#include "check_udp_pool.h"
 
 
 const dns_type_t DNS_TYPE[] = {
@@ -57,7 +58,6 @@ const dns_type_t DNS_TYPE[] = {
 };
 
 static void dns_connect_thread(thread_ref_t);
-static void dns_send_thread(thread_ref_t);
 
 
 static uint16_t __attribute__ ((pure))
@@ -87,13 +87,11 @@ dns_type_name(uint16_t type)
 }
 
 static void __attribute__ ((format (printf, 3, 4)))
-dns_log_message(thread_ref_t thread, int level, const char *fmt, ...)
+dns_log_message(checker_t *checker, int level, const char *fmt, ...)
 {
 	char buf[MAX_LOG_MSG];
 	va_list args;
 
-	checker_t *checker = THREAD_ARG(thread);
-
 	va_start(args, fmt);
 	vsnprintf(buf, sizeof (buf), fmt, args);
 	va_end(args);
@@ -102,7 +100,7 @@ dns_log_message(thread_ref_t thread, int level, const char *fmt, ...)
 }
 
 static int __attribute__ ((format (printf, 3, 4)))
-dns_final(thread_ref_t thread, bool error, const char *fmt, ...)
+dns_final(checker_t *checker, bool error, const char *fmt, ...)
 {
 	char buf[MAX_LOG_MSG];
 	va_list args;
@@ -110,17 +108,12 @@ dns_final(thread_ref_t thread, bool error, const char *fmt, ...)
 	bool checker_was_up;
 	bool rs_was_alive;
 
-	checker_t *checker = THREAD_ARG(thread);
-
 #ifdef _CHECKER_DEBUG_
 	if (do_checker_debug)
-		dns_log_message(thread, LOG_DEBUG, "final error=%d attempts=%u retry=%u", error,
+		dns_log_message(checker, LOG_DEBUG, "final error=%d attempts=%u retry=%u", error,
 				checker->retry_it, checker->retry);
 #endif
 
-	if (thread->type != THREAD_READY_TIMER)
-		thread_close_fd(thread);
-
 	if (error) {
 		if (checker->is_up || !checker->has_run) {
 			if (fmt &&
@@ -132,14 +125,12 @@ dns_final(thread_ref_t thread, bool error, const char *fmt, ...)
 				va_end(args);
 				if (checker->has_run && checker->retry_it >= checker->retry )
 					snprintf(buf + len, sizeof(buf) - len, " after %u retries", checker->retry);
-				dns_log_message(thread, LOG_INFO, "%s", buf);
+				dns_log_message(checker, LOG_INFO, "%s", buf);
 			}
 			if (checker->retry_it < checker->retry) {
 				checker->retry_it++;
 				checker->has_run = true;
-				thread_add_timer(thread->master,
-						 dns_connect_thread, checker,
-						 checker->delay_before_retry);
+				checker_add_timer(checker, checker->delay_before_retry);
 				return 0;
 			}
 			checker_was_up = checker->is_up;
@@ -163,85 +154,57 @@ dns_final(thread_ref_t thread, bool error, const char *fmt, ...)
 	}
 
 	checker->retry_it = 0;
-	thread_add_timer(thread->master, dns_connect_thread, checker,
-			 checker->delay_loop);
+	checker_add_timer(checker, checker->delay_loop);
 
 	return 0;
 }
 
-static void
-dns_recv_thread(thread_ref_t thread)
+/* Called by the UDP socket pool with the reply to our query */
+static bool
+dns_reply(udp_pool_req_t *req, enum connect_result status, const uint8_t *buf, size_t len)
 {
-	unsigned long timeout;
-	ssize_t ret;
-	char rbuf[DNS_BUFFER_SIZE] __attribute__((aligned(__alignof__(dns_header_t))));
-	dns_header_t *s_header, *r_header;
+	checker_t *checker = req->checker;
+	const dns_header_t *r_header;
 	int flags, rcode;
 
-	checker_t *checker = THREAD_ARG(thread);
-	dns_check_t *dns_check = CHECKER_ARG(checker);
-
-	if (thread->type == THREAD_READ_TIMEOUT) {
-		dns_final(thread, true, "read timeout from socket");
-		return;
+	if (status == connect_timeout) {
+		dns_final(checker, true, "read timeout from socket");
+		return true;
 	}
 
-	timeout = timer_long(thread->sands) - timer_long(time_now);
-
-	ret = recv(thread->u.f.fd, rbuf, sizeof (rbuf), 0);
-	if (ret == -1) {
-		if (check_EAGAIN(errno) || check_EINTR(errno)) {
-			thread_add_read(thread->master, dns_recv_thread,
-					checker, thread->u.f.fd, timeout, THREAD_DESTROY_CLOSE_FD);
-			return;
-		}
-		dns_final(thread, true, "failed to read socket; errno %d (%s)", errno, strerror(errno));
-		return;
-	}
-
-	if (ret < (ssize_t) sizeof (r_header)) {
-#ifdef _CHECKER_DEBUG_
-		if (do_checker_debug)
-			dns_log_message(thread, LOG_DEBUG, "too small message. (%zd bytes)", ret);
-#endif
-		thread_add_read(thread->master, dns_recv_thread, checker,
-				thread->u.f.fd, timeout, THREAD_DESTROY_CLOSE_FD);
-		return;
+	if (status != connect_success) {
+		dns_final(checker, true, "destination unreachable");
+		return true;
 	}
 
-	s_header = PTR_CAST(dns_header_t , dns_check->sbuf);
-	r_header = PTR_CAST(dns_header_t , rbuf);
-
-	if (s_header->id != r_header->id) {
+	if (len < sizeof (*r_header)) {
 #ifdef _CHECKER_DEBUG_
 		if (do_checker_debug)
-			dns_log_message(thread, LOG_DEBUG, "ID does not match. (%04x != %04x)",
-					ntohs(s_header->id), ntohs(r_header->id));
+			dns_log_message(checker, LOG_DEBUG, "too small message. (%zu bytes)", len);
 #endif
-		thread_add_read(thread->master, dns_recv_thread, checker,
-				thread->u.f.fd, timeout, THREAD_DESTROY_CLOSE_FD);
-		return;
+		return false;
 	}
 
+	r_header = PTR_CAST_CONST(dns_header_t, buf);
 	flags = ntohs(r_header->flags);
 
 	if (!DNS_QR(flags)) {
 #ifdef _CHECKER_DEBUG_
 		if (do_checker_debug)
-			dns_log_message(thread, LOG_DEBUG, "receive query message?");
+			dns_log_message(checker, LOG_DEBUG, "receive query message?");
 #endif
-		thread_add_read(thread->master, dns_recv_thread, checker,
-				thread->u.f.fd, timeout, THREAD_DESTROY_CLOSE_FD);
-		return;
+		return false;
 	}
 
 	if ((rcode = DNS_RC(flags)) != 0) {
-		dns_final(thread, true, "read error occurred. (rcode = %d)", rcode);
-		return;
+		dns_final(checker, true, "read error occurred. (rcode = %d)", rcode);
+		return true;
 	}
 
 	/* success */
-	dns_final(thread, false, NULL);
+	dns_final(checker, false, NULL);
+
+	return true;
 }
 
 #define APPEND16(x, y) do { \
@@ -250,13 +213,12 @@ dns_recv_thread(thread_ref_t thread)
 	} while(0)
 
 static void
-dns_make_query(thread_ref_t thread)
+dns_make_query(checker_t *checker)
 {
 	uint16_t flags = 0;
 	uint8_t *p;
 	const char *s, *e;
 	size_t n;
-	checker_t *checker = THREAD_ARG(thread);
 	dns_check_t *dns_check = CHECKER_ARG(checker);
 	dns_header_t *header = PTR_CAST(dns_header_t, dns_check->sbuf);
 
@@ -270,6 +232,9 @@ dns_make_query(thread_ref_t thread)
 	header->nscount = htons(0);
 	header->arcount = htons(0);
 
+	/* The reply is matched on the transaction ID */
+	dns_check->req.id = header->id;
+
 	p = PTR_CAST(uint8_t, header + 1);
 
 	/* QNAME */
@@ -292,139 +257,27 @@ dns_make_query(thread_ref_t thread)
 	dns_check->slen = (size_t)(p - PTR_CAST(uint8_t, header));
 }
 
-static void
-dns_send(thread_ref_t thread)
-{
-	checker_t *checker = THREAD_ARG(thread);
-	dns_check_t *dns_check = CHECKER_ARG(checker);
-	unsigned long timeout;
-	ssize_t ret;
-
-	timeout = timer_long(thread->sands) - timer_long(time_now);
-
-	/* Handle time_now > thread->sands (check for underflow) */
-	if (timeout > checker->co->connection_to)
-		timeout = 0;
-
-	ret = send(thread->u.f.fd, dns_check->sbuf, dns_check->slen, 0);
-	if (ret == -1) {
-		if (check_EAGAIN(errno) || check_EINTR(errno)) {
-			thread_add_write(thread->master, dns_send_thread,
-					 checker, thread->u.f.fd, timeout, THREAD_DESTROY_CLOSE_FD);
-			return;
-		}
-		dns_final(thread, true, "failed to write socket.");
-		return;
-	}
-
-	if (ret != (ssize_t) dns_check->slen) {
-		dns_final(thread, true, "failed to write all of the datagram.");
-		return;
-	}
-
-	thread_add_read(thread->master, dns_recv_thread, checker, thread->u.f.fd, timeout, THREAD_DESTROY_CLOSE_FD);
-
-	return;
-}
-
-static void
-dns_send_thread(thread_ref_t thread)
-{
-	if (thread->type == THREAD_WRITE_TIMEOUT) {
-		dns_final(thread, true, "write timeout to socket.");
-		return;
-	}
-
-	dns_send(thread);
-}
-
-static void
-dns_check_thread(thread_ref_t thread)
-{
-	int status;
-
-	if (thread->type == THREAD_WRITE_TIMEOUT) {
-		dns_final(thread, true, "write timeout to socket.");
-		return;
-	}
-
-	status = socket_state(thread, dns_check_thread, 0);
-
-	/* If status = connect_in_progress, next thread is already registered.
-	 * If it is connect_success, the fd is still open.
-	 * Otherwise we have a real connection error or connection timeout.
-	 */
-	switch (status) {
-	case connect_error:
-		dns_final(thread, true, "connection error.");
-		break;
-	case connect_timeout:
-		dns_final(thread, true, "connection timeout.");
-		break;
-	case connect_fail:
-		dns_final(thread, true, "connection failure.");
-		break;
-	case connect_success:
-		dns_make_query(thread);
-		dns_send(thread);
-
-		/* Cancel the write after the read is added to avoid the
-		 * file descriptor being removed */
-		thread_del_write(thread);
-		break;
-	}
-}
-
 static void
 dns_connect_thread(thread_ref_t thread)
 {
-	int fd, status;
-	thread_t thread_fd;
-
 	checker_t *checker = THREAD_ARG(thread);
+	dns_check_t *dns_check = CHECKER_ARG(checker);
 	conn_opts_t *co = checker->co;
+	enum connect_result status;
 
 	if (!checker->enabled) {
-		thread_add_timer(thread->master, dns_connect_thread, checker,
-				 checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
-	if ((fd = socket(co->dst.ss_family, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, IPPROTO_UDP)) == -1) {
-		dns_log_message(thread, LOG_INFO,
-				"failed to create socket. Rescheduling.");
-		thread_add_timer(thread->master, dns_connect_thread, checker,
-				 checker->delay_loop);
-		return;
-	}
+	dns_make_query(checker);
 
-	status = socket_bind_connect(fd, co);
+	status = udp_pool_send(&dns_check->req, dns_check->sbuf, dns_check->slen);
 
-	if (status == connect_success) {
-		thread_fd = *thread;
-		thread_fd.u.f.fd = fd;
-		thread_fd.sands = timer_add_long(time_now, co->connection_to);
-		dns_make_query(&thread_fd);
-		dns_send(&thread_fd);
-
-		return;
-	}
-
-	if (status == connect_fail) {
-		close(fd);
-		dns_final(thread, true, "network unreachable for %s", inet_sockaddrtopair(&co->dst));
-
-		return;
-	}
-
-	/* handle connection status & register check worker thread */
-	if (socket_connection_state(fd, status, thread, dns_check_thread, co->connection_to, 0)) {
-		close(fd);
-		dns_log_message(thread, LOG_INFO,
-				"UDP socket bind failed. Rescheduling.");
-		thread_add_timer(thread->master, dns_connect_thread, checker,
-				 checker->delay_loop);
-	}
+	if (status == connect_fail)
+		dns_final(checker, true, "network unreachable for %s", inet_sockaddrtopair(&co->dst));
+	else if (status != connect_success)
+		dns_final(checker, true, "failed to send the query.");
 }
 
 static void
@@ -432,6 +285,7 @@ free_dns_check(checker_t *checker)
 {
 	dns_check_t *dns_check = checker->data;
 
+	udp_pool_cancel(&dns_check->req);
 	FREE_CONST(dns_check->name);
 	FREE(checker->co);
 	FREE(checker->data);
@@ -475,6 +329,9 @@ dns_check_handler(__attribute__((unused)) const vector_t *strvec)
 	dns_check->type = DNS_DEFAULT_TYPE;
 	queue_checker(&dns_checker_funcs, dns_connect_thread,
 				dns_check, CHECKER_NEW_CO(), true);
+	dns_check->req.checker = current_checker;
+	dns_check->req.func = dns_reply;
+	dns_check->req.match_id = true;
 
 	/* Set the non-standard retry time */
 	current_checker->default_retry = DNS_DEFAULT_RETRY;
@@ -564,9 +421,6 @@ install_dns_check_keyword(void)
 void
 register_check_dns_addresses(void)
 {
-	register_thread_address("dns_check_thread", dns_check_thread);
 	register_thread_address("dns_connect_thread", dns_connect_thread);
-	register_thread_address("dns_recv_thread", dns_recv_thread);
-	register_thread_address("dns_send_thread", dns_send_thread);
 }
 #endif
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <ctype.h>
 
 #ifdef _WITH_REGEX_CHECK_
 #define PCRE2_CODE_UNIT_WIDTH 8
@@ -59,6 +60,16 @@ typedef enum {
 	REGISTER_CHECKER_FAILED
 } register_checker_t;
 
+/* Chunked transfer encoding parser states */
+enum {
+	CHUNK_SIZE,
+	CHUNK_EXT,
+	CHUNK_DATA,
+	CHUNK_DATA_END,
+	CHUNK_TRAILER_START,
+	CHUNK_TRAILER,
+};
+
 
 #ifdef _WITH_REGEX_CHECK_
 typedef struct {
@@ -125,13 +136,13 @@ static url_t *current_url;
 
 /* GET processing command */
 static const char *request_template =
-			"GET %s HTTP/1.%d\r\n"
+			"%s %s HTTP/1.%d\r\n"
 			"User-Agent: KeepAliveClient\r\n"
 			"%s"
 			"Host: %s%s\r\n\r\n";
 
 static const char *request_template_ipv6 =
-			"GET %s HTTP/1.%d\r\n"
+			"%s %s HTTP/1.%d\r\n"
 			"User-Agent: KeepAliveClient\r\n"
 			"%s"
 			"Host: [%s]%s\r\n\r\n";
@@ -306,6 +317,8 @@ free_http_request(request_t *req)
 {
 	if(!req)
 		return;
+	if (req->idle)
+		close(req->fd);
 	if (req->ssl)
 		SSL_free(req->ssl);
 	FREE_PTR(req->buffer);
@@ -319,6 +332,7 @@ free_http_check(checker_t *checker)
 
 	free_url_list(&http_get_chk->url);
 	free_http_request(http_get_chk->req);
+	ssl_free_session(http_get_chk);
 	FREE_CONST_PTR(http_get_chk->virtualhost);
 	FREE_PTR(http_get_chk);
 	FREE(checker->co);
@@ -340,6 +354,10 @@ dump_http_check(FILE *fp, const checker_t *checker)
 	conf_write(fp, "   Enable SNI %sset", http_get_chk->enable_sni ? "" : "un");
 #endif
 	conf_write(fp, "   Fast recovery %sset", http_get_chk->fast_recovery ? "" : "un");
+	conf_write(fp, "   Persistent connection %sset", http_get_chk->persistent ? "" : "un");
+	conf_write(fp, "   HEAD request %sset", http_get_chk->head_request ? "" : "un");
+	if (http_get_chk->proto == PROTO_SSL)
+		conf_write(fp, "   SSL sessions resumed %u, full handshakes %u", http_get_chk->ssl_resumed, http_get_chk->ssl_full_handshakes);
 	dump_url_list(fp, &http_get_chk->url);
 	if (http_get_chk->failed_url)
 		conf_write(fp, "   Failed URL = %s", http_get_chk->failed_url->path);
@@ -824,6 +842,38 @@ fast_recovery_handler(const vector_t *strvec)
 	http_get_chk->fast_recovery = res;
 }
 
+static void
+persistent_connection_handler(const vector_t *strvec)
+{
+	http_checker_t *http_get_chk = current_checker->data;
+	int res = true;
+
+	if (vector_size(strvec) >= 2) {
+		res = check_true_false(strvec_slot(strvec, 1));
+		if (res == -1) {
+			report_config_error(CONFIG_GENERAL_ERROR, "Invalid persistent_connection parameter %s", strvec_slot(strvec, 1));
+			return;
+		}
+	}
+	http_get_chk->persistent = res;
+}
+
+static void
+head_request_handler(const vector_t *strvec)
+{
+	http_checker_t *http_get_chk = current_checker->data;
+	int res = true;
+
+	if (vector_size(strvec) >= 2) {
+		res = check_true_false(strvec_slot(strvec, 1));
+		if (res == -1) {
+			report_config_error(CONFIG_GENERAL_ERROR, "Invalid head_request parameter %s", strvec_slot(strvec, 1));
+			return;
+		}
+	}
+	http_get_chk->head_request = res;
+}
+
 static void
 url_check(void)
 {
@@ -895,6 +945,8 @@ install_http_ssl_check_keyword(const char *keyword)
 	install_keyword("enable_sni", &enable_sni_handler);
 #endif
 	install_keyword("fast_recovery", &fast_recovery_handler);
+	install_keyword("persistent_connection", &persistent_connection_handler);
+	install_keyword("head_request", &head_request_handler);
 	install_keyword("url", &url_handler);
 	check_ptr1 = install_sublevel(VPP &current_url);
 	install_keyword("path", &path_handler);
@@ -1053,7 +1105,15 @@ epilog(thread_ref_t thread, register_checker_t method)
 		delay = checker->delay_before_retry;
 
 	/* If req == NULL, fd is not created */
-	if (req) {
+	if (req && method == REGISTER_CHECKER_NEW && req->keep_conn && req->complete) {
+		/* Keep the connection open for the next request */
+		thread_del_read(thread);
+		req->fd = thread->u.f.fd;
+		req->idle = true;
+		req->extracted = NULL;
+		req->len = 0;
+		FREE_PTR(req->buffer);
+	} else if (req) {
 		free_http_request(req);
 		http_get_check->req = NULL;
 		thread_close_fd(thread);
@@ -1065,9 +1125,9 @@ epilog(thread_ref_t thread, register_checker_t method)
 	if (http_get_check->fast_recovery &&
 	    (!checker->has_run ||
 	     (!checker->is_up && !http_get_check->failed_url)))
-		thread_add_event(thread->master, http_connect_thread, checker, 0);
-	else
-		thread_add_timer(thread->master, http_connect_thread, checker, delay);
+		delay = 0;
+
+	checker_add_timer(checker, delay);
 
 	return;
 }
@@ -1319,8 +1379,11 @@ http_handle_response(thread_ref_t thread, unsigned char digest[MD5_DIGEST_LENGTH
 		return;
 	}
 
-	/* Report a length mismatch the first time we get the specific difference */
-	if (req->content_len != SIZE_MAX && req->content_len != req->rx_bytes) {
+	/* Report a length mismatch the first time we get the specific difference.
+	 * If only the status code is checked, the body may not have been read. */
+	if (req->headers_only)
+		url->len_mismatch = 0;
+	else if (req->content_len != SIZE_MAX && req->content_len != req->rx_bytes) {
 		if (url->len_mismatch != (ssize_t)req->content_len - (ssize_t)req->rx_bytes) {
 			log_message(LOG_INFO, "http_check for RS %s VS %s url %s%s:"
 					      " content_length (%zu) does not match received bytes (%zu)"
@@ -1398,6 +1461,112 @@ dump_digest(unsigned char *digest, unsigned len)
 	printf(HTML_HASH_FINAL);
 }
 
+/* Parse chunked transfer encoding. Returns the number of bytes used
+ * once the last chunk and the trailer have been received, otherwise SIZE_MAX */
+static size_t
+http_parse_chunks(request_t *req, const char *data, size_t len)
+{
+	size_t i;
+	size_t n;
+
+	for (i = 0; i < len; i++) {
+		switch (req->chunk_state) {
+		case CHUNK_SIZE:
+			if (isxdigit((unsigned char)data[i])) {
+				if (req->chunk_len > SIZE_MAX / 16) {
+					req->keep_conn = false;
+					return SIZE_MAX;
+				}
+				req->chunk_len = req->chunk_len * 16 +
+					(size_t)(isdigit((unsigned char)data[i]) ? data[i] - '0' : (tolower((unsigned char)data[i]) - 'a' + 10));
+			} else if (data[i] == '\n')
+				req->chunk_state = req->chunk_len ? CHUNK_DATA : CHUNK_TRAILER_START;
+			else
+				req->chunk_state = CHUNK_EXT;
+			break;
+		case CHUNK_EXT:
+			if (data[i] == '\n')
+				req->chunk_state = req->chunk_len ? CHUNK_DATA : CHUNK_TRAILER_START;
+			break;
+		case CHUNK_DATA:
+			n = len - i < req->chunk_len ? len - i : req->chunk_len;
+			req->chunk_len -= n;
+			i += n - 1;
+			if (!req->chunk_len)
+				req->chunk_state = CHUNK_DATA_END;
+			break;
+		case CHUNK_DATA_END:
+			if (data[i] == '\n')
+				req->chunk_state = CHUNK_SIZE;
+			break;
+		case CHUNK_TRAILER_START:
+			if (data[i] == '\n')
+				return i + 1;
+			if (data[i] != '\r')
+				req->chunk_state = CHUNK_TRAILER;
+			break;
+		case CHUNK_TRAILER:
+			if (data[i] == '\n')
+				req->chunk_state = CHUNK_TRAILER_START;
+			break;
+		}
+	}
+
+	return SIZE_MAX;
+}
+
+/* Work out how the end of the response body will be identified */
+static void
+http_frame_header(request_t *req, size_t header_len)
+{
+	if (req->status_code < 200 ||
+	    extract_header_token(req->buffer, header_len, "Connection", "close"))
+		req->keep_conn = false;
+	else if (req->head || req->status_code == 204 || req->status_code == 304)
+		req->body_len = 0;
+	else if (extract_header_token(req->buffer, header_len, "Transfer-Encoding", "chunked"))
+		req->body_len = SIZE_MAX;
+	else if (req->content_len != SIZE_MAX)
+		req->body_len = req->content_len;
+	else {
+		/* The body is terminated by the server closing the connection */
+		req->keep_conn = false;
+	}
+}
+
+/* Track received body data to see if the response is complete */
+static void
+http_frame_body(request_t *req, const char *data, size_t len)
+{
+	size_t used;
+
+	if (!req->keep_conn)
+		return;
+
+	if (req->complete) {
+		/* Data after the end of the response */
+		if (len)
+			req->keep_conn = false;
+		return;
+	}
+
+	if (req->body_len == SIZE_MAX) {
+		if ((used = http_parse_chunks(req, data, len)) == SIZE_MAX)
+			return;
+	} else {
+		used = req->body_len - req->body_rx;
+		if (len < used) {
+			req->body_rx += len;
+			return;
+		}
+		req->body_rx = req->body_len;
+	}
+
+	req->complete = true;
+	if (used != len)
+		req->keep_conn = false;
+}
+
 /* Handle response stream performing MD5 updates */
 void
 http_process_response(thread_ref_t thread, request_t *req, size_t r, url_t *url)
@@ -1420,6 +1589,11 @@ http_process_response(thread_ref_t thread, request_t *req, size_t r, url_t *url)
                                 http_dump_header(req->buffer, req->extracted - req->buffer);
 
 			r = req->len - (size_t)(req->extracted - req->buffer);
+
+			if (req->keep_conn) {
+				http_frame_header(req, (size_t)(req->extracted - req->buffer));
+				http_frame_body(req, req->extracted, r);
+			}
 			if (r && url->digest) {
 				if (req->content_len == SIZE_MAX || req->content_len > req->rx_bytes) {
 					EVP_DigestUpdate(req->context, req->extracted,
@@ -1438,6 +1612,8 @@ http_process_response(thread_ref_t thread, request_t *req, size_t r, url_t *url)
 				req->len = 0;
 		}
 	} else if (req->len) {
+		http_frame_body(req, req->buffer + old_req_len, r);
+
 		if (url->digest &&
 		    (req->content_len == SIZE_MAX || req->content_len > req->rx_bytes)) {
 			EVP_DigestUpdate(req->context, req->buffer + old_req_len,
@@ -1446,7 +1622,7 @@ http_process_response(thread_ref_t thread, request_t *req, size_t r, url_t *url)
 				dump_buffer(req->buffer + old_req_len, req->content_len == SIZE_MAX || req->content_len >= req->rx_bytes + r ? r : req->content_len - req->rx_bytes, stdout, 0);
 		}
 
-		req->rx_bytes += req->len;
+		req->rx_bytes += r;
 #ifdef _WITH_REGEX_CHECK_
 		if (!url->regex || !check_regex(url, req))
 #endif
@@ -1454,6 +1630,63 @@ http_process_response(thread_ref_t thread, request_t *req, size_t r, url_t *url)
 	}
 }
 
+/* Returns true once the rest of the response isn't needed. If the connection
+ * isn't being kept, there is no need to wait for the server to close it if
+ * only the status code is checked, or once Content-Length bytes are received. */
+bool
+http_response_done(const request_t *req)
+{
+	if (req->complete)
+		return true;
+
+	if (!req->extracted || req->keep_conn)
+		return false;
+
+	return req->headers_only || req->head ||
+	       (req->content_len != SIZE_MAX && req->rx_bytes >= req->content_len);
+}
+
+/* The complete response has been received */
+void
+http_handle_complete_response(thread_ref_t thread, request_t *req, url_t *url)
+{
+	unsigned char digest[MD5_DIGEST_LENGTH];
+
+	if (url->digest) {
+		EVP_DigestFinal_ex(req->context, digest, NULL);
+		EVP_MD_CTX_free(req->context);
+		req->context = NULL;
+	} else
+		digest[0] = 0;
+
+	http_handle_response(thread, digest, false);
+}
+
+/* If the server closed a reused connection before responding, open
+ * a new connection and resend the request. Returns true if reconnecting. */
+bool
+http_reconnect_reused(thread_ref_t thread)
+{
+	checker_t *checker = THREAD_ARG(thread);
+	http_checker_t *http_get_check = CHECKER_ARG(checker);
+	request_t *req = http_get_check->req;
+
+	if (!req->reused || req->extracted || req->len)
+		return false;
+
+	if (req->context) {
+		EVP_MD_CTX_free(req->context);
+		req->context = NULL;
+	}
+	free_http_request(req);
+	http_get_check->req = NULL;
+	thread_close_fd(thread);
+
+	thread_add_event(thread->master, http_connect_thread, checker, 0);
+
+	return true;
+}
+
 /* Asynchronous HTTP stream reader */
 static void
 http_read_thread(thread_ref_t thread)
@@ -1487,6 +1720,9 @@ http_read_thread(thread_ref_t thread)
 	}
 
 	if (r <= 0) {	/* -1:error , 0:EOF */
+		if (http_reconnect_reused(thread))
+			return;
+
 		/* All the HTTP stream has been parsed */
 		if (url->digest) {
 			EVP_DigestFinal_ex(req->context, digest, NULL);
@@ -1511,6 +1747,11 @@ http_read_thread(thread_ref_t thread)
 	/* Handle response stream */
 	http_process_response(thread, req, (size_t)r, url);
 
+	if (http_response_done(req)) {
+		http_handle_complete_response(thread, req, url);
+		return;
+	}
+
 	/*
 	 * Register next http stream reader.
 	 * Register itself to not perturbe global I/O multiplexer.
@@ -1543,8 +1784,14 @@ http_response_thread(thread_ref_t thread)
 	req->extracted = NULL;
 	req->len = 0;
 	req->error = 0;
+	req->rx_bytes = 0;
+	req->complete = false;
+	req->body_rx = 0;
+	req->chunk_state = CHUNK_SIZE;
+	req->chunk_len = 0;
 #ifdef _WITH_REGEX_CHECK_
 	req->regex_matched = false;
+	req->start_offset = 0;
 	req->regex_subject_offset = 0;
 #ifdef _WITH_REGEX_TIMERS_
 	req->num_match_calls = 0;
@@ -1613,10 +1860,22 @@ http_request_thread(thread_ref_t thread)
 			 ntohs(inet_sockaddrport(addr)));
 	}
 
+	/* If neither a digest nor a regex is specified, the body isn't needed */
+	req->headers_only = !fetched_url->digest && !http_get_check->genhash_flags;
+#ifdef _WITH_REGEX_CHECK_
+	if (fetched_url->regex)
+		req->headers_only = false;
+#endif
+	req->head = req->headers_only && http_get_check->head_request;
+
 		/* if literal ipv6 address, use ipv6 template, see RFC 2732 */
+	/* A persistent connection uses HTTP/1.1 without "Connection: close" */
+	req->keep_conn = http_get_check->persistent;
 	snprintf(str_request, GET_BUFFER_LENGTH, (addr->ss_family == AF_INET6 && !vhost) ? request_template_ipv6 : request_template,
+			req->head ? "HEAD" : "GET",
 			fetched_url->path,
-			http_get_check->http_protocol == HTTP_PROTOCOL_1_1 ? 1 : 0,
+			http_get_check->http_protocol == HTTP_PROTOCOL_1_1 || req->keep_conn ? 1 : 0,
+			req->keep_conn ? "" :
 			http_get_check->http_protocol == HTTP_PROTOCOL_1_0C || http_get_check->http_protocol == HTTP_PROTOCOL_1_1 ? "Connection: close\r\n" : "",
 			request_host, request_host_port);
 
@@ -1634,6 +1893,8 @@ http_request_thread(thread_ref_t thread)
 	FREE(str_request);
 
 	if (!ret) {
+		if (http_reconnect_reused(thread))
+			return;
 		timeout_epilog(thread, "Cannot send get request to");
 		return;
 	}
@@ -1739,6 +2000,9 @@ http_check_thread(thread_ref_t thread)
 			if (http_get_check->proto == PROTO_SSL)
 				ssl_printerr(SSL_get_error (http_get_check->req->ssl, ret));
 #endif
+			/* Don't try resuming a session that may have caused the failure */
+			if (http_get_check->proto == PROTO_SSL)
+				ssl_free_session(http_get_check);
 			timeout_epilog(thread, "SSL handshake/communication error"
 						 " connecting to");
 			return;
@@ -1747,6 +2011,15 @@ http_check_thread(thread_ref_t thread)
 	}
 }
 
+/* The server must not have sent anything on an idle connection */
+static bool
+http_connection_idle(int fd)
+{
+	char c;
+
+	return recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == -1 && check_EAGAIN(errno);
+}
+
 void
 http_connect_thread(thread_ref_t thread)
 {
@@ -1755,6 +2028,7 @@ http_connect_thread(thread_ref_t thread)
 	conn_opts_t *co = checker->co;
 	url_t *fetched_url;
 	enum connect_result status;
+	request_t *req;
 	int fd;
 
 	/*
@@ -1762,8 +2036,7 @@ http_connect_thread(thread_ref_t thread)
 	 * if checker is disabled
 	 */
 	if (!checker->enabled) {
-		thread_add_timer(thread->master, http_connect_thread, checker,
-				 checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
@@ -1774,11 +2047,24 @@ http_connect_thread(thread_ref_t thread)
 		return;
 	}
 
+	/* Reuse a persistent connection if the server hasn't closed it */
+	if ((req = http_get_check->req)) {
+		if (http_connection_idle(req->fd)) {
+			req->idle = false;
+			req->reused = true;
+			thread_add_write(thread->master, http_request_thread, checker,
+					 req->fd, co->connection_to, THREAD_DESTROY_CLOSE_FD);
+			return;
+		}
+
+		free_http_request(req);
+		http_get_check->req = NULL;
+	}
+
 	/* Create the socket */
 	if ((fd = socket(co->dst.ss_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, IPPROTO_TCP)) == -1) {
 		log_message(LOG_INFO, "WEB connection fail to create socket. Rescheduling.");
-		thread_add_timer(thread->master, http_connect_thread, checker,
-				checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 
 		return;
 	}
@@ -1792,8 +2078,7 @@ http_connect_thread(thread_ref_t thread)
 			timeout_epilog(thread, "HTTP_CHECK - network unreachable");
 		} else {
 			log_message(LOG_INFO, "WEB socket bind failed. Rescheduling");
-			thread_add_timer(thread->master, http_connect_thread, checker,
-					 checker->delay_loop);
+			checker_add_timer(checker, checker->delay_loop);
 		}
 	}
 }
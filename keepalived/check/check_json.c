@@ -0,0 +1,188 @@
+/*
+ * Soft:        Keepalived is a failover program for the LVS project
+ *              <www.linuxvirtualserver.org>. It monitor & manipulate
+ *              a loadbalanced server pool using multi-layer checks.
+ *
+ * Part:        Output running virtual server state in JSON format
+ *              on the checker JSON socket.
+ *
+ * Author:      Alexandre Cassen, <acassen@linux-vs.org>
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *              See the GNU General Public License for more details.
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              as published by the Free Software Foundation; either version
+ *              2 of the License, or (at your option) any later version.
+ *
+ * Copyright (C) 2001-2024 Alexandre Cassen, <acassen@gmail.com>
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "check_json.h"
+#include "check_data.h"
+#include "global_data.h"
+#include "json_writer.h"
+#include "json_socket.h"
+#include "timer.h"
+
+static json_socket_t *json_ctl;
+
+/* FMT_VS() of a fwmark virtual server contains a space, so it could
+ * not be given in a list of names */
+static const char *
+check_json_vs_name(const virtual_server_t *vs)
+{
+	static char buf[4 + 10 + 1];	/* FWM:nnnnnnnnnn */
+
+	if (vs->vsgname || !vs->vfwmark)
+		return FMT_VS(vs);
+
+	snprintf(buf, sizeof(buf), "FWM:%u", vs->vfwmark);
+	return buf;
+}
+
+static void
+check_json_rs_dump(json_writer_t *wr, const real_server_t *rs, const virtual_server_t *vs)
+{
+	jsonw_start_object(wr);
+	jsonw_string_field(wr, "name", FMT_RS(rs, vs));
+	jsonw_int_field(wr, "weight", rs->iweight);
+	jsonw_int_field(wr, "effective_weight", rs->effective_weight);
+	jsonw_bool_field(wr, "inhibit", rs->inhibit);
+	jsonw_bool_field(wr, "alive", rs->alive);
+	jsonw_bool_field(wr, "set", rs->set);
+	jsonw_uint_field(wr, "failed_checkers", rs->num_failed_checkers);
+	jsonw_end_object(wr);
+}
+
+static void
+check_json_vs_dump(json_writer_t *wr, virtual_server_t *vs)
+{
+	real_server_t *rs;
+	unsigned alive = 0;
+
+	jsonw_start_object(wr);
+	jsonw_string_field(wr, "name", check_json_vs_name(vs));
+	if (vs->vsgname)
+		jsonw_string_field(wr, "group", vs->vsgname);
+	else if (vs->vfwmark)
+		jsonw_uint_field(wr, "fwmark", vs->vfwmark);
+	jsonw_string_field(wr, "lvs_sched", vs->sched);
+	jsonw_uint_field(wr, "persistence_timeout", vs->persistence_timeout);
+	jsonw_uint_field(wr, "quorum", vs->quorum);
+	jsonw_uint_field(wr, "hysteresis", vs->hysteresis);
+	jsonw_bool_field(wr, "quorum_up", vs->quorum_state_up);
+
+	jsonw_name(wr, "real_servers");
+	jsonw_start_array(wr);
+	list_for_each_entry(rs, &vs->rs, e_list) {
+		check_json_rs_dump(wr, rs, vs);
+		if (rs->alive)
+			alive++;
+	}
+	jsonw_end_array(wr);
+	jsonw_uint_field(wr, "rs_alive", alive);
+
+	if (vs->s_svr) {
+		jsonw_name(wr, "sorry_server");
+		check_json_rs_dump(wr, vs->s_svr, vs);
+	}
+	jsonw_end_object(wr);
+}
+
+/* Write the reply to a JSON socket request */
+static bool
+check_json_request(FILE *fp, const char *req, const char *names)
+{
+	virtual_server_t *vs;
+	json_writer_t *wr;
+
+	if (strcmp(req, "virtual_servers"))
+		return false;
+
+	wr = jsonw_new(fp);
+	jsonw_start_array(wr);
+
+	list_for_each_entry(vs, &check_data->vs, e_list) {
+		if (json_socket_name_selected(names, check_json_vs_name(vs)))
+			check_json_vs_dump(wr, vs);
+	}
+
+	jsonw_end_array(wr);
+	jsonw_destroy(&wr);
+
+	return true;
+}
+
+static void
+check_json_notify(const virtual_server_t *vs, const real_server_t *rs, bool up)
+{
+	const char *name;
+	char *buf = NULL;
+	size_t len = 0;
+	json_writer_t *wr;
+	FILE *fp;
+
+	if (!json_socket_streaming(json_ctl))
+		return;
+
+	if (!(fp = open_memstream(&buf, &len)))
+		return;
+
+	name = check_json_vs_name(vs);
+
+	wr = jsonw_new(fp);
+	jsonw_start_object(wr);
+	jsonw_string_field(wr, "type", rs ? "RS" : "VS");
+	jsonw_string_field(wr, "name", name);
+	if (rs) {
+		jsonw_string_field(wr, "rs", FMT_RS(rs, vs));
+		jsonw_int_field(wr, "weight", rs->effective_weight);
+	}
+	jsonw_string_field(wr, "state", up ? "UP" : "DOWN");
+	jsonw_float_field_fmt(wr, "time", "%f", time_now.tv_sec + time_now.tv_usec / TIMER_HZ_DOUBLE);
+	jsonw_end_object(wr);
+	jsonw_destroy(&wr);
+	fclose(fp);
+
+	json_socket_event(json_ctl, name, buf, len);
+
+	/* open_memstream() uses malloc, not MALLOC */
+	free(buf);
+}
+
+/* Send virtual server quorum and real server state changes to any streaming clients */
+void
+check_json_notify_vs(const virtual_server_t *vs)
+{
+	check_json_notify(vs, NULL, vs->quorum_state_up);
+}
+
+void
+check_json_notify_rs(const virtual_server_t *vs, const real_server_t *rs)
+{
+	check_json_notify(vs, rs, rs->alive);
+}
+
+void
+check_json_socket_open(void)
+{
+	if (global_data->lvs_json_socket && !json_ctl)
+		json_ctl = json_socket_open(global_data->lvs_json_socket, check_json_request);
+}
+
+void
+check_json_socket_close(void)
+{
+	json_socket_close(json_ctl);
+	json_ctl = NULL;
+}
@@ -274,8 +274,7 @@ misc_check_thread(thread_ref_t thread)
 	 */
 	if (!checker->enabled) {
 		/* Register next timer checker */
-		thread_add_timer(thread->master, misc_check_thread, checker,
-				 checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
@@ -485,14 +484,19 @@ misc_check_child_thread(thread_ref_t thread)
 		}
 	}
 
-	/* Register next timer checker */
-	next_time = timer_add_long(misck_checker->last_ran, checker->retry_it ? checker->delay_before_retry : checker->delay_loop);
-	next_time = timer_sub_now(next_time);
-	if (next_time.tv_sec < 0 ||
-	    (next_time.tv_sec == 0 && next_time.tv_usec == 0))
-		next_time.tv_sec = 0, next_time.tv_usec = 1;
-
-	thread_add_timer(thread->master, misc_check_thread, checker, timer_long(next_time));
+	/* Register next timer checker. The next run after delay_loop is
+	 * kept in the checker's phase slot. */
+	if (!checker->retry_it)
+		checker_add_timer(checker, checker->delay_loop);
+	else {
+		next_time = timer_add_long(misck_checker->last_ran, checker->delay_before_retry);
+		next_time = timer_sub_now(next_time);
+		if (next_time.tv_sec < 0 ||
+		    (next_time.tv_sec == 0 && next_time.tv_usec == 0))
+			next_time.tv_sec = 0, next_time.tv_usec = 1;
+
+		checker_add_timer(checker, timer_long(next_time));
+	}
 
 	misck_checker->state = SCRIPT_STATE_IDLE;
 
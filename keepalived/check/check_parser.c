@@ -151,6 +151,7 @@ vsg_handler(const vector_t *strvec)
 	}
 
 	list_add_tail(&current_vsg->e_list, &check_data->vs_group);
+	name_hash_add(&check_data->vs_group_by_name, &current_vsg->e_name, current_vsg->gname);
 	current_vsg = NULL;
 }
 
@@ -29,6 +29,8 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <linux/errqueue.h>
 
 #include "check_ping.h"
 #include "check_api.h"
@@ -42,6 +44,17 @@
 #define ICMP_BUFSIZE 128
 #define SOCK_RECV_BUFF 128*1024
 
+#define PING_HASH_BITS	10
+#define PING_HASH_SIZE	(1U << PING_HASH_BITS)
+#define PING_MAX_READ	64	/* Replies read before returning to the scheduler */
+
+/* All the PING_CHECKs use a single ICMP socket per address family,
+ * matching replies to checkers by the echo sequence number */
+typedef struct _ping_socket {
+	int			fd;
+	thread_ref_t		thread;
+} ping_socket_t;
+
 static const char * const ping_group_range = "/proc/sys/net/ipv4/ping_group_range";
 
 static gid_t save_gid_min;
@@ -49,7 +62,18 @@ static bool checked_ping_group_range;
 
 static uint16_t seq_no;
 
+static ping_socket_t ping_sock = { .fd = -1 };
+static ping_socket_t ping6_sock = { .fd = -1 };
+
+/* Outstanding echo requests, by sequence number and by timeout */
+static hlist_head_t ping_hash[PING_HASH_SIZE];
+static rb_root_cached_t ping_timeouts = RB_ROOT_CACHED;
+static thread_ref_t ping_timer;
+
+RB_TIMER_LESS(ping_check, n);
+
 static void icmp_connect_thread(thread_ref_t);
+static void ping_done(ping_check_t *);
 
 bool
 set_ping_group_range(bool set)
@@ -123,6 +147,7 @@ set_ping_group_range(bool set)
 static void
 free_ping_check(checker_t *checker)
 {
+	ping_done(checker->data);
 	FREE(checker->co);
 	FREE_PTR(checker->data);
 	FREE(checker);
@@ -145,10 +170,13 @@ static const checker_funcs_t ping_checker_funcs = { CHECKER_PING, free_ping_chec
 static void
 ping_check_handler(__attribute__((unused)) const vector_t *strvec)
 {
-	ping_check_t *ping_check = sizeof(ping_check_t) ? MALLOC(sizeof (ping_check_t)) : NULL;
+	ping_check_t *ping_check;
+
+	PMALLOC(ping_check);
 
 	/* queue new checker */
 	queue_checker(&ping_checker_funcs, icmp_connect_thread, ping_check, CHECKER_NEW_CO(), true);
+	ping_check->checker = current_checker;
 
 	if (!checked_ping_group_range)
 		set_ping_group_range(true);
@@ -179,115 +207,13 @@ install_ping_check_keyword(void)
 	install_sublevel_end(check_ptr);
 }
 
-static enum connect_result
-ping_it(int fd, conn_opts_t* co)
-{
-	struct icmphdr *icmp_hdr;
-	char send_buf[sizeof(*icmp_hdr) + ICMP_BUFSIZE] __attribute__((aligned(__alignof__(struct icmphdr))));
-
-	set_buf(send_buf + sizeof(*icmp_hdr), ICMP_BUFSIZE);
-
-	icmp_hdr = PTR_CAST(struct icmphdr, send_buf);
-
-	memset(icmp_hdr, 0, sizeof(*icmp_hdr));
-	icmp_hdr->type = ICMP_ECHO;
-	icmp_hdr->un.echo.sequence = seq_no++;
-
-	if (sendto(fd, send_buf, sizeof(send_buf), 0, PTR_CAST(struct sockaddr, &co->dst), sizeof(struct sockaddr)) < 0) {
-		log_message(LOG_INFO, "send ICMP packet fail");
-		return connect_error;
-	}
-	return connect_success;
-}
-
-static enum connect_result
-recv_it(int fd)
-{
-	ssize_t len;
-	const struct icmphdr *icmp_hdr;
-	char recv_buf[sizeof(*icmp_hdr) + ICMP_BUFSIZE] __attribute__((aligned(__alignof__(struct icmphdr))));
-
-	len = recv(fd, recv_buf, sizeof(recv_buf), 0);
-
-	if (len < 0) {
-		log_message(LOG_INFO, "recv ICMP packet error");
-		return connect_error;
-	}
-
-	if ((size_t)len < sizeof(*icmp_hdr)) {
-		log_message(LOG_INFO, "Error, got short ICMP packet, %zd bytes", len);
-		return connect_error;
-	}
-
-	icmp_hdr = PTR_CAST_CONST(struct icmphdr, recv_buf);
-	if (icmp_hdr->type != ICMP_ECHOREPLY) {
-		log_message(LOG_INFO, "Got ICMP packet with type 0x%x", icmp_hdr->type);
-		return connect_error;
-	}
-
-	return connect_success;
-}
-
-static enum connect_result
-ping6_it(int fd, conn_opts_t* co)
-{
-	struct icmp6_hdr* icmp6_hdr;
-	char send_buf[sizeof(*icmp6_hdr) + ICMP_BUFSIZE] __attribute__((aligned(__alignof__(struct icmp6_hdr))));
-
-	set_buf(send_buf + sizeof(*icmp6_hdr), ICMP_BUFSIZE);
-
-	icmp6_hdr = PTR_CAST(struct icmp6_hdr, &send_buf);
-
-	memset(icmp6_hdr, 0, sizeof(*icmp6_hdr));
-	icmp6_hdr->icmp6_type = ICMP6_ECHO_REQUEST;
-	icmp6_hdr->icmp6_seq = seq_no++;
-
-	if (sendto(fd, send_buf, sizeof(send_buf), 0, PTR_CAST(struct sockaddr, &co->dst), sizeof(struct sockaddr_in6)) < 0) {
-		log_message(LOG_INFO, "send ICMPv6 packet fail - errno %d", errno);
-		return connect_error;
-	}
-
-	return connect_success;
-}
-
-static enum connect_result
-recv6_it(int fd)
-{
-	ssize_t len;
-	const struct icmp6_hdr* icmp6_hdr;
-	char recv_buf[sizeof (*icmp6_hdr) + ICMP_BUFSIZE] __attribute__((aligned(__alignof__(struct icmp6_hdr))));
-
-	len = recv(fd, recv_buf, sizeof(recv_buf), 0);
-
-	if (len < 0) {
-		log_message(LOG_INFO, "recv ICMPv6 packet error");
-		return connect_error;
-	}
-
-	if ((size_t)len < sizeof(*icmp6_hdr)) {
-		log_message(LOG_INFO, "Error, got short ICMPv6 packet, %zd bytes", len);
-		return connect_error;
-	}
-
-	icmp6_hdr = PTR_CAST_CONST(struct icmp6_hdr, recv_buf);
-	if (icmp6_hdr->icmp6_type != ICMP6_ECHO_REPLY) {
-		log_message(LOG_INFO, "Got ICMPv6 packet with type 0x%x", icmp6_hdr->icmp6_type);
-		return connect_error;
-	}
-
-	return connect_success;
-}
-
 static void
-icmp_epilog(thread_ref_t thread, bool is_success)
+icmp_epilog(checker_t *checker, bool is_success)
 {
-	checker_t *checker;
 	unsigned long delay;
 	bool checker_was_up;
 	bool rs_was_alive;
 
-	checker = THREAD_ARG(thread);
-
 	delay = checker->delay_loop;
 	if (is_success || ((checker->is_up || !checker->has_run) && checker->retry_it >= checker->retry)) {
 		checker->retry_it = 0;
@@ -328,43 +254,316 @@ icmp_epilog(thread_ref_t thread, bool is_success)
 
 	checker->has_run = true;
 
-	thread_add_timer(thread->master, icmp_connect_thread, checker, delay);
+	checker_add_timer(checker, delay);
+}
+
+/* Outstanding echo requests */
+static inline unsigned
+ping_hashkey(uint16_t seq)
+{
+	return seq & (PING_HASH_SIZE - 1);
+}
+
+static ping_check_t * __attribute__ ((pure))
+ping_find(sa_family_t family, uint16_t seq)
+{
+	ping_check_t *ping_check;
+	hlist_node_t *pos;
+
+	hlist_for_each_entry(ping_check, pos, &ping_hash[ping_hashkey(seq)], e_hash) {
+		if (ping_check->seq == seq &&
+		    ping_check->checker->co->dst.ss_family == family)
+			return ping_check;
+	}
+
+	return NULL;
 }
 
 static void
-icmp_check_thread(thread_ref_t thread)
+ping_timer_thread(__attribute__((unused)) thread_ref_t thread)
 {
-	checker_t *checker = THREAD_ARG(thread);
-	int status;
+	ping_check_t *ping_check;
+	rb_node_t *node;
 
-	if (thread->type == THREAD_READ_TIMEOUT) {
-		if (checker->is_up &&
-		    (global_data->checker_log_all_failures || checker->log_all_failures))
-			log_message(LOG_INFO, "ICMP connection to address %s timeout.", FMT_CHK(checker));
-		status = connect_error;
-	} else
-		status = checker->co->dst.ss_family == AF_INET ?
-				recv_it(thread->u.f.fd) : recv6_it(thread->u.f.fd);
-
-	/*
-	 * If status = connect_success, then we start udp check with the record of icmp failed times.
-	 * Otherwise we will do the icmp connect again until it reaches the unhealthy threshold.
-	 * we handle fd uniform.
-	 */
-	thread_close_fd(thread);
-
-	if (status == connect_success)
-		icmp_epilog(thread, 1);
-	else if (status == connect_error) {
+	ping_timer = NULL;
+
+	while ((node = rb_first_cached(&ping_timeouts))) {
+		ping_check = rb_entry(node, ping_check_t, n);
+
+		if (timercmp(&time_now, &ping_check->sands, <)) {
+			ping_timer = thread_add_timer(master, ping_timer_thread, NULL,
+						      timer_long(ping_check->sands) - timer_long(time_now));
+			return;
+		}
+
+		ping_done(ping_check);
+
+		if (ping_check->checker->is_up &&
+		    (global_data->checker_log_all_failures || ping_check->checker->log_all_failures))
+			log_message(LOG_INFO, "ICMP connection to address %s timeout.", FMT_CHK(ping_check->checker));
+
+		icmp_epilog(ping_check->checker, false);
+	}
+}
+
+static void
+ping_add(ping_check_t *ping_check)
+{
+	conn_opts_t *co = ping_check->checker->co;
+
+	/* Pick a sequence number not in use by another outstanding request */
+	while (ping_find(co->dst.ss_family, seq_no))
+		seq_no++;
+	ping_check->seq = seq_no++;
+
+	ping_check->sands = timer_add_long(time_now, co->connection_to);
+	hlist_add_head(&ping_check->e_hash, &ping_hash[ping_hashkey(ping_check->seq)]);
+	ping_check->pending = true;
+
+	/* Adjust the timer if this is now the first timeout */
+	if (rb_add_cached(&ping_check->n, &ping_timeouts, ping_check_timer_less)) {
+		if (ping_timer)
+			timer_thread_update_timeout(ping_timer, co->connection_to);
+		else
+			ping_timer = thread_add_timer(master, ping_timer_thread, NULL, co->connection_to);
+	}
+}
+
+static void
+ping_done(ping_check_t *ping_check)
+{
+	if (!ping_check->pending)
+		return;
+
+	hlist_del_init(&ping_check->e_hash);
+	rb_erase_cached(&ping_check->n, &ping_timeouts);
+	ping_check->pending = false;
+}
+
+static void
+ping_reply(sa_family_t family, uint16_t seq, const sockaddr_t *from)
+{
+	ping_check_t *ping_check;
+
+	if (!(ping_check = ping_find(family, seq)))
+		return;
+
+	/* Make sure the reply is from the address we pinged */
+	if (inet_sockaddrcmp(from, &ping_check->checker->co->dst))
+		return;
+
+	ping_done(ping_check);
+	icmp_epilog(ping_check->checker, true);
+}
+
+static void
+ping_send(ping_check_t *ping_check)
+{
+	checker_t *checker = ping_check->checker;
+	conn_opts_t *co = checker->co;
+	ping_socket_t *sock = co->dst.ss_family == AF_INET ? &ping_sock : &ping6_sock;
+	struct icmphdr *icmp_hdr;
+	struct icmp6_hdr *icmp6_hdr;
+	char send_buf[sizeof(*icmp6_hdr) + ICMP_BUFSIZE] __attribute__((aligned(__alignof__(struct icmp6_hdr))));
+	size_t len;
+
+	ping_add(ping_check);
+
+	if (co->dst.ss_family == AF_INET) {
+		set_buf(send_buf + sizeof(*icmp_hdr), ICMP_BUFSIZE);
+		icmp_hdr = PTR_CAST(struct icmphdr, send_buf);
+		memset(icmp_hdr, 0, sizeof(*icmp_hdr));
+		icmp_hdr->type = ICMP_ECHO;
+		icmp_hdr->un.echo.sequence = ping_check->seq;
+		len = sizeof(*icmp_hdr) + ICMP_BUFSIZE;
+	} else {
+		set_buf(send_buf + sizeof(*icmp6_hdr), ICMP_BUFSIZE);
+		icmp6_hdr = PTR_CAST(struct icmp6_hdr, send_buf);
+		memset(icmp6_hdr, 0, sizeof(*icmp6_hdr));
+		icmp6_hdr->icmp6_type = ICMP6_ECHO_REQUEST;
+		icmp6_hdr->icmp6_seq = ping_check->seq;
+		len = sizeof(*icmp6_hdr) + ICMP_BUFSIZE;
+	}
+
+	if (sendto(sock->fd, send_buf, len, 0, PTR_CAST(struct sockaddr, &co->dst),
+		   co->dst.ss_family == AF_INET ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6)) < 0) {
+		log_message(LOG_INFO, "send ICMP%s packet fail - errno %d", co->dst.ss_family == AF_INET ? "" : "v6", errno);
+		ping_done(ping_check);
 		if (checker->is_up &&
-		    thread->type != THREAD_READ_TIMEOUT &&
 		    (global_data->checker_log_all_failures || checker->log_all_failures))
 			log_message(LOG_INFO, "ICMP connection to %s of %s failed."
 				,FMT_CHK(checker), FMT_VS(checker->vs));
-		icmp_epilog(thread, 0);
+		icmp_epilog(checker, false);
+	}
+}
+
+/* An ICMP error returns the echo request that caused it, so the checker
+ * can be failed at once rather than when the request times out */
+static void
+ping_error(ping_socket_t *sock)
+{
+	struct msghdr msg;
+	sockaddr_t addr;
+	struct iovec iov;
+	char control[512] __attribute__((aligned(__alignof__(struct cmsghdr))));
+	char data[sizeof(struct icmp6_hdr)] __attribute__((aligned(__alignof__(struct icmp6_hdr))));
+	struct cmsghdr *cmsg;
+	const struct sock_extended_err *sock_err;
+	ping_check_t *ping_check;
+	checker_t *checker;
+	sa_family_t family = sock == &ping_sock ? AF_INET : AF_INET6;
+	uint16_t seq;
+	int err;
+	ssize_t len;
+
+	for (;;) {
+		iov.iov_base = data;
+		iov.iov_len = sizeof(data);
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_name = &addr;
+		msg.msg_namelen = sizeof(addr);
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		if ((len = recvmsg(sock->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT)) == -1) {
+			if (!check_EAGAIN(errno) && !check_EINTR(errno))
+				log_message(LOG_INFO, "recv ICMP%s error queue failed - errno %d", family == AF_INET ? "" : "v6", errno);
+			return;
+		}
+
+		err = 0;
+		for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			sock_err = PTR_CAST_CONST(struct sock_extended_err, CMSG_DATA(cmsg));
+			if ((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR &&
+			     sock_err->ee_origin == SO_EE_ORIGIN_ICMP) ||
+			    (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR &&
+			     sock_err->ee_origin == SO_EE_ORIGIN_ICMP6))
+				err = (int)sock_err->ee_errno;
+		}
+
+		/* The data is our echo request, and the name its destination */
+		if (!err || msg.msg_namelen == 0 || (size_t)len < sizeof(data))
+			continue;
+
+		if (family == AF_INET)
+			seq = PTR_CAST(struct icmphdr, data)->un.echo.sequence;
+		else
+			seq = PTR_CAST(struct icmp6_hdr, data)->icmp6_seq;
+
+		if (!(ping_check = ping_find(family, seq)) ||
+		    inet_sockaddrcmp(&addr, &ping_check->checker->co->dst))
+			continue;
+
+		checker = ping_check->checker;
+		ping_done(ping_check);
+		if (checker->is_up &&
+		    (global_data->checker_log_all_failures || checker->log_all_failures))
+			log_message(LOG_INFO, "ICMP connection to %s of %s failed - %s."
+				,FMT_CHK(checker), FMT_VS(checker->vs), strerror(err));
+		icmp_epilog(checker, false);
+	}
+}
+
+/* Read all the replies received on a shared ICMP socket */
+static void
+ping_read_thread(thread_ref_t thread)
+{
+	ping_socket_t *sock = THREAD_ARG(thread);
+	sockaddr_t from;
+	socklen_t from_len;
+	ssize_t len;
+	const struct icmphdr *icmp_hdr;
+	const struct icmp6_hdr *icmp6_hdr;
+	char recv_buf[sizeof(*icmp6_hdr) + ICMP_BUFSIZE] __attribute__((aligned(__alignof__(struct icmp6_hdr))));
+	int i;
+
+	if (thread->type == THREAD_READ_ERROR)
+		ping_error(sock);
+
+	for (i = 0; i < PING_MAX_READ; i++) {
+		from_len = sizeof(from);
+		len = recvfrom(sock->fd, recv_buf, sizeof(recv_buf), 0, PTR_CAST(struct sockaddr, &from), &from_len);
+
+		if (len < 0) {
+			if (errno == EHOSTUNREACH || errno == ENETUNREACH || errno == ECONNREFUSED)
+				ping_error(sock);
+			else if (!check_EAGAIN(errno) && !check_EINTR(errno)) {
+				log_message(LOG_INFO, "recv ICMP%s packet error - errno %d", sock == &ping_sock ? "" : "v6", errno);
+				break;
+			} else
+				break;
+			continue;
+		}
+
+		if (sock == &ping_sock) {
+			if ((size_t)len < sizeof(*icmp_hdr)) {
+				log_message(LOG_INFO, "Error, got short ICMP packet, %zd bytes", len);
+				continue;
+			}
+
+			icmp_hdr = PTR_CAST_CONST(struct icmphdr, recv_buf);
+			if (icmp_hdr->type != ICMP_ECHOREPLY) {
+				log_message(LOG_INFO, "Got ICMP packet with type 0x%x", icmp_hdr->type);
+				continue;
+			}
+
+			ping_reply(AF_INET, icmp_hdr->un.echo.sequence, &from);
+		} else {
+			if ((size_t)len < sizeof(*icmp6_hdr)) {
+				log_message(LOG_INFO, "Error, got short ICMPv6 packet, %zd bytes", len);
+				continue;
+			}
+
+			icmp6_hdr = PTR_CAST_CONST(struct icmp6_hdr, recv_buf);
+			if (icmp6_hdr->icmp6_type != ICMP6_ECHO_REPLY) {
+				log_message(LOG_INFO, "Got ICMPv6 packet with type 0x%x", icmp6_hdr->icmp6_type);
+				continue;
+			}
+
+			ping_reply(AF_INET6, icmp6_hdr->icmp6_seq, &from);
+		}
 	}
 
-	return;
+	sock->thread = thread_add_read(thread->master, ping_read_thread, sock, sock->fd, TIMER_NEVER, 0);
+}
+
+/* Open the shared ICMP socket for the address family if not already open */
+static bool
+ping_open_socket(sa_family_t family)
+{
+	ping_socket_t *sock = family == AF_INET ? &ping_sock : &ping6_sock;
+	int size = SOCK_RECV_BUFF;
+	int on = 1;
+	int err;
+
+	if (sock->fd != -1)
+		return true;
+
+	 /*
+	  * If we config a real server in several virtual server, the icmp_ratelimit should be cancelled.
+	  * echo 0 > /proc/sys/net/ipv4/icmp_ratelimit
+	  */
+	if ((sock->fd = socket(family, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+			 family == AF_INET ? IPPROTO_ICMP : IPPROTO_ICMPV6)) == -1)
+		return false;
+
+	/* OK if setsockopt fails */
+	if (setsockopt(sock->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)))
+		log_message(LOG_INFO, "setsockopt SO_RCVBUF for socket %d failed (%d) - %m", sock->fd, errno);
+
+	/* The socket is not connected, so we need ICMP errors queued to match them to a checker */
+	if (family == AF_INET)
+		err = setsockopt(sock->fd, SOL_IP, IP_RECVERR, PTR_CAST(char, &on), sizeof(on));
+	else
+		err = setsockopt(sock->fd, SOL_IPV6, IPV6_RECVERR, PTR_CAST(char, &on), sizeof(on));
+	if (err)
+		log_message(LOG_INFO, "Error %d setting IP%s_RECVERR for socket %d - %m", errno, family == AF_INET ? "" : "V6", sock->fd);
+
+	sock->thread = thread_add_read(master, ping_read_thread, sock, sock->fd, TIMER_NEVER, 0);
+
+	return true;
 }
 
 static void
@@ -372,55 +571,60 @@ icmp_connect_thread(thread_ref_t thread)
 {
 	checker_t *checker = THREAD_ARG(thread);
 	conn_opts_t *co = checker->co;
-	int fd;
-	int status;
-	int size = SOCK_RECV_BUFF;
 
 	if (!checker->enabled) {
-		thread_add_timer(thread->master, icmp_connect_thread, checker,
-				checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
-	 /*
-	  * If we config a real server in several virtual server, the icmp_ratelimit should be cancelled.
-	  * echo 0 > /proc/sys/net/ipv4/icmp_ratelimit
-	  */
-	if ((fd = socket(co->dst.ss_family, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
-			 co->dst.ss_family == AF_INET ? IPPROTO_ICMP : IPPROTO_ICMPV6)) == -1) {
+	if (!ping_open_socket(co->dst.ss_family)) {
 		log_message(LOG_INFO, "ICMP%s connect fail to create socket. Rescheduling.",
 				co->dst.ss_family == AF_INET ? "" : "v6");
-		thread_add_timer(thread->master, icmp_connect_thread, checker,
-				checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
-	if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)))
-		log_message(LOG_INFO, "setsockopt SO_RCVBUF for socket %d failed (%d) - %m", fd, errno);
+	ping_send(checker->data);
+}
 
-	/*
-	 * OK if setsockopt fails
-	 * Prevent users from pinging broadcast or multicast addresses
-	 */
-	if (co->dst.ss_family == AF_INET)
-		status = ping_it(fd, co);
-	else
-		status = ping6_it(fd, co);
+/* Close the shared sockets and forget any outstanding requests */
+void
+checker_ping_dispatcher_release(void)
+{
+	ping_check_t *ping_check;
+	rb_node_t *node;
+	ping_socket_t *sock;
+	unsigned i;
+
+	while ((node = rb_first_cached(&ping_timeouts))) {
+		ping_check = rb_entry(node, ping_check_t, n);
+		ping_done(ping_check);
+	}
 
-	/* handle icmp send status & register check worker thread */
-	if (udp_icmp_check_state(fd, status, thread, icmp_check_thread,
-		co->connection_to)) {
-		close(fd);
-		icmp_epilog(thread, false);
+	if (ping_timer) {
+		thread_cancel(ping_timer);
+		ping_timer = NULL;
+	}
+
+	for (i = 0; i < 2; i++) {
+		sock = i ? &ping6_sock : &ping_sock;
+		if (sock->fd == -1)
+			continue;
+		if (sock->thread) {
+			thread_cancel(sock->thread);
+			sock->thread = NULL;
+		}
+		close(sock->fd);
+		sock->fd = -1;
 	}
-	return;
 }
 
 #ifdef THREAD_DUMP
 void
 register_check_ping_addresses(void)
 {
-	register_thread_address("icmp_check_thread", icmp_check_thread);
 	register_thread_address("icmp_connect_thread", icmp_connect_thread);
+	register_thread_address("ping_read_thread", ping_read_thread);
+	register_thread_address("ping_timer_thread", ping_timer_thread);
 }
 #endif
@@ -393,7 +393,7 @@ smtp_final(thread_ref_t thread, const char *format, ...)
 		}
 
 		/* Reschedule the main thread using the configured delay loop */
-		thread_add_timer(thread->master, smtp_start_check_thread, checker, checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 
 		return 0;
 	}
@@ -428,7 +428,7 @@ smtp_final(thread_ref_t thread, const char *format, ...)
 
 	checker->has_run = true;
 
-	thread_add_timer(thread->master, smtp_start_check_thread, checker, checker->delay_loop);
+	checker_add_timer(checker, checker->delay_loop);
 
 	return 0;
 }
@@ -798,8 +798,7 @@ smtp_connect_thread(thread_ref_t thread)
 	 * we don't fall of the face of the earth.
 	 */
 	if (!checker->enabled) {
-		thread_add_timer(thread->master, smtp_start_check_thread, checker,
-				 checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
@@ -808,8 +807,7 @@ smtp_connect_thread(thread_ref_t thread)
 	/* Create the socket, failing here should be an oddity */
 	if ((sd = socket(smtp_host->dst.ss_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, IPPROTO_TCP)) == -1) {
 		log_message(LOG_INFO, "SMTP_CHECK connection failed to create socket. Rescheduling.");
-		thread_add_timer(thread->master, smtp_start_check_thread, checker,
-				 checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
@@ -825,8 +823,7 @@ smtp_connect_thread(thread_ref_t thread)
 		} else {
 			close(sd);
 			log_message(LOG_INFO, "SMTP_CHECK socket bind failed. Rescheduling.");
-			thread_add_timer(thread->master, smtp_start_check_thread, checker,
-				checker->delay_loop);
+			checker_add_timer(checker, checker->delay_loop);
 		}
 	}
 }
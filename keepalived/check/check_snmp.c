@@ -190,14 +190,8 @@ enum check_snmp_realserver_magic {
 	CHECK_SNMP_RSNAME,
 };
 
-#define STATE_VSGM_FWMARK 1
-#define STATE_VSGM_ADDRESS_RANGE 2
-#define STATE_VSGM_END 3
-
 #define STATE_RS_SORRY 1
-#define STATE_RS_REGULAR_FIRST 2
-#define STATE_RS_REGULAR_NEXT 3
-#define STATE_RS_END 4
+#define STATE_RS_REGULAR 2
 
 #ifdef _WITH_VRRP_
 enum check_snmp_lvs_sync_daemon {
@@ -238,17 +232,60 @@ do {										\
 /* Static return value */
 static longret_t long_ret;
 static char buf[MAXBUF];
+static snmp_index_t rs_index;
+static snmp_index_t vsgm_index;
+
+/* The real server table has the sorry server, if any, as the first entry for each virtual server */
+static void
+check_snmp_rs_index_build(void)
+{
+	virtual_server_t *vs;
+	real_server_t *rs;
+
+	if (snmp_index_current(&rs_index))
+		return;
+
+	snmp_index_reset(&rs_index);
+	list_for_each_entry(vs, &check_data->vs, e_list) {
+		snmp_index_add_outer(&rs_index, vs);
+		if (vs->s_svr)
+			snmp_index_add(&rs_index, vs->s_svr);
+		list_for_each_entry(rs, &vs->rs, e_list)
+			snmp_index_add(&rs_index, rs);
+	}
+}
+
+/* The virtual server group member table has the fwmarks followed by the address ranges for each group */
+static void
+check_snmp_vsgm_index_build(void)
+{
+	virtual_server_group_t *group;
+	virtual_server_group_entry_t *vsge;
+
+	if (snmp_index_current(&vsgm_index))
+		return;
+
+	snmp_index_reset(&vsgm_index);
+	list_for_each_entry(group, &check_data->vs_group, e_list) {
+		snmp_index_add_outer(&vsgm_index, group);
+		list_for_each_entry(vsge, &group->vfwmark, e_list)
+			snmp_index_add(&vsgm_index, vsge);
+		list_for_each_entry(vsge, &group->addr_range, e_list)
+			snmp_index_add(&vsgm_index, vsge);
+	}
+}
 
 static u_char*
 check_snmp_vsgroup(struct variable *vp, oid *name, size_t *length,
 		   int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	virtual_server_group_t *g;
 	list_head_t *e;
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					 var_len, write_method,
-					 &check_data->vs_group)) == NULL)
+					 &check_data->vs_group, &table_index)) == NULL)
 		return NULL;
 
 	g = list_entry(e, virtual_server_group_t, e_list);
@@ -267,86 +304,13 @@ static u_char*
 check_snmp_vsgroupmember(struct variable *vp, oid *name, size_t *length,
 			 int exact, size_t *var_len, WriteMethod **write_method)
 {
-	oid *target, current[2], best[2];
-	int result;
-	size_t target_len;
-	unsigned curgroup = 0, curentry;
-	virtual_server_group_t *group;
-	virtual_server_group_entry_t *vsge, *be = NULL;
-	int state;
-	list_head_t *l;
-
-
-	if ((result = snmp_oid_compare(name, *length, vp->name, vp->namelen)) < 0) {
-		memcpy(name, vp->name, sizeof(oid) * vp->namelen);
-		*length = vp->namelen;
-	}
+	virtual_server_group_entry_t *be;
 
-	*write_method = 0;
-	*var_len = sizeof(long);
+	check_snmp_vsgm_index_build();
 
-	if (list_empty(&check_data->vs_group))
+	if (!(be = snmp_index_find(vp, name, length, exact, var_len, write_method, &vsgm_index, NULL)))
 		return NULL;
 
-	/* We search the best match: equal if exact, the lower OID in
-	   the set of the OID strictly superior to the target
-	   otherwise. */
-	best[0] = best[1] = MAX_SUBID; /* Our best match */
-	target = &name[vp->namelen];   /* Our target match */
-	target_len = *length - vp->namelen;
-	list_for_each_entry(group, &check_data->vs_group, e_list) {
-		curgroup++;
-		curentry = 0;
-		if (target_len && (curgroup < target[0]))
-			continue; /* Optimization: cannot be part of our set */
-		state = STATE_VSGM_FWMARK;
-		while (state < STATE_VSGM_END) {
-			switch (state) {
-			case STATE_VSGM_FWMARK:
-				l = &group->vfwmark;
-				break;
-			case STATE_VSGM_ADDRESS_RANGE:
-				l = &group->addr_range;
-				break;
-			default:
-				/* Dunno? */
-				return NULL;
-			}
-			state++;
-			list_for_each_entry(vsge, l, e_list) {
-				curentry++;
-				/* We build our current match */
-				current[0] = curgroup;
-				current[1] = curentry;
-				/* And compare it to our target match */
-				if ((result = snmp_oid_compare(current, 2, target,
-							       target_len)) < 0)
-					continue;
-				if ((result == 0) && !exact)
-					continue;
-				if (result == 0) {
-					/* Got an exact match and asked for it */
-					be = vsge;
-					goto vsgmember_found;
-				}
-				if (snmp_oid_compare(current, 2, best, 2) < 0) {
-					/* This is our best match */
-					memcpy(best, current, sizeof(oid) * 2);
-					be = vsge;
-					goto vsgmember_be_found;
-				}
-			}
-		}
-	}
-
-	/* Nothing found */
-	return NULL;
-
- vsgmember_be_found:
-	/* Let's use our best match */
-	memcpy(target, best, sizeof(oid) * 2);
-	*length = (unsigned)vp->namelen + 2;
- vsgmember_found:
 	switch (vp->magic) {
 	case CHECK_SNMP_VSGROUPMEMBERTYPE:
 		if (be->is_fwmark)
@@ -403,6 +367,7 @@ static u_char *
 check_snmp_virtualserver(struct variable *vp, oid *name, size_t *length,
 			 int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	static struct counter64 counter64_ret;
 	virtual_server_t *v;
 	real_server_t *rs;
@@ -411,7 +376,7 @@ check_snmp_virtualserver(struct variable *vp, oid *name, size_t *length,
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					 var_len, write_method,
-					 &check_data->vs)) == NULL)
+					 &check_data->vs, &table_index)) == NULL)
 		return NULL;
 
 	v = list_entry(e, virtual_server_t, e_list);
@@ -770,9 +735,10 @@ check_snmp_realserver_weight(int action,
 			     u_char *var_val, u_char var_val_type, size_t var_val_len,
 			     __attribute__((unused)) u_char *statP, oid *name, size_t name_len)
 {
-	virtual_server_t *vs = NULL;
-	real_server_t *rs = NULL;
-	oid ivs, irs;
+	virtual_server_t *vs;
+	real_server_t *rs;
+	void *outer = NULL;
+
 	switch (action) {
 	case RESERVE1:
 		/* Check that the proposed value is acceptable */
@@ -785,25 +751,13 @@ check_snmp_realserver_weight(int action,
 	case COMMIT:
 		/* Find the instance */
 		if (name_len < 2) return SNMP_ERR_NOSUCHNAME;
-		irs = name[name_len - 1];
-		ivs = name[name_len - 2];
-		if (list_empty(&check_data->vs))
-			return SNMP_ERR_NOSUCHNAME;
-		list_for_each_entry(vs, &check_data->vs, e_list) {
-			if (--ivs == 0) {
-				if (vs->s_svr) {
-					/* We don't want to set weight
-					   of sorry server */
-					rs = NULL;
-					if (--irs == 0) break;
-				}
-				list_for_each_entry(rs, &vs->rs, e_list) {
-					if (--irs == 0)
-						break;
-				}
-				break;
-			}
-		}
+		check_snmp_rs_index_build();
+		rs = snmp_index_row(&rs_index, name[name_len - 2], name[name_len - 1], &outer);
+		vs = outer;
+
+		/* We don't want to set weight of sorry server */
+		if (rs && rs == vs->s_svr)
+			rs = NULL;
 
 		/* Did not find a RS or this is a sorry server (this
 		   should not happen) */
@@ -824,104 +778,24 @@ check_snmp_realserver(struct variable *vp, oid *name, size_t *length,
 		      int exact, size_t *var_len, WriteMethod **write_method)
 {
 	static struct counter64 counter64_ret;
-	oid *target, current[2];
-	int result;
-	size_t target_len;
-	unsigned curvirtual = 0, curreal;
-	real_server_t *e = NULL, *be = NULL;
-	virtual_server_t *vs, *bvs = NULL;
-	int state;
+	real_server_t *be;
+	virtual_server_t *bvs = NULL;
 	int type;
 	snmp_ret_t ret;
+	void *outer;
 
-	if ((result = snmp_oid_compare(name, *length, vp->name, vp->namelen)) < 0) {
-		memcpy(name, vp->name, sizeof(oid) * vp->namelen);
-		*length = vp->namelen;
-	}
+	check_snmp_rs_index_build();
 
-	*write_method = 0;
-	*var_len = sizeof(long);
-
-	if (list_empty(&check_data->vs))
-		return NULL;
-
-	/* We search the best match: equal if exact, the lower OID in
-	   the set of the OID strictly superior to the target
-	   otherwise. */
-	target = &name[vp->namelen];   /* Our target match */
-	target_len = *length - vp->namelen;
-
-	list_for_each_entry(vs, &check_data->vs, e_list) {
-		curvirtual++;
-		current[0] = curvirtual;
-		curreal = 0;
-		if (target_len && (curvirtual < target[0]))
-			continue; /* Optimization: cannot be part of our set */
-		state = STATE_RS_SORRY;
-		while (state != STATE_RS_END) {
-			switch (state) {
-			case STATE_RS_SORRY:
-				e = vs->s_svr;
-				type = STATE_RS_SORRY;
-				state = STATE_RS_REGULAR_FIRST;
-				break;
-			case STATE_RS_REGULAR_FIRST:
-				if (list_empty(&vs->rs)) {
-					e = NULL;
-					state = STATE_RS_END;
-					break;
-				}
-				e = list_first_entry(&vs->rs, real_server_t, e_list);
-				type = STATE_RS_REGULAR_FIRST;
-				state = STATE_RS_REGULAR_NEXT;
-				break;
-			case STATE_RS_REGULAR_NEXT:
-				type = STATE_RS_REGULAR_NEXT;
-				if (list_is_last(&e->e_list, &vs->rs)) {
-					e = NULL;
-					state = STATE_RS_END;
-					break;
-				}
-				e = list_entry(e->e_list.next, real_server_t, e_list);
-				break;
-			default:
-				/* Dunno? */
-				return NULL;
-			}
-			if (!e)
-				continue;
-			curreal++;
-
-			/* We build our current match */
-			current[1] = curreal;
-
-			/* And compare it to our target match */
-			if ((result = snmp_oid_compare(current, 2, target,
-						       target_len)) < 0)
-				continue;
-			if (result == 0) {
-				/* Got an exact match. Were we asked for it? */
-				if (!exact)
-					continue;
-			} else {
-				memcpy(target, current, sizeof(oid) * 2);
-				*length = (unsigned)vp->namelen + 2;
-			}
-
-			bvs = vs;
-			be = e;
-			break;
-		}
-
-		if (be)
-			break;
-	}
+	be = snmp_index_find(vp, name, length, exact, var_len, write_method, &rs_index, &outer);
+	bvs = outer;
 
 	if (be == NULL) {
 		/* No match */
 		return NULL;
 	}
 
+	type = be == bvs->s_svr ? STATE_RS_SORRY : STATE_RS_REGULAR;
+
 	switch (vp->magic) {
 	case CHECK_SNMP_RSTYPE:
 		long_ret.u = SNMP_TruthValue(type != STATE_RS_SORRY);
@@ -62,6 +62,44 @@ password_cb(char *buf, int num, __attribute__((unused)) int rwflag, void *userda
 	return (int)plen;
 }
 
+/* A new session has been established, or a TLSv1.3 session ticket
+ * received. Save it to be resumed when the checker next connects. */
+static int
+ssl_new_session(SSL *ssl, SSL_SESSION *session)
+{
+	checker_t *checker = SSL_get_app_data(ssl);
+	http_checker_t *http_get_check;
+
+	if (!checker)
+		return 0;
+
+	http_get_check = CHECKER_ARG(checker);
+	if (http_get_check->ssl_session)
+		SSL_SESSION_free(http_get_check->ssl_session);
+
+#ifdef HAVE_SSL_SESSION_DUP
+	/* OpenSSL marks the connection's session as not resumable if the
+	 * connection is not shut down cleanly, so keep a copy */
+	http_get_check->ssl_session = SSL_SESSION_dup(session);
+
+	return 0;
+#else
+	http_get_check->ssl_session = session;
+
+	/* We have taken the reference to the session */
+	return 1;
+#endif
+}
+
+void
+ssl_free_session(http_checker_t *http_get_check)
+{
+	if (http_get_check->ssl_session) {
+		SSL_SESSION_free(http_get_check->ssl_session);
+		http_get_check->ssl_session = NULL;
+	}
+}
+
 /* Inititalize global SSL context */
 static bool
 build_ssl_ctx(void)
@@ -145,6 +183,10 @@ build_ssl_ctx(void)
 	SSL_CTX_set_verify_depth(ssl->ctx, 1);
 #endif
 
+	/* Sessions are stored per checker rather than in the context */
+	SSL_CTX_set_session_cache_mode(ssl->ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(ssl->ctx, ssl_new_session);
+
 	return true;
 }
 
@@ -241,6 +283,12 @@ ssl_connect(thread_ref_t thread, int new_req)
 #else
 		SSL_set_bio(req->ssl, req->bio, req->bio);
 #endif
+		SSL_set_app_data(req->ssl, checker);
+
+		/* Offer the last session to avoid a full handshake */
+		if (http_get_check->ssl_session &&
+		    !SSL_set_session(req->ssl, http_get_check->ssl_session))
+			ssl_free_session(http_get_check);
 #ifdef _HAVE_SSL_SET_TLSEXT_HOST_NAME_
 		if (http_get_check->enable_sni) {
 			if (url && url->virtualhost)
@@ -259,6 +307,13 @@ ssl_connect(thread_ref_t thread, int new_req)
 
 	ret = SSL_connect(req->ssl);
 
+	if (ret == 1) {
+		if (SSL_session_reused(req->ssl))
+			http_get_check->ssl_resumed++;
+		else
+			http_get_check->ssl_full_handshakes++;
+	}
+
 	return ret;
 }
 
@@ -318,6 +373,18 @@ ssl_read_thread(thread_ref_t thread)
 		/* Handle response stream */
 		http_process_response(thread, req, (size_t)r, url);
 
+		if (http_response_done(req)) {
+			/* Any further data means the connection can't be reused */
+			if (SSL_pending(req->ssl))
+				req->keep_conn = false;
+			if (!req->keep_conn) {
+				SSL_set_quiet_shutdown(req->ssl, 1);
+				SSL_shutdown(req->ssl);
+			}
+			http_handle_complete_response(thread, req, url);
+			return;
+		}
+
 		/*
 		 * Register next ssl stream reader.
 		 * Register itself to not perturbe global I/O multiplexer.
@@ -325,6 +392,9 @@ ssl_read_thread(thread_ref_t thread)
 		thread_add_read(thread->master, ssl_read_thread, checker,
 				thread->u.f.fd, timeout, THREAD_DESTROY_CLOSE_FD);
 	} else if (req->error) {
+		if (http_reconnect_reused(thread))
+			return;
+
 		/* All the SSL stream has been parsed */
 		if (url->digest) {
 			EVP_DigestFinal_ex(req->context, digest, NULL);
@@ -146,7 +146,7 @@ tcp_epilog(thread_ref_t thread, bool is_success)
 	checker->has_run = true;
 
 	/* Register next timer checker */
-	thread_add_timer(thread->master, tcp_connect_thread, checker, delay);
+	checker_add_timer(checker, delay);
 }
 
 static void
@@ -197,15 +197,13 @@ tcp_connect_thread(thread_ref_t thread)
 	 * if checker is disabled
 	 */
 	if (!checker->enabled) {
-		thread_add_timer(thread->master, tcp_connect_thread, checker,
-				 checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
 	if ((fd = socket(co->dst.ss_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, IPPROTO_TCP)) == -1) {
 		log_message(LOG_INFO, "TCP connect fail to create socket. Rescheduling.");
-		thread_add_timer(thread->master, tcp_connect_thread, checker,
-				checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 
 		return;
 	}
@@ -221,8 +219,7 @@ tcp_connect_thread(thread_ref_t thread)
 			tcp_epilog(thread, false);
 		} else {
 			log_message(LOG_INFO, "TCP socket bind failed. Rescheduling.");
-			thread_add_timer(thread->master, tcp_connect_thread, checker,
-					checker->delay_loop);
+			checker_add_timer(checker, checker->delay_loop);
 		}
 	}
 }
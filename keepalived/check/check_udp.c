@@ -39,8 +39,12 @@
 #include "utils.h"
 #include "parser.h"
 #include "check_parser.h"
+#include "check_udp_pool.h"
+
+#define UDP_BUFSIZE	32
 
 static void udp_connect_thread(thread_ref_t);
+static bool udp_check_reply(udp_pool_req_t *, enum connect_result, const uint8_t *, size_t);
 
 /* Configuration stream handling */
 static void
@@ -48,6 +52,7 @@ free_udp_check(checker_t *checker)
 {
 	udp_check_t *udp_check = CHECKER_ARG(checker);
 
+	udp_pool_cancel(&udp_check->req);
 	FREE_PTR(udp_check->payload);
 	FREE_PTR(udp_check->reply_data);
 	FREE_PTR(udp_check->reply_mask);
@@ -96,6 +101,8 @@ udp_check_handler(__attribute__((unused)) const vector_t *strvec)
 
 	/* queue new checker */
 	queue_checker(&udp_checker_funcs, udp_connect_thread, udp_check, CHECKER_NEW_CO(), true);
+	udp_check->req.checker = current_checker;
+	udp_check->req.func = udp_check_reply;
 }
 
 static void
@@ -202,15 +209,12 @@ install_udp_check_keyword(void)
 }
 
 static void
-udp_epilog(thread_ref_t thread, bool is_success)
+udp_epilog(checker_t *checker, bool is_success)
 {
-	checker_t *checker;
 	unsigned long delay;
 	bool checker_was_up;
 	bool rs_was_alive;
 
-	checker = THREAD_ARG(thread);
-
 	delay = checker->delay_loop;
 	if (is_success || ((checker->is_up || !checker->has_run) && checker->retry_it >= checker->retry)) {
 		checker->retry_it = 0;
@@ -251,7 +255,7 @@ udp_epilog(thread_ref_t thread, bool is_success)
 
 	checker->has_run = true;
 
-	thread_add_timer(thread->master, udp_connect_thread, checker, delay);
+	checker_add_timer(checker, delay);
 }
 
 static bool
@@ -279,45 +283,36 @@ check_udp_reply(const uint8_t *recv_data, size_t len, const udp_check_t *udp_che
 	return false;
 }
 
-static void
-udp_check_thread(thread_ref_t thread)
+/* Called by the UDP socket pool with the reply, an ICMP error or a timeout */
+static bool
+udp_check_reply(udp_pool_req_t *req, enum connect_result status, const uint8_t *buf, size_t len)
 {
-	checker_t *checker = THREAD_ARG(thread);
+	checker_t *checker = req->checker;
 	udp_check_t *udp_check = CHECKER_ARG(checker);
-	int status;
-	uint8_t *recv_buf;
-	size_t len = udp_check->max_reply_len + 1;
-
-	recv_buf = udp_check->require_reply ?
-			MALLOC(udp_check->max_reply_len + 1) :
-			NULL;
-
-	status = udp_socket_state(thread->u.f.fd, thread, recv_buf, &len);
 
-	thread_close_fd(thread);
+	/* A timeout is success unless require_reply is set */
+	if (status == connect_timeout && !udp_check->require_reply)
+		status = connect_success;
 
 	if (status == connect_success) {
 		/* coverity[var_deref_model] - udp_check->reply_data is only set if udp_check->require_reply is set */
-		if (udp_check->reply_data && check_udp_reply(recv_buf, len, udp_check)) {
+		if (buf && udp_check->reply_data && check_udp_reply(buf, len, udp_check)) {
 			if (checker->is_up &&
 			    (global_data->checker_log_all_failures || checker->log_all_failures))
 				log_message(LOG_INFO, "UDP check to %s reply data mismatch."
 						, FMT_CHK(checker));
-			udp_epilog(thread, false);
+			udp_epilog(checker, false);
 		} else
-			udp_epilog(thread, true);
+			udp_epilog(checker, true);
 	} else {
 		if (checker->is_up &&
 		    (global_data->checker_log_all_failures || checker->log_all_failures))
 			log_message(LOG_INFO, "UDP connection to %s failed."
 					, FMT_CHK(checker));
-		udp_epilog(thread, false);
+		udp_epilog(checker, false);
 	}
 
-	if (recv_buf)
-		FREE(recv_buf);
-
-	return;
+	return true;
 }
 
 static void
@@ -325,44 +320,34 @@ udp_connect_thread(thread_ref_t thread)
 {
 	checker_t *checker = THREAD_ARG(thread);
 	udp_check_t *udp_check = CHECKER_ARG(checker);
-	conn_opts_t *co = checker->co;
-	int fd;
-	int status;
+	char buf[UDP_BUFSIZE];
+	enum connect_result status;
 
 	/*
 	 * Register a new checker thread & return
 	 * if checker is disabled
 	 */
 	if (!checker->enabled) {
-		thread_add_timer(thread->master, udp_connect_thread, checker,
-				 checker->delay_loop);
+		checker_add_timer(checker, checker->delay_loop);
 		return;
 	}
 
-	if ((fd = socket(co->dst.ss_family, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, IPPROTO_UDP)) == -1) {
-		log_message(LOG_INFO, "UDP connect fail to create socket. Rescheduling.");
-		thread_add_timer(thread->master, udp_connect_thread, checker,
-				checker->delay_loop);
-
-		return;
-	}
-
-	status = udp_bind_connect(fd, co, udp_check->payload, udp_check->payload_len);
-
-	/* handle udp connection status & register check worker thread */
-	if (udp_icmp_check_state(fd, status, thread, udp_check_thread, co->connection_to)) {
-		close(fd);
-		udp_epilog(thread, false);
+	/* Send the payload, or something that doesn't leak our stack */
+	if (udp_check->payload)
+		status = udp_pool_send(&udp_check->req, udp_check->payload, udp_check->payload_len);
+	else {
+		set_buf(buf, sizeof(buf));
+		status = udp_pool_send(&udp_check->req, buf, sizeof(buf));
 	}
 
-	return;
+	if (status != connect_success)
+		udp_check_reply(&udp_check->req, connect_error, NULL, 0);
 }
 
 #ifdef THREAD_DUMP
 void
 register_check_udp_addresses(void)
 {
-	register_thread_address("udp_check_thread", udp_check_thread);
 	register_thread_address("udp_connect_thread", udp_connect_thread);
 }
 #endif
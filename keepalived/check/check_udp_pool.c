@@ -0,0 +1,422 @@
+/*
+ * Soft:        Keepalived is a failover program for the LVS project
+ *              <www.linuxvirtualserver.org>. It monitor & manipulate
+ *              a loadbalanced server pool using multi-layer checks.
+ *
+ * Part:        Pool of UDP sockets shared by the DNS and UDP checkers.
+ *
+ * Author:      Alexandre Cassen, <acassen@linux-vs.org>
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *              See the GNU General Public License for more details.
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              as published by the Free Software Foundation; either version
+ *              2 of the License, or (at your option) any later version.
+ *
+ * Copyright (C) 2001-2024 Alexandre Cassen, <acassen@gmail.com>
+ */
+
+#include "config.h"
+
+/* system includes */
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <linux/icmp.h>
+#include <linux/icmpv6.h>
+#ifdef ERRQUEUE_NEEDS_SYS_TIME
+#include <sys/time.h>
+#endif
+#include <linux/errqueue.h>
+
+/* local includes */
+#include "check_udp_pool.h"
+#include "memory.h"
+#include "logger.h"
+#include "scheduler.h"
+#include "utils.h"
+#include "rbtree.h"
+
+#define UDP_POOL_HASH_BITS	8
+#define UDP_POOL_HASH_SIZE	(1U << UDP_POOL_HASH_BITS)
+#define UDP_POOL_MAX_READ	64	/* Datagrams read before returning to the scheduler */
+
+/* A socket is shared by all the checks with the same source address,
+ * interface and fwmark. A further socket is only opened if a check
+ * would otherwise be indistinguishable from one already outstanding. */
+struct _udp_pool_sock {
+	int			fd;
+	sa_family_t		family;
+	sockaddr_t		bindto;
+	char			bind_if[IFNAMSIZ];
+#ifdef _WITH_SO_MARK_
+	unsigned		fwmark;
+#endif
+	thread_ref_t		thread;
+	list_head_t		e_list;
+};
+
+static LIST_HEAD_INITIALIZE(udp_pool_socks);
+
+/* Outstanding requests, by destination and by timeout */
+static hlist_head_t udp_pool_hash[UDP_POOL_HASH_SIZE];
+static rb_root_cached_t udp_pool_timeouts = RB_ROOT_CACHED;
+static thread_ref_t udp_pool_timer;
+
+/* Large enough for any datagram */
+static uint8_t udp_pool_buf[UINT16_MAX + 1];
+
+RB_TIMER_LESS(udp_pool_req, n);
+
+static inline unsigned
+udp_pool_hashkey(const sockaddr_t *addr)
+{
+	uint32_t key;
+
+	if (addr->ss_family == AF_INET)
+		key = PTR_CAST_CONST(struct sockaddr_in, addr)->sin_addr.s_addr;
+	else
+		key = PTR_CAST_CONST(struct sockaddr_in6, addr)->sin6_addr.s6_addr32[3];
+
+	key ^= inet_sockaddrport(addr);
+	key ^= key >> 16;
+
+	return (key ^ (key >> UDP_POOL_HASH_BITS)) & (UDP_POOL_HASH_SIZE - 1);
+}
+
+static inline bool __attribute__ ((pure))
+udp_pool_addr_equal(const sockaddr_t *a, const sockaddr_t *b)
+{
+	if (a->ss_family != b->ss_family)
+		return false;
+	if (a->ss_family == AF_UNSPEC)
+		return true;
+
+	return !inet_sockaddrcmp(a, b) && inet_sockaddrport(a) == inet_sockaddrport(b);
+}
+
+/* Return the first outstanding request on the socket to addr matching id */
+static udp_pool_req_t * __attribute__ ((pure))
+udp_pool_find(const udp_pool_sock_t *sock, const sockaddr_t *addr, bool match_id, uint16_t id)
+{
+	udp_pool_req_t *req;
+	hlist_node_t *pos;
+
+	hlist_for_each_entry(req, pos, &udp_pool_hash[udp_pool_hashkey(addr)], e_hash) {
+		if (req->sock == sock &&
+		    udp_pool_addr_equal(&req->checker->co->dst, addr) &&
+		    (!match_id || !req->match_id || req->id == id))
+			return req;
+	}
+
+	return NULL;
+}
+
+static inline bool __attribute__ ((pure))
+udp_pool_sock_match(const udp_pool_sock_t *sock, const conn_opts_t *co)
+{
+	return sock->family == co->dst.ss_family &&
+	       udp_pool_addr_equal(&sock->bindto, &co->bindto) &&
+#ifdef _WITH_SO_MARK_
+	       sock->fwmark == co->fwmark &&
+#endif
+	       !strcmp(sock->bind_if, co->bind_if);
+}
+
+static void
+udp_pool_done(udp_pool_req_t *req)
+{
+	if (!req->pending)
+		return;
+
+	hlist_del_init(&req->e_hash);
+	rb_erase_cached(&req->n, &udp_pool_timeouts);
+	req->pending = false;
+}
+
+static void
+udp_pool_timer_thread(__attribute__((unused)) thread_ref_t thread)
+{
+	udp_pool_req_t *req;
+	rb_node_t *node;
+
+	udp_pool_timer = NULL;
+
+	while ((node = rb_first_cached(&udp_pool_timeouts))) {
+		req = rb_entry(node, udp_pool_req_t, n);
+
+		if (timercmp(&time_now, &req->sands, <)) {
+			udp_pool_timer = thread_add_timer(master, udp_pool_timer_thread, NULL,
+							  timer_long(req->sands) - timer_long(time_now));
+			return;
+		}
+
+		udp_pool_done(req);
+		req->func(req, connect_timeout, NULL, 0);
+	}
+}
+
+static void
+udp_pool_add(udp_pool_req_t *req, udp_pool_sock_t *sock)
+{
+	const conn_opts_t *co = req->checker->co;
+
+	req->sock = sock;
+	req->sands = timer_add_long(time_now, co->connection_to);
+	hlist_add_head(&req->e_hash, &udp_pool_hash[udp_pool_hashkey(&co->dst)]);
+	req->pending = true;
+
+	/* Adjust the timer if this is now the first timeout */
+	if (rb_add_cached(&req->n, &udp_pool_timeouts, udp_pool_req_timer_less)) {
+		if (udp_pool_timer)
+			timer_thread_update_timeout(udp_pool_timer, co->connection_to);
+		else
+			udp_pool_timer = thread_add_timer(master, udp_pool_timer_thread, NULL, co->connection_to);
+	}
+}
+
+/* An ICMP unreachable fails every request outstanding to the destination */
+static void
+udp_pool_error(udp_pool_sock_t *sock)
+{
+	struct msghdr msg;
+	sockaddr_t addr;
+	struct iovec iov;
+	char control[512] __attribute__((aligned(__alignof__(struct cmsghdr))));
+	uint8_t data[8];
+	struct cmsghdr *cmsg;
+	const struct sock_extended_err *sock_err;
+	udp_pool_req_t *req;
+	bool unreach;
+
+	for (;;) {
+		iov.iov_base = data;
+		iov.iov_len = sizeof(data);
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_name = &addr;
+		msg.msg_namelen = sizeof(addr);
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		if (recvmsg(sock->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+			if (!check_EAGAIN(errno) && !check_EINTR(errno))
+				log_message(LOG_INFO, "udp_pool_error recvmsg failed - errno %d", errno);
+			return;
+		}
+
+		unreach = false;
+		for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			sock_err = PTR_CAST_CONST(struct sock_extended_err, CMSG_DATA(cmsg));
+			if (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+				unreach = sock_err->ee_origin == SO_EE_ORIGIN_ICMP && sock_err->ee_type == ICMP_DEST_UNREACH;
+			else if (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)
+				unreach = sock_err->ee_origin == SO_EE_ORIGIN_ICMP6 && sock_err->ee_type == ICMPV6_DEST_UNREACH;
+		}
+
+		/* The name is the destination of the datagram that caused the error */
+		if (!unreach || msg.msg_namelen == 0)
+			continue;
+
+		while ((req = udp_pool_find(sock, &addr, false, 0))) {
+			udp_pool_done(req);
+			req->func(req, connect_error, NULL, 0);
+		}
+	}
+}
+
+/* Read all the datagrams received on a pooled socket */
+static void
+udp_pool_read_thread(thread_ref_t thread)
+{
+	udp_pool_sock_t *sock = THREAD_ARG(thread);
+	sockaddr_t from;
+	socklen_t from_len;
+	ssize_t len;
+	udp_pool_req_t *req;
+	uint16_t id;
+	int i;
+
+	if (thread->type == THREAD_READ_ERROR)
+		udp_pool_error(sock);
+
+	for (i = 0; i < UDP_POOL_MAX_READ; i++) {
+		from_len = sizeof(from);
+		len = recvfrom(sock->fd, udp_pool_buf, sizeof(udp_pool_buf), 0, PTR_CAST(struct sockaddr, &from), &from_len);
+
+		if (len < 0) {
+			if (errno == ECONNREFUSED || errno == EHOSTUNREACH || errno == ENETUNREACH)
+				udp_pool_error(sock);
+			else if (!check_EAGAIN(errno) && !check_EINTR(errno)) {
+				log_message(LOG_INFO, "UDP pool recvfrom error %d - %m", errno);
+				break;
+			} else
+				break;
+			continue;
+		}
+
+		id = len >= (ssize_t)sizeof(id) ? *PTR_CAST(uint16_t, udp_pool_buf) : 0;
+		if (!(req = udp_pool_find(sock, &from, len >= (ssize_t)sizeof(id), id)) ||
+		    (req->match_id && len < (ssize_t)sizeof(id)))
+			continue;
+
+		if (req->func(req, connect_success, udp_pool_buf, (size_t)len))
+			udp_pool_done(req);
+	}
+
+	sock->thread = thread_add_read(thread->master, udp_pool_read_thread, sock, sock->fd, TIMER_NEVER, 0);
+}
+
+static udp_pool_sock_t *
+udp_pool_open_socket(conn_opts_t *co)
+{
+	udp_pool_sock_t *sock;
+	int fd;
+	int on = 1;
+	int err;
+
+	if ((fd = socket(co->dst.ss_family, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, IPPROTO_UDP)) == -1) {
+		log_message(LOG_INFO, "UDP pool failed to create socket - errno %d (%m)", errno);
+		return NULL;
+	}
+
+	/* We want to be able to receive ICMP error responses */
+	if (co->dst.ss_family == AF_INET)
+		err = setsockopt(fd, SOL_IP, IP_RECVERR, PTR_CAST(char, &on), sizeof(on));
+	else
+		err = setsockopt(fd, SOL_IPV6, IPV6_RECVERR, PTR_CAST(char, &on), sizeof(on));
+	if (err)
+		log_message(LOG_INFO, "Error %d setting IP%s_RECVERR for socket %d - %m", errno, co->dst.ss_family == AF_INET ? "" : "V6", fd);
+
+#ifdef _WITH_SO_MARK_
+	if (co->fwmark &&
+	    setsockopt(fd, SOL_SOCKET, SO_MARK, &co->fwmark, sizeof (co->fwmark)) < 0) {
+		log_message(LOG_ERR, "Error setting fwmark %u to socket: %s", co->fwmark, strerror(errno));
+		close(fd);
+		return NULL;
+	}
+#endif
+
+	if (co->bind_if[0] &&
+	    setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, co->bind_if, (unsigned)strlen(co->bind_if) + 1) < 0) {
+		log_message(LOG_INFO, "Checker can't bind to device %s: %s", co->bind_if, strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	if (co->bindto.ss_family != AF_UNSPEC &&
+	    bind(fd, PTR_CAST_CONST(struct sockaddr, &co->bindto), sizeof(co->bindto))) {
+		log_message(LOG_INFO, "bind failed. errno: %d, error: %s", errno, strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	PMALLOC(sock);
+	INIT_LIST_HEAD(&sock->e_list);
+	sock->fd = fd;
+	sock->family = co->dst.ss_family;
+	sock->bindto = co->bindto;
+	strcpy(sock->bind_if, co->bind_if);
+#ifdef _WITH_SO_MARK_
+	sock->fwmark = co->fwmark;
+#endif
+	sock->thread = thread_add_read(master, udp_pool_read_thread, sock, fd, TIMER_NEVER, 0);
+	list_add_tail(&sock->e_list, &udp_pool_socks);
+
+	return sock;
+}
+
+/* Send the datagram on a pooled socket and wait for the reply */
+enum connect_result
+udp_pool_send(udp_pool_req_t *req, const void *buf, size_t len)
+{
+	conn_opts_t *co = req->checker->co;
+	udp_pool_sock_t *sock, *sock_found = NULL;
+	ssize_t ret;
+
+	udp_pool_done(req);
+
+	list_for_each_entry(sock, &udp_pool_socks, e_list) {
+		if (udp_pool_sock_match(sock, co) &&
+		    !udp_pool_find(sock, &co->dst, req->match_id, req->id)) {
+			sock_found = sock;
+			break;
+		}
+	}
+
+	if (!(sock = sock_found) &&
+	    !(sock = udp_pool_open_socket(co)))
+		return connect_error;
+
+	ret = sendto(sock->fd, buf, len, 0, PTR_CAST_CONST(struct sockaddr, &co->dst),
+		     co->dst.ss_family == AF_INET ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6));
+
+	if (ret == (ssize_t)len) {
+		udp_pool_add(req, sock);
+		return connect_success;
+	}
+
+	if (ret == -1) {
+		/* We want to know about the error, but not repeatedly */
+		if (errno != co->last_errno) {
+			co->last_errno = errno;
+			if (__test_bit(LOG_DETAIL_BIT, &debug))
+				log_message(LOG_INFO, "UDP send error %d - %m", errno);
+		}
+
+		if (errno == ENETUNREACH || errno == EHOSTUNREACH ||
+		    errno == ECONNREFUSED || errno == ENETDOWN)
+			return connect_fail;
+	}
+	else if (__test_bit(LOG_DETAIL_BIT, &debug))
+		log_message(LOG_INFO, "udp_pool_send - sent %zd bytes instead of %zu", ret, len);
+
+	return connect_error;
+}
+
+void
+udp_pool_cancel(udp_pool_req_t *req)
+{
+	udp_pool_done(req);
+}
+
+/* Close the pooled sockets and forget any outstanding requests */
+void
+udp_pool_release(void)
+{
+	udp_pool_sock_t *sock, *sock_tmp;
+	rb_node_t *node;
+
+	while ((node = rb_first_cached(&udp_pool_timeouts)))
+		udp_pool_done(rb_entry(node, udp_pool_req_t, n));
+
+	if (udp_pool_timer) {
+		thread_cancel(udp_pool_timer);
+		udp_pool_timer = NULL;
+	}
+
+	list_for_each_entry_safe(sock, sock_tmp, &udp_pool_socks, e_list) {
+		if (sock->thread)
+			thread_cancel(sock->thread);
+		close(sock->fd);
+		list_del_init(&sock->e_list);
+		FREE(sock);
+	}
+}
+
+#ifdef THREAD_DUMP
+void
+register_check_udp_pool_addresses(void)
+{
+	register_thread_address("udp_pool_read_thread", udp_pool_read_thread);
+	register_thread_address("udp_pool_timer_thread", udp_pool_timer_thread);
+}
+#endif
@@ -46,6 +46,56 @@
 
 static bool no_ipvs = false;
 
+/* Commands queued in an IPVS batch, kept for reporting errors */
+typedef struct _ipvs_batch_cmd {
+	int			cmd;
+	bool			ignore_error;
+	ipvs_service_t		srule;
+	ipvs_dest_t		drule;
+
+	/* The real server of a destination command, if issued by ipvs_cmd() */
+	virtual_server_t	*vs;
+	real_server_t		*rs;
+
+	/* Linking pointer */
+	list_head_t		e_list;
+} ipvs_batch_cmd_t;
+
+static LIST_HEAD_INITIALIZE(ipvs_batch_cmds);
+static bool ipvs_batching;
+
+/* The real server of the destination command being issued */
+static virtual_server_t *ipvs_cmd_vs;
+static real_server_t *ipvs_cmd_rs;
+
+/* Commands from checker state and weight changes are queued, and sent
+ * from their own thread. The oldest queued command waits at most
+ * IPVS_QUEUE_DELAY before it is sent. */
+#define IPVS_QUEUE_DELAY	(TIMER_HZ / 100)
+#define IPVS_QUEUE_MAX		256
+
+static LIST_HEAD_INITIALIZE(ipvs_queue);
+static unsigned ipvs_queue_len;
+static timeval_t ipvs_queue_oldest;
+static thread_ref_t ipvs_queue_thread;
+static bool ipvs_queueing;
+static bool ipvs_queue_flushing;
+
+static struct {
+	uint64_t		queued;
+	uint64_t		coalesced;
+	uint64_t		flushes;
+	unsigned		max_len;
+	unsigned long		max_delay;
+} ipvs_queue_stats;
+
+#ifdef _WITH_SNMP_CHECKER_
+static void ipvs_stats_free(void);
+#endif
+static void ipvs_queue_flush(void);
+static int ipvs_talk(int, ipvs_service_t *, ipvs_dest_t *, ipvs_daemon_t *, bool);
+static void update_vsge_alive_count(virtual_server_group_entry_t *, const virtual_server_t *, bool);
+
 static const char * __attribute__((pure))
 ipvs_cmd_str(int cmd)
 {
@@ -69,16 +119,9 @@ ipvs_cmd_str(int cmd)
 
 /* fetch virtual server group from group name */
 virtual_server_group_t * __attribute__ ((pure))
-ipvs_get_group_by_name(const char *gname, list_head_t *l)
+ipvs_get_group_by_name(const char *gname, const check_data_t *data)
 {
-	virtual_server_group_t *vsg;
-
-	list_for_each_entry(vsg, l, e_list) {
-		if (!strcmp(vsg->gname, gname))
-			return vsg;
-	}
-
-	return NULL;
+	return name_hash_find_entry(&data->vs_group_by_name, gname, virtual_server_group_t, e_name);
 }
 
 /* Initialization helpers */
@@ -105,10 +148,18 @@ ipvs_stop(void)
 	if (no_ipvs)
 		return;
 
+	/* The thread master has already been cleaned up */
+	ipvs_queue_thread = NULL;
+	ipvs_queue_flush();
+
 	/* Restore any timeout values we updated */
 	/* coverity[check_return] - we can't do anything if this fails */
 	ipvs_set_timeout(NULL);
 
+#ifdef _WITH_SNMP_CHECKER_
+	ipvs_stats_free();
+#endif
+
 	ipvs_close();
 }
 
@@ -163,15 +214,234 @@ format_drule(char *buf, const ipvs_dest_t *drule)
 	return (bufp - buf);
 }
 
+/* Log the failure of an IPVS command */
+static int
+ipvs_talk_result(int cmd, int result, ipvs_service_t *srule, ipvs_dest_t *drule, bool ignore_error)
+{
+	if (ignore_error)
+		result = 0;
+	else if (result) {
+		char buf[2 + INET6_ADDRSTRLEN + 6 + 5 + 4 + INET6_ADDRSTRLEN + 1 + 5 + 1 + 1];	/* " (" + IPv6 + ":sctp:" + port + " -> " + IPV6 + ":" + port + ")" */
+
+		if (errno == EEXIST &&
+			(cmd == IP_VS_SO_SET_ADD || cmd == IP_VS_SO_SET_ADDDEST))
+			result = 0;
+		else if (errno == ENOENT &&
+			(cmd == IP_VS_SO_SET_DEL || cmd == IP_VS_SO_SET_DELDEST))
+			result = 0;
+
+		buf[0] = ' ';
+		buf[1] = '(';
+		if (cmd == IP_VS_SO_SET_ADD || cmd == IP_VS_SO_SET_DEL || cmd == IP_VS_SO_SET_EDIT)
+			format_srule(buf + 2, srule);
+		else if (cmd == IP_VS_SO_SET_ADDDEST || cmd == IP_VS_SO_SET_DELDEST || cmd == IP_VS_SO_SET_EDITDEST)
+			format_drule(buf + 2 + format_srule(buf + 2, srule), drule);
+		else
+			buf[0] = '\0';
+		if (buf[0])
+			strcat(buf, ")");
+
+		log_message(LOG_INFO, "IPVS cmd %s(%d) error: %s(%d)%s", ipvs_cmd_str(cmd), cmd, ipvs_strerror(errno), errno, buf);
+	}
+	return result;
+}
+
+static bool __attribute__((pure))
+ipvs_same_dest(const ipvs_service_t *s1, const ipvs_dest_t *d1, const ipvs_service_t *s2, const ipvs_dest_t *d2)
+{
+	return s1->af == s2->af &&
+	       s1->user.fwmark == s2->user.fwmark &&
+	       s1->user.protocol == s2->user.protocol &&
+	       s1->user.port == s2->user.port &&
+	       !memcmp(&s1->nf_addr, &s2->nf_addr, sizeof(s1->nf_addr)) &&
+	       d1->af == d2->af &&
+	       d1->user.port == d2->user.port &&
+	       !memcmp(&d1->nf_addr, &d2->nf_addr, sizeof(d1->nf_addr));
+}
+
+/* Restore the vsg entry alive counts changed when the command was issued */
+static void
+ipvs_restore_vsge_alive(int cmd, virtual_server_t *vs)
+{
+	virtual_server_group_entry_t *vsg_entry;
+
+	list_for_each_entry(vsg_entry, &vs->vsg->addr_range, e_list)
+		update_vsge_alive_count(vsg_entry, vs, cmd != IP_VS_SO_SET_ADDDEST);
+	list_for_each_entry(vsg_entry, &vs->vsg->vfwmark, e_list)
+		update_vsge_alive_count(vsg_entry, vs, cmd != IP_VS_SO_SET_ADDDEST);
+}
+
+/* A destination command that was reported as successful when it was
+ * queued has failed. Restore the real server's state, so that its next
+ * check issues the command again. */
+static void
+ipvs_dest_cmd_failed(int cmd, const ipvs_dest_t *drule, virtual_server_t *vs, real_server_t *rs)
+{
+	bool up;
+
+	/* A weight change, which can't be undone */
+	if (cmd == IP_VS_SO_SET_EDITDEST && drule->user.weight && !rs->inhibit)
+		return;
+
+	/* With inhibit, a removal is an edit to weight 0 */
+	up = cmd == IP_VS_SO_SET_ADDDEST ||
+	     (cmd == IP_VS_SO_SET_EDITDEST && drule->user.weight);
+
+	/* A group sends a command for each entry, but is only restored once */
+	if (rs->alive != up)
+		return;
+
+	log_message(LOG_INFO, "Restoring service %s of VS %s to %s after IPVS error"
+			    , FMT_RS(rs, vs), FMT_VS(vs), up ? "down" : "up");
+
+	rs->alive = !up;
+	if (cmd == IP_VS_SO_SET_ADDDEST)
+		rs->set = false;
+	else if (cmd == IP_VS_SO_SET_DELDEST)
+		rs->set = true;
+
+	if (vs->vsg && cmd != IP_VS_SO_SET_EDITDEST)
+		ipvs_restore_vsge_alive(cmd, vs);
+
+	rs->ipvs_retry = true;
+}
+
+static void
+ipvs_queue_thread_func(__attribute__((unused)) thread_ref_t thread)
+{
+	ipvs_queue_thread = NULL;
+	ipvs_queue_flush();
+}
+
+static void
+ipvs_queue_cmd(int cmd, ipvs_service_t *srule, ipvs_dest_t *drule, bool ignore_error)
+{
+	ipvs_batch_cmd_t *qcmd;
+
+	ipvs_queue_stats.queued++;
+
+	/* A weight change replaces a pending add or weight change of the same
+	 * destination, since only the latest weight matters. */
+	if (cmd == IP_VS_SO_SET_EDITDEST) {
+		list_for_each_entry_reverse(qcmd, &ipvs_queue, e_list) {
+			if (!ipvs_same_dest(&qcmd->srule, &qcmd->drule, srule, drule))
+				continue;
+
+			if (qcmd->cmd == IP_VS_SO_SET_DELDEST)
+				break;
+
+			qcmd->drule = *drule;
+			qcmd->ignore_error = ignore_error;
+			qcmd->vs = ipvs_cmd_vs;
+			qcmd->rs = ipvs_cmd_rs;
+			ipvs_queue_stats.coalesced++;
+			return;
+		}
+	}
+
+	PMALLOC(qcmd);
+	qcmd->cmd = cmd;
+	qcmd->ignore_error = ignore_error;
+	qcmd->srule = *srule;
+	qcmd->drule = *drule;
+	qcmd->vs = ipvs_cmd_vs;
+	qcmd->rs = ipvs_cmd_rs;
+	list_add_tail(&qcmd->e_list, &ipvs_queue);
+
+	if (!ipvs_queue_len++)
+		ipvs_queue_oldest = timer_now();
+
+	if (!ipvs_queue_thread)
+		ipvs_queue_thread = thread_add_timer(master, ipvs_queue_thread_func, NULL, IPVS_QUEUE_DELAY);
+}
+
+static void
+ipvs_queue_flush(void)
+{
+	ipvs_batch_cmd_t *qcmd;
+	bool batching = ipvs_batching;
+	unsigned long delay;
+	virtual_server_t *cmd_vs = ipvs_cmd_vs;
+	real_server_t *cmd_rs = ipvs_cmd_rs;
+
+	if (ipvs_queue_thread) {
+		thread_cancel(ipvs_queue_thread);
+		ipvs_queue_thread = NULL;
+	}
+
+	if (!ipvs_queue_len)
+		return;
+
+	delay = timer_long(timer_sub_now(ipvs_queue_oldest));
+	if (delay > ipvs_queue_stats.max_delay)
+		ipvs_queue_stats.max_delay = delay;
+	if (ipvs_queue_len > ipvs_queue_stats.max_len)
+		ipvs_queue_stats.max_len = ipvs_queue_len;
+	ipvs_queue_stats.flushes++;
+
+	if (!batching)
+		ipvs_cmd_batch_start();
+
+	ipvs_queue_flushing = true;
+	while (!list_empty(&ipvs_queue)) {
+		qcmd = list_first_entry(&ipvs_queue, ipvs_batch_cmd_t, e_list);
+		list_del_init(&qcmd->e_list);
+		ipvs_queue_len--;
+
+		ipvs_cmd_vs = qcmd->vs;
+		ipvs_cmd_rs = qcmd->rs;
+		if (ipvs_talk(qcmd->cmd, &qcmd->srule, &qcmd->drule, NULL, qcmd->ignore_error) && qcmd->rs)
+			ipvs_dest_cmd_failed(qcmd->cmd, &qcmd->drule, qcmd->vs, qcmd->rs);
+		FREE(qcmd);
+	}
+	ipvs_queue_flushing = false;
+	ipvs_cmd_vs = cmd_vs;
+	ipvs_cmd_rs = cmd_rs;
+
+	if (!batching)
+		ipvs_cmd_batch_end();
+}
+
 /* Send user rules to IPVS module */
 static int
 ipvs_talk(int cmd, ipvs_service_t *srule, ipvs_dest_t *drule, ipvs_daemon_t *daemonrule, bool ignore_error)
 {
+	ipvs_batch_cmd_t *bcmd = NULL;
 	int result = -1;
 
 	if (no_ipvs)
 		return result;
 
+	if (!ipvs_queue_flushing) {
+		if (ipvs_queueing &&
+		    (cmd == IP_VS_SO_SET_ADDDEST || cmd == IP_VS_SO_SET_DELDEST || cmd == IP_VS_SO_SET_EDITDEST)) {
+			ipvs_queue_cmd(cmd, srule, drule, ignore_error);
+			return 0;
+		}
+
+		/* Any queued commands must be sent first to preserve ordering */
+		if (ipvs_queue_len)
+			ipvs_queue_flush();
+	}
+
+	/* Keep a copy of the command for reporting its result. This must be
+	 * done before the command is issued, since issuing it can cause the
+	 * commands already queued to be sent and their results reported. */
+	if (ipvs_batching &&
+	    (cmd == IP_VS_SO_SET_ADD || cmd == IP_VS_SO_SET_DEL || cmd == IP_VS_SO_SET_EDIT ||
+	     cmd == IP_VS_SO_SET_ADDDEST || cmd == IP_VS_SO_SET_DELDEST || cmd == IP_VS_SO_SET_EDITDEST)) {
+		PMALLOC(bcmd);
+		bcmd->cmd = cmd;
+		bcmd->ignore_error = ignore_error;
+		bcmd->srule = *srule;
+		if (drule) {
+			bcmd->drule = *drule;
+			bcmd->vs = ipvs_cmd_vs;
+			bcmd->rs = ipvs_cmd_rs;
+		}
+		list_add_tail(&bcmd->e_list, &ipvs_batch_cmds);
+	}
+
 	switch (cmd) {
 		case IP_VS_SO_SET_STARTDAEMON:
 			result = ipvs_start_daemon(daemonrule);
@@ -213,32 +483,93 @@ ipvs_talk(int cmd, ipvs_service_t *srule, ipvs_dest_t *drule, ipvs_daemon_t *dae
 			log_message(LOG_INFO, "ipvs_talk() called with unknown command %d", cmd);
 	}
 
-	if (ignore_error)
-		result = 0;
-	else if (result) {
-		char buf[2 + INET6_ADDRSTRLEN + 6 + 5 + 4 + INET6_ADDRSTRLEN + 1 + 5 + 1 + 1];	/* " (" + IPv6 + ":sctp:" + port + " -> " + IPV6 + ":" + port + ")" */
+	if (bcmd) {
+		/* If the command has been queued, the result will be reported later */
+		if (!result)
+			return 0;
 
-		if (errno == EEXIST &&
-			(cmd == IP_VS_SO_SET_ADD || cmd == IP_VS_SO_SET_ADDDEST))
-			result = 0;
-		else if (errno == ENOENT &&
-			(cmd == IP_VS_SO_SET_DEL || cmd == IP_VS_SO_SET_DELDEST))
-			result = 0;
+		list_del_init(&bcmd->e_list);
+		FREE(bcmd);
+	}
 
-		buf[0] = ' ';
-		buf[1] = '(';
-		if (cmd == IP_VS_SO_SET_ADD || cmd == IP_VS_SO_SET_DEL || cmd == IP_VS_SO_SET_EDIT)
-			format_srule(buf + 2, srule);
-		else if (cmd == IP_VS_SO_SET_ADDDEST || cmd == IP_VS_SO_SET_DELDEST || cmd == IP_VS_SO_SET_EDITDEST)
-			format_drule(buf + 2 + format_srule(buf + 2, srule), drule);
-		else
-			buf[0] = '\0';
-		if (buf[0])
-			strcat(buf, ")");
+	return ipvs_talk_result(cmd, result, srule, drule, ignore_error);
+}
 
-		log_message(LOG_INFO, "IPVS cmd %s(%d) error: %s(%d)%s", ipvs_cmd_str(cmd), cmd, ipvs_strerror(errno), errno, buf);
-	}
-	return result;
+/* Called by libipvs with the result of each batched command */
+static void
+ipvs_batch_done(int result)
+{
+	ipvs_batch_cmd_t *bcmd;
+
+	if (list_empty(&ipvs_batch_cmds))
+		return;
+
+	bcmd = list_first_entry(&ipvs_batch_cmds, ipvs_batch_cmd_t, e_list);
+	list_del_init(&bcmd->e_list);
+
+	if (result && errno == ENOENT && bcmd->cmd == IP_VS_SO_SET_EDITDEST) {
+		/* The destination doesn't exist, so add it */
+		ipvs_cmd_vs = bcmd->vs;
+		ipvs_cmd_rs = bcmd->rs;
+		result = ipvs_talk(IP_VS_SO_SET_ADDDEST, &bcmd->srule, &bcmd->drule, NULL, bcmd->ignore_error);
+		ipvs_cmd_vs = NULL;
+		ipvs_cmd_rs = NULL;
+		if (result && bcmd->rs)
+			ipvs_dest_cmd_failed(IP_VS_SO_SET_ADDDEST, &bcmd->drule, bcmd->vs, bcmd->rs);
+	} else if (ipvs_talk_result(bcmd->cmd, result, &bcmd->srule, &bcmd->drule, bcmd->ignore_error) && bcmd->rs)
+		ipvs_dest_cmd_failed(bcmd->cmd, &bcmd->drule, bcmd->vs, bcmd->rs);
+
+	FREE(bcmd);
+}
+
+/* Queue service and destination commands until ipvs_cmd_batch_end() is called,
+ * so that they are sent to the kernel together. Errors are logged when the
+ * batch is sent, so commands issued in a batch always report success. */
+void
+ipvs_cmd_batch_start(void)
+{
+	if (no_ipvs || ipvs_batching)
+		return;
+
+	ipvs_batching = ipvs_batch_start(ipvs_batch_done);
+}
+
+void
+ipvs_cmd_batch_end(void)
+{
+	if (!ipvs_batching)
+		return;
+
+	ipvs_batch_end();
+	ipvs_batching = false;
+}
+
+/* Queue destination commands until ipvs_cmd_queue_end() is called, and
+ * then send them from the IPVS queue thread. Commands issued while
+ * queueing always report success; errors are logged when they are sent. */
+void
+ipvs_cmd_queue_start(void)
+{
+	ipvs_queueing = !no_ipvs;
+}
+
+void
+ipvs_cmd_queue_end(void)
+{
+	ipvs_queueing = false;
+
+	if (ipvs_queue_len >= IPVS_QUEUE_MAX)
+		ipvs_queue_flush();
+}
+
+void
+dump_ipvs_queue(FILE *fp)
+{
+	conf_write(fp, " IPVS update queue:");
+	conf_write(fp, "   Pending = %u", ipvs_queue_len);
+	conf_write(fp, "   Queued = %" PRIu64 ", coalesced = %" PRIu64, ipvs_queue_stats.queued, ipvs_queue_stats.coalesced);
+	conf_write(fp, "   Flushes = %" PRIu64 ", max length = %u", ipvs_queue_stats.flushes, ipvs_queue_stats.max_len);
+	conf_write(fp, "   Max delay = %lu usecs", ipvs_queue_stats.max_delay);
 }
 
 /* Note: This function may be called in the context of the vrrp child process */
@@ -545,8 +876,8 @@ ipvs_set_drule(int cmd, ipvs_dest_t *drule, real_server_t * rs)
 }
 
 /* Set/Remove a RS from a VS */
-int
-ipvs_cmd(int cmd, virtual_server_t *vs, real_server_t *rs)
+static int
+ipvs_vs_cmd(int cmd, virtual_server_t *vs, real_server_t *rs)
 {
 	ipvs_service_t srule;
 	ipvs_dest_t drule;
@@ -641,6 +972,21 @@ ipvs_cmd(int cmd, virtual_server_t *vs, real_server_t *rs)
 	return ret;
 }
 
+int
+ipvs_cmd(int cmd, virtual_server_t *vs, real_server_t *rs)
+{
+	int ret;
+
+	/* Remember the real server, in case a queued command fails */
+	ipvs_cmd_vs = vs;
+	ipvs_cmd_rs = rs;
+	ret = ipvs_vs_cmd(cmd, vs, rs);
+	ipvs_cmd_vs = NULL;
+	ipvs_cmd_rs = NULL;
+
+	return ret;
+}
+
 /* at reload, add alive destinations to the newly created vsge */
 void
 ipvs_group_sync_entry(virtual_server_t *vs, virtual_server_group_entry_t *vsge)
@@ -774,6 +1120,115 @@ add_fwmark_vs(virtual_server_t *vs, int family)
 #endif
 
 #ifdef _WITH_SNMP_CHECKER_
+/* The IPVS services, and their destinations, are read once per refresh
+ * period, and the statistics for all the virtual and real servers are
+ * then taken from this cache. Without this, a virtual server group with
+ * an address range would need a pair of IPVS queries for each address. */
+#define IPVS_STATS_HASH_BITS	8
+#define IPVS_STATS_HASH_SIZE	(1U << IPVS_STATS_HASH_BITS)
+
+typedef struct _ipvs_stats_svc {
+	ipvs_service_entry_t		*svc;
+	struct ip_vs_get_dests_app	*dests;		/* Read on first use */
+	bool				dests_read;
+
+	/* Linking pointer */
+	hlist_node_t			e_hash;
+} ipvs_stats_svc_t;
+
+static struct ip_vs_get_services_app *ipvs_stats_services;
+static ipvs_stats_svc_t *ipvs_stats_svcs;
+static hlist_head_t ipvs_stats_hash[IPVS_STATS_HASH_SIZE];
+static time_t ipvs_stats_lastupdated;
+
+static unsigned __attribute__ ((pure))
+ipvs_stats_hashkey(uint16_t af, uint16_t protocol, const union nf_inet_addr *nfaddr, uint16_t port, uint32_t fwmark)
+{
+	uint32_t key;
+
+	if (fwmark)
+		key = fwmark ^ af;
+	else {
+		key = (uint32_t)protocol << 16 ^ port ^ af;
+		if (af == AF_INET6)
+			key ^= nfaddr->in6.s6_addr32[0] ^ nfaddr->in6.s6_addr32[1] ^
+			       nfaddr->in6.s6_addr32[2] ^ nfaddr->in6.s6_addr32[3];
+		else
+			key ^= nfaddr->ip;
+	}
+
+	/* Multiplicative hash, using the golden ratio */
+	return (key * 0x61C88647U) >> (32 - IPVS_STATS_HASH_BITS);
+}
+
+static void
+ipvs_stats_free(void)
+{
+	unsigned i;
+
+	if (ipvs_stats_services) {
+		for (i = 0; i < ipvs_stats_services->user.num_services; i++) {
+			if (ipvs_stats_svcs[i].dests)
+				FREE(ipvs_stats_svcs[i].dests);
+		}
+		FREE_PTR(ipvs_stats_svcs);
+		FREE(ipvs_stats_services);
+		ipvs_stats_services = NULL;
+	}
+
+	for (i = 0; i < IPVS_STATS_HASH_SIZE; i++)
+		INIT_HLIST_HEAD(&ipvs_stats_hash[i]);
+
+	ipvs_stats_lastupdated = 0;
+}
+
+/* Read all the IPVS services and index them */
+static void
+ipvs_stats_refresh(time_t cur_time)
+{
+	ipvs_service_entry_t *svc;
+	unsigned i;
+
+	ipvs_stats_free();
+	ipvs_stats_lastupdated = cur_time;
+
+	if (!(ipvs_stats_services = ipvs_get_services()))
+		return;
+
+	if (!ipvs_stats_services->user.num_services)
+		return;
+
+	ipvs_stats_svcs = MALLOC(sizeof(*ipvs_stats_svcs) * ipvs_stats_services->user.num_services);
+	for (i = 0; i < ipvs_stats_services->user.num_services; i++) {
+		svc = &ipvs_stats_services->user.entrytable[i];
+		ipvs_stats_svcs[i].svc = svc;
+		hlist_add_head(&ipvs_stats_svcs[i].e_hash,
+			       &ipvs_stats_hash[ipvs_stats_hashkey(svc->af, svc->user.protocol, &svc->nf_addr, svc->user.port, svc->user.fwmark)]);
+	}
+}
+
+static ipvs_stats_svc_t * __attribute__ ((pure))
+ipvs_stats_lookup(uint16_t af, uint16_t protocol, union nf_inet_addr *nfaddr, uint16_t port, uint32_t fwmark)
+{
+	ipvs_stats_svc_t *entry;
+	hlist_node_t *pos;
+	ipvs_service_entry_t *svc;
+
+	hlist_for_each_entry(entry, pos, &ipvs_stats_hash[ipvs_stats_hashkey(af, protocol, nfaddr, port, fwmark)], e_hash) {
+		svc = entry->svc;
+		if (svc->af != af || svc->user.fwmark != fwmark)
+			continue;
+		if (fwmark)
+			return entry;
+		if (svc->user.protocol == protocol &&
+		    svc->user.port == port &&
+		    inaddr_equal(af, &svc->nf_addr, nfaddr))
+			return entry;
+	}
+
+	return NULL;
+}
+
 static inline bool
 vsd_equal(real_server_t *rs, struct ip_vs_dest_entry_app *entry)
 {
@@ -801,13 +1256,15 @@ vsd_equal(real_server_t *rs, struct ip_vs_dest_entry_app *entry)
 static void
 ipvs_update_vs_stats(virtual_server_t *vs, uint16_t af, uint32_t fwmark, union nf_inet_addr *nfaddr, uint16_t port)
 {
-	struct ip_vs_get_dests_app *dests = NULL;
+	struct ip_vs_get_dests_app *dests;
 	real_server_t *rs, *rs_match;
 	unsigned int i;
+	ipvs_stats_svc_t *entry;
 	ipvs_service_entry_t *serv;
 
-	if (!(serv = ipvs_get_service(fwmark, af, vs->service_type, nfaddr, port)))
+	if (!(entry = ipvs_stats_lookup(af, vs->service_type, nfaddr, port, fwmark)))
 		return;
+	serv = entry->svc;
 
 	/* Update virtual server stats */
 	vs->stats.conns		+= serv->stats.conns;
@@ -822,9 +1279,11 @@ ipvs_update_vs_stats(virtual_server_t *vs, uint16_t af, uint32_t fwmark, union n
 	vs->stats.outbps	+= serv->stats.outbps;
 
 	/* Get real servers */
-	dests = ipvs_get_dests(serv);
-	FREE(serv);
-	if (!dests)
+	if (!entry->dests_read) {
+		entry->dests = ipvs_get_dests(serv);
+		entry->dests_read = true;
+	}
+	if (!(dests = entry->dests))
 		return;
 
 	for (i = 0; i < dests->user.num_dests; i++) {
@@ -862,7 +1321,6 @@ ipvs_update_vs_stats(virtual_server_t *vs, uint16_t af, uint32_t fwmark, union n
 			rs->stats.outbps	+= dests->user.entrytable[i].stats.outbps;
 		}
 	}
-	FREE(dests);
 }
 
 /* Update statistics for a given virtual server. This includes
@@ -884,7 +1342,10 @@ ipvs_update_stats(virtual_server_t *vs)
 
 	if (cur_time - vs->lastupdated < STATS_REFRESH)
 		return;
-	vs->lastupdated = cur_time;
+
+	if (cur_time - ipvs_stats_lastupdated >= STATS_REFRESH)
+		ipvs_stats_refresh(cur_time);
+	vs->lastupdated = ipvs_stats_lastupdated;
 
 	/* Reset stats */
 	memset(&vs->stats, 0, sizeof(vs->stats));
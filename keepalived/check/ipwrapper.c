@@ -40,6 +40,9 @@
 #ifdef _WITH_NFTABLES_
 #include "check_nftables.h"
 #endif
+#ifdef _WITH_JSON_
+#include "check_json.h"
+#endif
 
 static bool __attribute((pure))
 vs_iseq(const virtual_server_t *vs_a, const virtual_server_t *vs_b)
@@ -105,6 +108,10 @@ notify_fifo_vs(virtual_server_t *vs)
 	char *line;
 	const char *vs_str;
 
+#ifdef _WITH_JSON_
+	check_json_notify_vs(vs);
+#endif
+
 	if (global_data->notify_fifo.fd == -1 &&
 	    global_data->lvs_notify_fifo.fd == -1)
 		return;
@@ -135,6 +142,10 @@ notify_fifo_rs(virtual_server_t* vs, real_server_t* rs)
 	const char *rs_str;
 	const char *vs_str;
 
+#ifdef _WITH_JSON_
+	check_json_notify_rs(vs, rs);
+#endif
+
 	if (global_data->notify_fifo.fd == -1 &&
 	    global_data->lvs_notify_fifo.fd == -1)
 		return;
@@ -382,12 +393,16 @@ clear_services(void)
 		list_for_each_entry(vs, &check_data->vs, e_list)
 			update_vs_notifies(vs, true);
 	} else {
+		ipvs_cmd_batch_start();
+
 		list_for_each_entry(vs, &check_data->vs, e_list) {
 			/* Remove the real servers, and clear the vs unless it is
 			 * using a VS group and it is not the last vs of the same
 			 * protocol or address family using the group. */
 			clear_service_vs(vs, true);
 		}
+
+		ipvs_cmd_batch_end();
 	}
 
 #ifdef _WITH_NFTABLES_
@@ -608,10 +623,14 @@ perform_svr_state(bool alive, checker_t *checker)
 			    , (rs->inhibit) ? "of" : alive ? "to" : "from"
 			    , FMT_VS(vs));
 
+	ipvs_cmd_queue_start();
+
 	/* Change only if we have quorum or no sorry server */
 	if (vs->quorum_state_up || !vs->s_svr || !ISALIVE(vs->s_svr)) {
-		if (ipvs_cmd(alive ? LVS_CMD_ADD_DEST : LVS_CMD_DEL_DEST, vs, rs))
+		if (ipvs_cmd(alive ? LVS_CMD_ADD_DEST : LVS_CMD_DEL_DEST, vs, rs)) {
+			ipvs_cmd_queue_end();
 			return false;
+		}
 	}
 	rs->alive = alive;
 	do_rs_notifies(vs, rs, false);
@@ -620,6 +639,8 @@ perform_svr_state(bool alive, checker_t *checker)
 	 * but is now up, this is where the rs is added. */
 	update_quorum_state(vs, false);
 
+	ipvs_cmd_queue_end();
+
 	return true;
 }
 
@@ -685,13 +706,20 @@ bool
 init_services(void)
 {
 	virtual_server_t *vs;
+	bool ret = true;
+
+	ipvs_cmd_batch_start();
 
 	list_for_each_entry(vs, &check_data->vs, e_list) {
-		if (!init_service_vs(vs))
-			return false;
+		if (!init_service_vs(vs)) {
+			ret = false;
+			break;
+		}
 	}
 
-	return true;
+	ipvs_cmd_batch_end();
+
+	return ret;
 }
 
 /* Store new weight in real_server struct and then update kernel. */
@@ -720,11 +748,13 @@ update_svr_wgt(int64_t weight, virtual_server_t * vs, real_server_t * rs
 		 * there is no sorry server). If not, it will take
 		 * effect later when it becomes alive.
 		 */
+		ipvs_cmd_queue_start();
 		if (rs->set && ISALIVE(rs) &&
 		    (vs->quorum_state_up || !vs->s_svr || !ISALIVE(vs->s_svr)))
 			ipvs_cmd(LVS_CMD_EDIT_DEST, vs, rs);
 		if (update_quorum)
 			update_quorum_state(vs, false);
+		ipvs_cmd_queue_end();
 	}
 }
 
@@ -751,6 +781,11 @@ update_svr_checker_state(bool alive, checker_t *checker)
 			if (checker->alpha || !alive)
 				do_rs_notifies(checker->vs, checker->rs, false);
 			checker->has_run = true;
+		} else if (checker->rs->ipvs_retry) {
+			/* A queued IPVS command failed, so try again */
+			checker->rs->ipvs_retry = false;
+			if (!perform_svr_state(!checker->rs->num_failed_checkers, checker))
+				checker->rs->ipvs_retry = true;
 		}
 		return;
 	}
@@ -1135,6 +1170,8 @@ clear_diff_services(list_head_t *old_checkers_queue)
 {
 	virtual_server_t *vs, *new_vs;
 
+	ipvs_cmd_batch_start();
+
 	/* Remove diff entries from previous IPVS rules */
 	list_for_each_entry(vs, &old_check_data->vs, e_list) {
 		/*
@@ -1179,6 +1216,8 @@ clear_diff_services(list_head_t *old_checkers_queue)
 			update_alive_counts(vs, new_vs);
 		}
 	}
+
+	ipvs_cmd_batch_end();
 }
 
 /* This is only called during a reload. Any new real server with
@@ -1202,8 +1241,6 @@ void
 link_vsg_to_vs(void)
 {
 	virtual_server_t *vs, *vs_tmp;
-	virtual_server_group_t *vsg;
-	unsigned vsg_member_no;
 	int vsg_af;
 
 	if (list_empty(&check_data->vs))
@@ -1213,7 +1250,7 @@ link_vsg_to_vs(void)
 		if (!vs->vsgname)
 			continue;
 
-		vs->vsg = ipvs_get_group_by_name(vs->vsgname, &check_data->vs_group);
+		vs->vsg = ipvs_get_group_by_name(vs->vsgname, check_data);
 		if (!vs->vsg) {
 			log_message(LOG_INFO, "Virtual server group %s specified but not configured"
 					      " - ignoring virtual server %s"
@@ -1260,18 +1297,11 @@ link_vsg_to_vs(void)
 	}
 
 	/* The virtual server port number is used to identify the sequence number of the virtual server in the group */
-	list_for_each_entry(vsg, &check_data->vs_group, e_list) {
-		vsg_member_no = 0;
-
-		list_for_each_entry(vs, &check_data->vs, e_list) {
-			if (!vs->vsgname)
-				continue;
+	list_for_each_entry(vs, &check_data->vs, e_list) {
+		if (!vs->vsg)
+			continue;
 
-			if (!strcmp(vs->vsgname, vsg->gname)) {
-				/* We use the IPv4 port since there is no address family */
-				PTR_CAST(struct sockaddr_in, &vs->addr)->sin_port = htons(vsg_member_no);
-				vsg_member_no++;
-			}
-		}
+		/* We use the IPv4 port since there is no address family */
+		PTR_CAST(struct sockaddr_in, &vs->addr)->sin_port = htons(vs->vsg->num_vs++);
 	}
 }
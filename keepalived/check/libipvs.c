@@ -69,6 +69,26 @@ static int family;
 static bool try_nl = true;
 static int nl_ack_flag;
 
+#ifdef _HAVE_LIBNL3_
+/* Commands queued for sending together. Each batch sent to the kernel
+ * is limited so that the ACKs will fit in the socket receive buffer. */
+#define IPVS_NL_BATCH_MAX	64
+
+typedef struct ipvs_nl_batch_cmd {
+	void			*func;		/* The function that queued the command */
+	int			err;
+} ipvs_nl_batch_cmd_t;
+
+static ipvs_batch_done_t nl_batch_done;
+static char *nl_batch_buf;
+static size_t nl_batch_buf_size;
+static size_t nl_batch_len;
+static unsigned nl_batch_num;
+static unsigned nl_batch_replies;
+static uint32_t nl_batch_first_seq;
+static ipvs_nl_batch_cmd_t nl_batch_cmds[IPVS_NL_BATCH_MAX];
+#endif
+
 /* Policy definitions */
 static struct nla_policy ipvs_cmd_policy[IPVS_CMD_ATTR_MAX + 1] = {
 	[IPVS_CMD_ATTR_SERVICE]		= { .type = NLA_NESTED },
@@ -337,11 +357,21 @@ open_nl_sock(void)
 	return 0;
 }
 
+#ifdef _HAVE_LIBNL3_
+static void ipvs_nl_batch_send(void);
+#endif
+
 static int ipvs_nl_send_message(struct nl_msg *msg, nl_recvmsg_msg_cb_t func, void *arg)
 {
 	int err = EINVAL;
 	int ret = 0;
 
+#ifdef _HAVE_LIBNL3_
+	/* Any queued commands must be sent first */
+	if (nl_batch_num)
+		ipvs_nl_batch_send();
+#endif
+
 	if (!sock && open_nl_sock()) {
 		nlmsg_free(msg);
 		return -1;
@@ -384,7 +414,167 @@ static int ipvs_nl_send_message(struct nl_msg *msg, nl_recvmsg_msg_cb_t func, vo
 
 	return ret;
 }
+
+#ifdef _HAVE_LIBNL3_
+static int
+ipvs_nl_batch_err_cb(__attribute__((unused)) struct sockaddr_nl *nla, struct nlmsgerr *nlerr, __attribute__((unused)) void *arg)
+{
+	uint32_t i = nlerr->msg.nlmsg_seq - nl_batch_first_seq;
+
+	if (i < IPVS_NL_BATCH_MAX)
+		nl_batch_cmds[i].err = -nlerr->error;
+	nl_batch_replies++;
+
+	return NL_SKIP;
+}
+
+static int
+ipvs_nl_batch_ack_cb(__attribute__((unused)) struct nl_msg *msg, __attribute__((unused)) void *arg)
+{
+	nl_batch_replies++;
+
+	return NL_SKIP;
+}
+
+/* Send all the queued commands in one message, then collect the ACKs and
+ * report the result of each command */
+static void
+ipvs_nl_batch_send(void)
+{
+	ipvs_nl_batch_cmd_t cmds[IPVS_NL_BATCH_MAX];
+	unsigned num = nl_batch_num;
+	unsigned i;
+	int err = 0;
+
+	nl_batch_replies = 0;
+	for (i = 0; i < num; i++)
+		nl_batch_cmds[i].err = 0;
+
+	nl_socket_modify_err_cb(sock, NL_CB_CUSTOM, ipvs_nl_batch_err_cb, NULL);
+	nl_socket_modify_cb(sock, NL_CB_ACK, NL_CB_CUSTOM, ipvs_nl_batch_ack_cb, NULL);
+
+#ifdef LIBNL_DEBUG
+	dump_nl_msg("Sending batch", NULL);
+#endif
+
+	if ((err = -nl_sendto(sock, nl_batch_buf, nl_batch_len)) <= 0) {
+		err = 0;
+		while (nl_batch_replies < num) {
+			if ((err = -nl_recvmsgs_default(sock)) > 0)
+				break;
+			err = 0;
+		}
+	}
+
+	if (err > 0) {
+		/* Commands without a reply have failed. The socket's sequence numbers
+		 * are now out of step, so a new socket will be opened when needed. */
+		err = nlerr2syserr(err);
+		for (i = nl_batch_replies; i < num; i++)
+			nl_batch_cmds[i].err = err;
+
+		nl_socket_free(sock);
+		sock = NULL;
+	} else {
+		nl_socket_modify_err_cb(sock, NL_CB_CUSTOM, ipvs_nl_err_cb, &nl_ack_flag);
+		nl_socket_modify_cb(sock, NL_CB_ACK, NL_CB_CUSTOM, recv_ack_cb, &nl_ack_flag);
+	}
+
+	/* The completion function may queue further commands */
+	memcpy(cmds, nl_batch_cmds, num * sizeof(*cmds));
+	nl_batch_num = 0;
+	nl_batch_len = 0;
+
+	for (i = 0; i < num; i++) {
+		ipvs_func = cmds[i].func;
+		errno = cmds[i].err;
+		nl_batch_done(cmds[i].err ? -1 : 0);
+	}
+}
+
+static int
+ipvs_nl_queue_message(struct nl_msg *msg)
+{
+	struct nlmsghdr *nlh;
+	size_t len;
+
+	if (nl_batch_num == IPVS_NL_BATCH_MAX)
+		ipvs_nl_batch_send();
+
+	if (!sock && open_nl_sock()) {
+		nlmsg_free(msg);
+		return -1;
+	}
+
+	/* Set the sequence number, and request an ACK */
+	nl_complete_msg(sock, msg);
+	nlh = nlmsg_hdr(msg);
+	len = NLMSG_ALIGN(nlh->nlmsg_len);
+
+	if (nl_batch_len + len > nl_batch_buf_size) {
+		nl_batch_buf_size = nl_batch_buf_size ? nl_batch_buf_size * 2 : 4096;
+		if (nl_batch_buf_size < nl_batch_len + len)
+			nl_batch_buf_size = nl_batch_len + len;
+		nl_batch_buf = nl_batch_buf ? REALLOC(nl_batch_buf, nl_batch_buf_size) : MALLOC(nl_batch_buf_size);
+	}
+
+	if (!nl_batch_num)
+		nl_batch_first_seq = nlh->nlmsg_seq;
+
+	memcpy(nl_batch_buf + nl_batch_len, nlh, nlh->nlmsg_len);
+	memset(nl_batch_buf + nl_batch_len + nlh->nlmsg_len, 0, len - nlh->nlmsg_len);
+	nl_batch_len += len;
+
+	nl_batch_cmds[nl_batch_num++].func = ipvs_func;
+
+	nlmsg_free(msg);
+
+	return 0;
+}
+#endif
+
+/* Send a command that only returns an ACK, unless batching commands */
+static int
+ipvs_nl_send_cmd(struct nl_msg *msg)
+{
+#ifdef _HAVE_LIBNL3_
+	if (nl_batch_done)
+		return ipvs_nl_queue_message(msg);
+#endif
+
+	return ipvs_nl_send_message(msg, ipvs_nl_noop_cb, NULL);
+}
+#endif
+
+/* Commands issued between ipvs_batch_start() and ipvs_batch_end() are
+ * queued and sent to the kernel together. done() is called with the
+ * result of each command, in the order the commands were issued, and
+ * with errno set. Returns false if commands cannot be batched. */
+bool
+ipvs_batch_start(__attribute__((unused)) ipvs_batch_done_t done)
+{
+#if defined LIBIPVS_USE_NL && defined _HAVE_LIBNL3_
+	if (!try_nl)
+		return false;
+
+	nl_batch_done = done;
+
+	return true;
+#else
+	return false;
 #endif
+}
+
+void
+ipvs_batch_end(void)
+{
+#if defined LIBIPVS_USE_NL && defined _HAVE_LIBNL3_
+	while (nl_batch_num)
+		ipvs_nl_batch_send();
+
+	nl_batch_done = NULL;
+#endif
+}
 
 #ifdef LIBIPVS_USE_NL
 static int ipvs_getinfo_parse_cb(struct nl_msg *msg, __attribute__((unused)) void *arg)
@@ -522,7 +712,7 @@ int ipvs_add_service(ipvs_service_t *svc)
 			nlmsg_free(msg);
 			return -1;
 		}
-		return ipvs_nl_send_message(msg, ipvs_nl_noop_cb, NULL);
+		return ipvs_nl_send_cmd(msg);
 	}
 #endif
 
@@ -545,7 +735,7 @@ int ipvs_update_service(ipvs_service_t *svc)
 			nlmsg_free(msg);
 			return -1;
 		}
-		return ipvs_nl_send_message(msg, ipvs_nl_noop_cb, NULL);
+		return ipvs_nl_send_cmd(msg);
 	}
 #endif
 	CHECK_COMPAT_SVC(svc, -1);
@@ -567,7 +757,7 @@ int ipvs_del_service(ipvs_service_t *svc)
 			nlmsg_free(msg);
 			return -1;
 		}
-		return ipvs_nl_send_message(msg, ipvs_nl_noop_cb, NULL);
+		return ipvs_nl_send_cmd(msg);
 	}
 #endif
 	CHECK_COMPAT_SVC(svc, -1);
@@ -657,7 +847,7 @@ int ipvs_add_dest(ipvs_service_t *svc, ipvs_dest_t *dest)
 			goto nla_put_failure;
 		if (ipvs_nl_fill_dest_attr(msg, dest))
 			goto nla_put_failure;
-		return ipvs_nl_send_message(msg, ipvs_nl_noop_cb, NULL);
+		return ipvs_nl_send_cmd(msg);
 
 nla_put_failure:
 		nlmsg_free(msg);
@@ -689,7 +879,7 @@ int ipvs_update_dest(ipvs_service_t *svc, ipvs_dest_t *dest)
 			goto nla_put_failure;
 		if (ipvs_nl_fill_dest_attr(msg, dest))
 			goto nla_put_failure;
-		return ipvs_nl_send_message(msg, ipvs_nl_noop_cb, NULL);
+		return ipvs_nl_send_cmd(msg);
 
 nla_put_failure:
 		nlmsg_free(msg);
@@ -720,7 +910,7 @@ int ipvs_del_dest(ipvs_service_t *svc, ipvs_dest_t *dest)
 			goto nla_put_failure;
 		if (ipvs_nl_fill_dest_attr(msg, dest))
 			goto nla_put_failure;
-		return ipvs_nl_send_message(msg, ipvs_nl_noop_cb, NULL);
+		return ipvs_nl_send_cmd(msg);
 
 nla_put_failure:
 		nlmsg_free(msg);
@@ -1299,11 +1489,76 @@ out_err:
 	FREE(svc);
 	return NULL;
 }
+
+struct ip_vs_get_services_app *
+ipvs_get_services(void)
+{
+	struct ip_vs_get_services_app *get;
+	struct ip_vs_get_services *getk;
+	struct ip_vs_getinfo ipvs_info;
+	socklen_t len;
+	unsigned i;
+
+	ipvs_func = ipvs_get_services;
+
+#ifdef LIBIPVS_USE_NL
+	if (try_nl) {
+		struct nl_msg *msg;
+
+		if (!(get = MALLOC(sizeof(*get) + sizeof(ipvs_service_entry_t))))
+			return NULL;
+
+		get->user.num_services = 0;
+
+		msg = ipvs_nl_message(IPVS_CMD_GET_SERVICE, NLM_F_DUMP);
+		if (msg && !ipvs_nl_send_message(msg, ipvs_services_parse_cb, &get))
+			return get;
+
+		FREE(get);
+		return NULL;
+	}
+#endif
+
+	len = sizeof(ipvs_info);
+	if (getsockopt(sockfd, IPPROTO_IP, IP_VS_SO_GET_INFO, (char *)&ipvs_info, &len))
+		return NULL;
+
+	len = (socklen_t)(sizeof(*getk) + sizeof(struct ip_vs_service_entry) * ipvs_info.num_services);
+	if (!(getk = MALLOC(len)))
+		return NULL;
+
+	getk->num_services = ipvs_info.num_services;
+	if (getsockopt(sockfd, IPPROTO_IP, IP_VS_SO_GET_SERVICES, getk, &len) < 0) {
+		FREE(getk);
+		return NULL;
+	}
+
+	if (!(get = MALLOC(sizeof(*get) + sizeof(ipvs_service_entry_t) * getk->num_services))) {
+		FREE(getk);
+		return NULL;
+	}
+
+	get->user.num_services = getk->num_services;
+	for (i = 0; i < getk->num_services; i++) {
+		memcpy(&get->user.entrytable[i].user, &getk->entrytable[i],
+		       sizeof(struct ip_vs_service_entry));
+		get->user.entrytable[i].af = AF_INET;
+		get->user.entrytable[i].nf_addr.ip = get->user.entrytable[i].user.addr;
+	}
+	FREE(getk);
+
+	return get;
+}
 #endif	/* _WITH_SNMP_CHECKER_ */
 
 void ipvs_close(void)
 {
 #ifdef LIBIPVS_USE_NL
+#ifdef _HAVE_LIBNL3_
+	FREE_PTR(nl_batch_buf);
+	nl_batch_buf_size = 0;
+#endif
+
 	if (try_nl) {
 		if (sock) {
 			nl_socket_free(sock);
@@ -408,6 +408,12 @@ free_global_data(data_t * data)
 #ifdef _WITH_DBUS_
 	FREE_CONST_PTR(data->dbus_service_name);
 #endif
+#ifdef _WITH_JSON_
+	FREE_CONST_PTR(data->json_socket);
+#ifdef _WITH_LVS_
+	FREE_CONST_PTR(data->lvs_json_socket);
+#endif
+#endif
 #ifndef _ONE_PROCESS_DEBUG_
 	FREE_CONST_PTR(data->reload_check_config);
 	FREE_CONST_PTR(data->reload_file);
@@ -738,6 +744,7 @@ dump_global_data(FILE *fp, data_t * data)
 #ifdef _WITH_BFD_
 	conf_write(fp, " BFD process priority = %d", data->bfd_process_priority);
 	conf_write(fp, " BFD don't swap = %s", data->bfd_no_swap ? "true" : "false");
+	conf_write(fp, " BFD shared socket = %s", data->bfd_shared_socket ? "true" : "false");
 	conf_write(fp, " BFD realtime priority = %u", data->bfd_realtime_priority);
 	if (CPU_COUNT(&data->bfd_cpu_mask)) {
 		get_process_cpu_affinity_string(&data->bfd_cpu_mask, cpu_str, 63);
@@ -764,6 +771,14 @@ dump_global_data(FILE *fp, data_t * data)
 #ifdef _WITH_DBUS_
 	conf_write(fp, " DBus %s", data->enable_dbus ? "enabled" : "disabled");
 	conf_write(fp, " DBus service name = %s", data->dbus_service_name ? data->dbus_service_name : "");
+#endif
+#ifdef _WITH_JSON_
+	if (data->json_socket)
+		conf_write(fp, " JSON socket = %s", data->json_socket);
+#ifdef _WITH_LVS_
+	if (data->lvs_json_socket)
+		conf_write(fp, " LVS JSON socket = %s", data->lvs_json_socket);
+#endif
 #endif
 	conf_write(fp, " Script security %s", script_security ? "enabled" : "disabled");
 	if (!get_default_script_user(&uid, &gid))
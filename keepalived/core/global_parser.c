@@ -35,6 +35,7 @@
 #include <strings.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/un.h>
 #include <errno.h>
 
 #ifdef _WITH_SNMP_
@@ -1479,6 +1480,12 @@ bfd_no_swap_handler(__attribute__((unused)) const vector_t *strvec)
 	global_data->bfd_no_swap = true;
 }
 
+static void
+bfd_shared_socket_handler(__attribute__((unused)) const vector_t *strvec)
+{
+	global_data->bfd_shared_socket = true;
+}
+
 static void
 bfd_rt_priority_handler(const vector_t *strvec)
 {
@@ -1638,6 +1645,41 @@ dbus_service_name_handler(const vector_t *strvec)
 }
 #endif
 
+#ifdef _WITH_JSON_
+static void
+json_socket(const vector_t *strvec, const char **path)
+{
+	if (vector_size(strvec) != 2) {
+		report_config_error(CONFIG_GENERAL_ERROR, "%s requires a path - ignoring", strvec_slot(strvec, 0));
+		return;
+	}
+
+	if (*path) {
+		report_config_error(CONFIG_GENERAL_ERROR, "%s already set to %s - ignoring", strvec_slot(strvec, 0), *path);
+		return;
+	}
+
+	if (strlen(strvec_slot(strvec, 1)) >= sizeof(((struct sockaddr_un *)NULL)->sun_path)) {
+		report_config_error(CONFIG_GENERAL_ERROR, "%s path %s too long - ignoring", strvec_slot(strvec, 0), strvec_slot(strvec, 1));
+		return;
+	}
+
+	*path = STRDUP(strvec_slot(strvec, 1));
+}
+static void
+json_socket_handler(const vector_t *strvec)
+{
+	json_socket(strvec, &global_data->json_socket);
+}
+#ifdef _WITH_LVS_
+static void
+lvs_json_socket_handler(const vector_t *strvec)
+{
+	json_socket(strvec, &global_data->lvs_json_socket);
+}
+#endif
+#endif
+
 static void
 instance_handler(const vector_t *strvec)
 {
@@ -2396,6 +2438,7 @@ init_global_keywords(bool global_active)
 #ifdef _WITH_BFD_
 	install_keyword("bfd_priority", &bfd_prio_handler);
 	install_keyword("bfd_no_swap", &bfd_no_swap_handler);
+	install_keyword("bfd_shared_socket", &bfd_shared_socket_handler);
 	install_keyword("bfd_rt_priority", &bfd_rt_priority_handler);
 	install_keyword("bfd_cpu_affinity", &bfd_cpu_affinity_handler);
 	install_keyword("bfd_rlimit_rttime", &bfd_rt_rlimit_handler);
@@ -2424,6 +2467,12 @@ init_global_keywords(bool global_active)
 #ifdef _WITH_DBUS_
 	install_keyword("enable_dbus", &enable_dbus_handler);
 	install_keyword("dbus_service_name", &dbus_service_name_handler);
+#endif
+#ifdef _WITH_JSON_
+	install_keyword("json_socket", &json_socket_handler);
+#ifdef _WITH_LVS_
+	install_keyword("lvs_json_socket", &lvs_json_socket_handler);
+#endif
 #endif
 	install_keyword("script_user", &script_user_handler);
 	install_keyword("enable_script_security", &script_security_handler);
@@ -99,6 +99,9 @@ int netlink_error_ignore;	/* If we get this error, ignore it */
 
 /* Static vars */
 static nl_handle_t nl_kernel = { .fd = -1 };	/* Kernel reflection channel */
+#ifdef _WITH_VRRP_
+static char batch_rcv_buf[NL_BATCH_MAX_LEN] __attribute__((aligned(__alignof__(struct nlmsghdr))));
+#endif
 
 #ifdef _NETLINK_TIMERS_
 /* The maximum netlink command we use is RTM_DELRULE.
@@ -1488,6 +1491,156 @@ netlink_talk(nl_handle_t *nl, struct nlmsghdr *n)
 
 	return status;
 }
+
+/* Queue a request in a batch. The value of netlink_error_ignore is
+ * saved with the request, and applied when its reply is processed. */
+void
+netlink_batch_add(nl_batch_t *batch, struct nlmsghdr *n, void *obj)
+{
+	size_t len = NLMSG_ALIGN(n->nlmsg_len);
+	nl_batch_entry_t *entry;
+	int rcvbuf;
+	socklen_t optlen = sizeof(rcvbuf);
+
+	/* The replies must all fit in the socket receive buffer */
+	if (!batch->max_unsent) {
+		if (getsockopt(nl_cmd.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &optlen) || rcvbuf < NL_BATCH_REPLY_SIZE)
+			batch->max_unsent = 1;
+		else
+			batch->max_unsent = (unsigned)rcvbuf / NL_BATCH_REPLY_SIZE;
+	}
+
+	if (batch->len + len > NL_BATCH_MAX_LEN ||
+	    batch->num - batch->unsent >= batch->max_unsent)
+		netlink_batch_send(batch);
+
+	if (batch->len + len > batch->buf_size) {
+		batch->buf_size = batch->len + len < NL_BATCH_MAX_LEN ? NL_BATCH_MAX_LEN : batch->len + len;
+		if (!batch->buf)
+			batch->buf = MALLOC(batch->buf_size);
+		else
+			batch->buf = REALLOC(batch->buf, batch->buf_size);
+	}
+
+	if (batch->num == batch->max_entries) {
+		batch->max_entries = batch->max_entries ? batch->max_entries * 2 : 32;
+		if (!batch->entries)
+			batch->entries = MALLOC(batch->max_entries * sizeof(*batch->entries));
+		else
+			batch->entries = REALLOC(batch->entries, batch->max_entries * sizeof(*batch->entries));
+	}
+
+	n->nlmsg_seq = ++nl_cmd.seq;
+	n->nlmsg_flags |= NLM_F_ACK;
+	memcpy(batch->buf + batch->len, n, n->nlmsg_len);
+	batch->len += len;
+	if (batch->unsent == batch->num)
+		batch->first_seq = n->nlmsg_seq;
+
+	entry = &batch->entries[batch->num++];
+	entry->obj = obj;
+	entry->error_ignore = netlink_error_ignore;
+	entry->status = -1;
+}
+
+static int
+netlink_batch_reply(nl_batch_t *batch, struct nlmsghdr *h)
+{
+	struct nlmsgerr *err = PTR_CAST(struct nlmsgerr, NLMSG_DATA(h));
+	nl_batch_entry_t *entry;
+
+	if (h->nlmsg_type != NLMSG_ERROR ||
+	    h->nlmsg_seq - batch->first_seq >= batch->num - batch->unsent)
+		return 0;
+
+	entry = &batch->entries[batch->unsent + h->nlmsg_seq - batch->first_seq];
+
+	if (h->nlmsg_len < NLMSG_LENGTH(sizeof (struct nlmsgerr))) {
+		log_message(LOG_INFO, "Netlink: error: message truncated");
+		entry->status = -1;
+	} else if (!err->error ||
+		   (err->error == -EEXIST &&
+		    (err->msg.nlmsg_type == RTM_NEWROUTE || err->msg.nlmsg_type == RTM_NEWADDR)) ||
+		   (err->error == -EADDRNOTAVAIL && err->msg.nlmsg_type == RTM_DELADDR))
+		entry->status = 0;
+	else {
+		if (entry->error_ignore != -err->error)
+			log_message(LOG_INFO,
+			       "Netlink: error: %s(%d), type=%s(%u), seq=%u, pid=%u",
+			       strerror(-err->error), -err->error,
+			       get_nl_msg_type(err->msg.nlmsg_type), err->msg.nlmsg_type,
+			       err->msg.nlmsg_seq, err->msg.nlmsg_pid);
+		entry->status = -1;
+	}
+
+	return 1;
+}
+
+/* Send the queued requests in a single sendmsg(), and read the replies */
+void
+netlink_batch_send(nl_batch_t *batch)
+{
+	struct sockaddr_nl snl = { .nl_family = AF_NETLINK };
+	struct iovec iov = {
+		.iov_base = batch->buf,
+		.iov_len = batch->len
+	};
+	struct msghdr msg = {
+		.msg_name = &snl,
+		.msg_namelen = sizeof(snl),
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+	};
+	unsigned replies = 0;
+	struct nlmsghdr *h;
+	ssize_t len;
+
+	if (batch->unsent == batch->num)
+		return;
+
+	if (sendmsg(nl_cmd.fd, &msg, 0) < 0) {
+		log_message(LOG_INFO, "Netlink: sendmsg(%d) batch of %u error: %s", nl_cmd.fd,
+			    batch->num - batch->unsent, strerror(errno));
+		goto done;
+	}
+
+	iov.iov_base = batch_rcv_buf;
+	iov.iov_len = sizeof(batch_rcv_buf);
+
+	while (replies < batch->num - batch->unsent) {
+		msg.msg_namelen = sizeof(snl);
+		msg.msg_flags = 0;
+		len = recvmsg(nl_cmd.fd, &msg, 0);
+		if (len < 0) {
+			if (check_EINTR(errno))
+				continue;
+			log_message(LOG_INFO, "Netlink: recvmsg error on cmd socket  - %d (%m)", errno);
+			break;
+		}
+		if (len == 0) {
+			log_message(LOG_INFO, "Netlink: EOF");
+			break;
+		}
+		if (msg.msg_flags & MSG_TRUNC)
+			log_message(LOG_INFO, "Netlink: batch reply truncated");
+
+		/* See -Wcast-align comment above, also applies to NLMSG_NEXT */
+		for (h = PTR_CAST(struct nlmsghdr, batch_rcv_buf); NLMSG_OK(h, (size_t)len); h = NLMSG_NEXT(h, len))
+			replies += netlink_batch_reply(batch, h);
+	}
+
+done:
+	batch->unsent = batch->num;
+	batch->len = 0;
+}
+
+void
+netlink_batch_free(nl_batch_t *batch)
+{
+	FREE_PTR(batch->buf);
+	FREE_PTR(batch->entries);
+	memset(batch, 0, sizeof(*batch));
+}
 #endif
 
 /* Fetch a specific type of information from netlink kernel */
@@ -1708,6 +1861,7 @@ netlink_if_get_ll_addr(interface_t *ifp, struct rtattr *tb[],
 				ifp->hw_addr_len = 0;
 			else
 				ifp->hw_addr_len = hw_addr_len;
+			if_update_hash(ifp);
 			break;
 
 		case IFLA_BROADCAST:
@@ -1784,6 +1938,7 @@ netlink_if_link_populate(interface_t *ifp, struct rtattr *tb[], struct ifinfomsg
 	/* Fill the interface structure */
 	strcpy_safe(ifp->ifname, name);
 	ifp->ifindex = (ifindex_t)ifi->ifi_index;
+	if_update_hash(ifp);
 #ifdef _HAVE_VRRP_VMAC_
 	ifp->if_type = IF_TYPE_STANDARD;
 #endif
@@ -2073,6 +2228,7 @@ netlink_link_filter(__attribute__((unused)) struct sockaddr_nl *snl, struct nlms
 			if (prog_type != PROG_TYPE_VRRP) {
 				ifp->ifi_flags = 0;
 				ifp->ifindex = 0;
+				if_update_hash(ifp);
 			} else
 #endif
 				cleanup_lost_interface(ifp);
@@ -2107,6 +2263,7 @@ netlink_link_filter(__attribute__((unused)) struct sockaddr_nl *snl, struct nlms
 						}
 						ifp->hw_addr_len = hw_addr_len;
 						memcpy(ifp->hw_addr, RTA_DATA(tb[IFLA_ADDRESS]), hw_addr_len);
+						if_update_hash(ifp);
 						if (__test_bit(LOG_DETAIL_BIT, &debug)) {
 							format_mac_buf(mac_buf, sizeof mac_buf, ifp->hw_addr, ifp->hw_addr_len);
 							log_message(LOG_INFO, "(%s) MAC %s changed from %s to %s",
@@ -2146,6 +2303,7 @@ netlink_link_filter(__attribute__((unused)) struct sockaddr_nl *snl, struct nlms
 				if (prog_type != PROG_TYPE_VRRP) {
 					ifp->ifi_flags = 0;
 					ifp->ifindex = 0;
+					if_update_hash(ifp);
 				} else
 #endif
 					cleanup_lost_interface(ifp);
@@ -57,6 +57,8 @@ uint32_t (*nla_get_u32_addr)(const struct nlattr *);
 uint64_t (*nla_get_u64_addr)(const struct nlattr *);
 int (*nla_memcpy_addr)(void *, const struct nlattr *, int);
 int (*nla_parse_nested_addr)(struct nlattr **, int, struct nlattr *, struct nla_policy *);
+void (*nl_complete_msg_addr)(struct nl_sock *, struct nl_msg *);
+int (*nl_sendto_addr)(struct nl_sock *, void *, size_t);
 #endif
 #endif
 
@@ -129,6 +131,8 @@ libnl_init(void)
 	    !(nla_get_u64_addr = dlsym(libnl_handle, "nla_get_u64")) ||
 	    !(nla_memcpy_addr = dlsym(libnl_handle, "nla_memcpy")) ||
 	    !(nla_parse_nested_addr = dlsym(libnl_handle, "nla_parse_nested")) ||
+	    !(nl_complete_msg_addr = dlsym(libnl_handle, "nl_complete_msg")) ||
+	    !(nl_sendto_addr = dlsym(libnl_handle, "nl_sendto")) ||
 #endif
 #endif
 	    false)
@@ -540,7 +540,7 @@ start_keepalived(__attribute__((unused)) thread_ref_t thread)
 
 #ifdef _WITH_BFD_
 	/* must be opened before vrrp and bfd start */
-	if (!open_bfd_pipes()) {
+	if (!open_bfd_event_chans()) {
 		thread_add_terminate_event(thread->master);
 		return;
 	}
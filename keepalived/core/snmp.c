@@ -62,120 +62,243 @@ snmp_scope(int scope)
 	return 0;
 }
 
-list_head_t *
-snmp_header_list_head_table(struct variable *vp, oid *name, size_t *length,
-			    int exact, size_t *var_len, WriteMethod **write_method,
-			    list_head_t *l)
+/* Incremented whenever the configuration is loaded, so that indices are rebuilt */
+static unsigned snmp_index_generation = 1;
+static LIST_HEAD_INITIALIZE(snmp_indices);
+
+void
+snmp_index_invalidate(void)
 {
-	oid target, current = 0;
-	list_head_t *e;
+	snmp_index_generation++;
+}
+
+bool
+snmp_index_current(const snmp_index_t *index)
+{
+	return index->generation == snmp_index_generation;
+}
+
+void
+snmp_index_reset(snmp_index_t *index)
+{
+	/* Keep track of the indices so that they can be freed */
+	if (!index->generation)
+		list_add_tail(&index->e_list, &snmp_indices);
+
+	index->generation = snmp_index_generation;
+	index->num_outer = 0;
+	index->num = 0;
+	if (index->start)
+		index->start[0] = 0;
+}
+
+void
+snmp_index_add_outer(snmp_index_t *index, void *p)
+{
+	if (index->num_outer == index->max_outer) {
+		if (index->max_outer) {
+			index->max_outer *= 2;
+			index->outer = REALLOC(index->outer, index->max_outer * sizeof(*index->outer));
+			index->start = REALLOC(index->start, (index->max_outer + 1) * sizeof(*index->start));
+		} else {
+			index->max_outer = 16;
+			index->outer = MALLOC(index->max_outer * sizeof(*index->outer));
+			index->start = MALLOC((index->max_outer + 1) * sizeof(*index->start));
+		}
+	}
+
+	index->outer[index->num_outer++] = p;
+	index->start[index->num_outer] = index->num;
+}
+
+/* Add an entry to the row of the last outer entry added */
+void
+snmp_index_add(snmp_index_t *index, void *p)
+{
+	if (index->num == index->max) {
+		if (index->max) {
+			index->max *= 2;
+			index->entries = REALLOC(index->entries, index->max * sizeof(*index->entries));
+		} else {
+			index->max = 16;
+			index->entries = MALLOC(index->max * sizeof(*index->entries));
+		}
+	}
+
+	index->entries[index->num++] = p;
+	index->start[index->num_outer] = index->num;
+}
+
+static void
+snmp_index_free_all(void)
+{
+	snmp_index_t *index, *index_tmp;
+
+	list_for_each_entry_safe(index, index_tmp, &snmp_indices, e_list) {
+		FREE_PTR(index->outer);
+		FREE_PTR(index->start);
+		FREE_PTR(index->entries);
+		list_del_init(&index->e_list);
+		memset(index, 0, sizeof(*index));
+	}
+}
+
+/* Returns row (i, j) of a two level index, or NULL if it doesn't exist */
+void *
+snmp_index_row(const snmp_index_t *index, oid i, oid j, void **outer)
+{
+	if (i < 1 || i > index->num_outer ||
+	    j < 1 || j > index->start[i] - index->start[i - 1])
+		return NULL;
+
+	if (outer)
+		*outer = index->outer[i - 1];
+
+	return index->entries[index->start[i - 1] + j - 1];
+}
+
+/* The equivalent of header_simple_table() for a table with a single index */
+void *
+snmp_index_table(struct variable *vp, oid *name, size_t *length,
+		 int exact, size_t *var_len, WriteMethod **write_method,
+		 const snmp_index_t *index)
+{
+	oid target;
 
 	if (header_simple_table(vp, name, length, exact, var_len, write_method, -1) != MATCH_SUCCEEDED)
 		return NULL;
 
-	if (list_empty(l))
+	if (!index->num_outer)
 		return NULL;
 
 	target = name[*length - 1];
 
-	list_for_each(e, l) {
-		if (++current < target)
-			/* No match found yet */
-			continue;
-		if (current == target)
-			/* Exact match */
-			return e;
+	if (!target) {
 		if (exact)
-			/* No exact match found */
 			return NULL;
-		/* current is the best match */
-		name[*length - 1] = current;
-		return e;
+
+		/* The first row is the best match */
+		name[*length - 1] = 1;
+		return index->outer[0];
 	}
 
-	/* There are insufficent entries in the list or no match
-	 * at the end then just return no match */
-	return NULL;
+	/* There are insufficent entries in the list */
+	if (target > index->num_outer)
+		return NULL;
+
+	return index->outer[target - 1];
 }
 
-list_head_t *
-snmp_find_element(struct variable *vp, oid *name, size_t *length,
-		  int exact, size_t *var_len, WriteMethod **write_method,
-		  list_head_t *l, size_t offset_outer, size_t offset_inner)
+/* Find the row of a table indexed by two values. For GETNEXT this is the
+ * first row after the target, in which case name is updated. */
+void *
+snmp_index_find(struct variable *vp, oid *name, size_t *length,
+		int exact, size_t *var_len, WriteMethod **write_method,
+		const snmp_index_t *index, void **outer)
 {
-	oid *target, current[2];
+	oid *target;
 	size_t target_len;
-	list_head_t *e, *e1;
-	list_head_t *l1;
-	int result;
+	size_t i, k, lo, hi;
 
 	*write_method = 0;
 	*var_len = sizeof(long);
 
-	if (list_empty(l))
+	if (!index->num)
 		return NULL;
 
 	if (exact && *length != (size_t)vp->namelen + 2)
 		return NULL;
 
-	if ((result = snmp_oid_compare(name, *length, vp->name, vp->namelen)) < 0) {
+	if (snmp_oid_compare(name, *length, vp->name, vp->namelen) < 0) {
 		memcpy(name, vp->name, sizeof(oid) * vp->namelen);
 		*length = vp->namelen;
 	}
 
-	/* We search the best match: equal if exact, the lower OID in
-	 * the set of the OID strictly superior to the target
-	 * otherwise. */
 	target = &name[vp->namelen];   /* Our target match */
 	target_len = *length - vp->namelen;
-	current[0] = 0;
 
-	list_for_each(e, l) {
-		current[0]++;
+	if (exact)
+		return snmp_index_row(index, target[0], target[1], outer);
 
-		if (target_len) {
-			if (current[0] < target[0])
-				continue; /* Optimization: cannot be part of our set */
-			if (exact && current[0] > target[0])
-				return NULL;
-		}
+	/* We want the lowest OID strictly greater than the target. Find its
+	 * position k in entries. */
+	if (!target_len || !target[0])
+		k = 0;
+	else if (target[0] > index->num_outer)
+		return NULL;
+	else {
+		i = target[0];
+		if (target_len == 1)
+			k = index->start[i - 1];
+		else if (target[1] < index->start[i] - index->start[i - 1])
+			k = index->start[i - 1] + target[1];
+		else
+			k = index->start[i];
+	}
+
+	if (k >= index->num)
+		return NULL;
+
+	/* Find the outer entry whose row contains k, i.e. the lowest
+	 * i with start[i] > k */
+	lo = 1;
+	hi = index->num_outer;
+	while (lo < hi) {
+		i = (lo + hi) / 2;
+		if (index->start[i] > k)
+			hi = i;
+		else
+			lo = i + 1;
+	}
+
+	target[0] = lo;
+	target[1] = k - index->start[lo - 1] + 1;
+	*length = (unsigned)vp->namelen + 2;
+
+	if (outer)
+		*outer = index->outer[lo - 1];
+
+	return index->entries[k];
+}
+
+list_head_t *
+snmp_header_list_head_table(struct variable *vp, oid *name, size_t *length,
+			    int exact, size_t *var_len, WriteMethod **write_method,
+			    list_head_t *l, snmp_index_t *index)
+{
+	list_head_t *e;
+
+	if (!snmp_index_current(index)) {
+		snmp_index_reset(index);
+		list_for_each(e, l)
+			snmp_index_add_outer(index, e);
+	}
+
+	return snmp_index_table(vp, name, length, exact, var_len, write_method, index);
+}
 
-		/* Find the list head of the inner list in the outer entry */
-		l1 = PTR_CAST(list_head_t, ((char *)e - offset_outer + offset_inner));
-
-		current[1] = 0;
-		list_for_each(e1, l1) {
-			current[1]++;
-
-			/* Compare to our target match */
-			if (target_len) {
-				if ((result = snmp_oid_compare(current, 2, target,
-							       target_len)) < 0)
-					continue;
-
-				if (result == 0) {
-					if (!exact)
-						continue;
-
-					/* Got an exact match and asked for it */
-					return e1;
-				}
-
-				if (exact) {
-					/* result > 0, so no match */
-					return NULL;
-				}
-			}
-
-			/* This is our best match */
-			memcpy(target, current, sizeof(oid) * 2);
-			*length = (unsigned)vp->namelen + 2;
-			return e1;
+list_head_t *
+snmp_find_element(struct variable *vp, oid *name, size_t *length,
+		  int exact, size_t *var_len, WriteMethod **write_method,
+		  list_head_t *l, size_t offset_outer, size_t offset_inner,
+		  snmp_index_t *index)
+{
+	list_head_t *e, *e1;
+	list_head_t *l1;
+
+	if (!snmp_index_current(index)) {
+		snmp_index_reset(index);
+		list_for_each(e, l) {
+			snmp_index_add_outer(index, e);
+
+			/* Find the list head of the inner list in the outer entry */
+			l1 = PTR_CAST(list_head_t, ((char *)e - offset_outer + offset_inner));
+			list_for_each(e1, l1)
+				snmp_index_add(index, e1);
 		}
 	}
 
-	/* No match at all */
-	return NULL;
+	return snmp_index_find(vp, name, length, exact, var_len, write_method, index, NULL);
 }
 
 enum snmp_global_magic {
@@ -320,12 +443,13 @@ static u_char *
 snmp_mail(struct variable *vp, oid *name, size_t *length,
 	  int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	email_t *email;
 	list_head_t *e;
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					     var_len, write_method,
-					     &global_data->email)) == NULL)
+					     &global_data->email, &table_index)) == NULL)
 		return NULL;
 
 	email = list_entry(e, email_t, e_list);
@@ -498,6 +622,8 @@ snmp_agent_close(bool base_mib)
 	snmp_shutdown(global_name);
 	shutdown_agent();
 
+	snmp_index_free_all();
+
 	snmp_running = false;
 }
 
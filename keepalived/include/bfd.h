@@ -29,6 +29,8 @@
 #include "scheduler.h"
 #include "timer.h"
 #include "sockaddr.h"
+#include "rbtree_types.h"
+#include "name_hash.h"
 
 /*
  *	RFC5881
@@ -69,12 +71,17 @@
 
 #define BFD_TTL_MAX		255
 
+/* Maximum number of packets sent by one sendmmsg() on a shared socket */
+#define BFD_SEND_BATCH		64
+
 /*
  *	BFD Session
  */
 /* Maximum instance name length including \0 */
 #define BFD_INAME_MAX 32
 
+typedef struct _bfd_tx_sock bfd_tx_sock_t;
+
 typedef struct _bfd {
 	/* Configuration parameters */
 	char			iname[BFD_INAME_MAX];	/* Instance name */
@@ -104,6 +111,10 @@ typedef struct _bfd {
 	thread_ref_t		thread_rst;		/* Reset thread */
 	unsigned long		sands_rst;		/* Reset thread sands, used for suspend/resume */
 	bool			send_error;		/* Set if last send had an error */
+	bfd_tx_sock_t		*tx_sock;		/* Shared output socket, if bfd_shared_socket */
+	timeval_t		sands;			/* Next transmit time on shared socket */
+	timeval_t		last_tx;		/* Time of last periodic transmit on shared socket */
+	rb_node_t		rb_tx;			/* Shared socket transmit queue member */
 
 	/* State variables */
 	uint8_t			local_state:2;		/* Local state */
@@ -129,6 +140,11 @@ typedef struct _bfd {
 
 	/* Linked list member */
 	list_head_t		e_list;
+
+	/* bfd_data hash table members */
+	hlist_node_t		e_discr;		/* By local discriminator */
+	hlist_node_t		e_addr;			/* By neighbor address */
+	name_hash_node_t	e_name;			/* By name */
 } bfd_t;
 
 /*
@@ -23,16 +23,20 @@
 #ifndef _BFD_DAEMON_H
 #define _BFD_DAEMON_H
 
+#include <stdbool.h>
+
+#include "bfd_event.h"
+
 #define PROG_BFD "Keepalived_bfd"
 
 #ifdef _WITH_VRRP_
-extern int bfd_vrrp_event_pipe[2];
+extern bfd_event_chan_t bfd_vrrp_event_chan;
 #endif
 #ifdef _WITH_LVS_
-extern int bfd_checker_event_pipe[2];
+extern bfd_event_chan_t bfd_checker_event_chan;
 #endif
 
-extern bool open_bfd_pipes(void);
+extern bool open_bfd_event_chans(void);
 extern int start_bfd_child(void);
 extern void bfd_validate_config(void);
 #ifdef THREAD_DUMP
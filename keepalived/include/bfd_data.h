@@ -29,8 +29,14 @@
 #include "bfd.h"
 #include "sockaddr.h"
 
+#define BFD_HASH_BITS	8
+#define BFD_HASH_SIZE	(1U << BFD_HASH_BITS)
+
 typedef struct _bfd_data {
 	list_head_t	bfd;		/* bfd_t - BFD instances */
+	hlist_head_t	discr_hash[BFD_HASH_SIZE];	/* bfd_t by local discriminator */
+	hlist_head_t	addr_hash[BFD_HASH_SIZE];	/* bfd_t by neighbor address */
+	name_hash_t	name_hash;	/* bfd_t by iname */
 	int		fd_in;		/* Input socket fd */
 	thread_ref_t	thread_in;	/* Input socket thread */
 } bfd_data_t;
@@ -43,7 +49,9 @@ extern bfd_data_t *old_bfd_data;
 extern char *bfd_buffer;
 
 extern bfd_t *alloc_bfd(const char *);
+extern void add_bfd(bfd_t *);
 extern void free_bfd(bfd_t *);
+extern void bfd_set_local_discr(bfd_t *, uint32_t);
 extern bfd_data_t *alloc_bfd_data(void);
 extern void dump_bfd_data(FILE *, const bfd_data_t *);
 #ifndef _ONE_PROCESS_DEBUG_
@@ -23,14 +23,46 @@
 #ifndef _BFD_EVENT_H
 #define _BFD_EVENT_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #include "bfd.h"
 
+/* Number of events the ring can hold, must be a power of 2 */
+#define BFD_EVENT_RING_SIZE	1024
+
 typedef struct _bfd_event {
 	char		iname[BFD_INAME_MAX];
 	uint8_t		state;
 	timeval_t	sent_time;
 } bfd_event_t;
 
+/* Single producer/single consumer ring in memory shared between the BFD
+ * process and the VRRP or checker process. head is only written by the
+ * BFD process, and tail only by the consumer. */
+typedef struct _bfd_event_ring {
+	uint32_t	head;
+	uint32_t	tail __attribute__((aligned(64)));
+	bfd_event_t	evt[BFD_EVENT_RING_SIZE] __attribute__((aligned(64)));
+} bfd_event_ring_t;
+
+/* The eventfd is written once for all the events queued while the BFD
+ * process handles one set of ready threads */
+typedef struct _bfd_event_chan {
+	const char	*name;
+	bfd_event_ring_t *ring;
+	int		fd;		/* eventfd */
+	bool		doorbell;	/* Set if events are waiting for the eventfd to be written */
+	bool		overflow;	/* Set if the last event didn't fit in the ring */
+} bfd_event_chan_t;
+
+extern bool bfd_event_chan_open(bfd_event_chan_t *);
+extern void bfd_event_chan_close(bfd_event_chan_t *);
 extern void bfd_event_send(bfd_t *);
+extern void bfd_event_receive(bfd_event_chan_t *, void (*)(const bfd_event_t *));
+extern void bfd_event_flush(void);
+#ifdef THREAD_DUMP
+extern void register_bfd_event_addresses(void);
+#endif
 
 #endif				/* _BFD_EVENT_H */
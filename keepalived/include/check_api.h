@@ -76,7 +76,8 @@ typedef struct _checker {
 	conn_opts_t			*co;			/* connection options */
 	int				alpha;			/* Alpha mode enabled */
 	unsigned long			delay_loop;		/* Interval between running checker */
-	unsigned long			warmup;			/* max random timeout to start checker */
+	unsigned long			warmup;			/* max timeout to start checker */
+	unsigned long			phase;			/* offset of runs within delay_loop */
 	unsigned			retry;			/* number of retries before failing */
 	unsigned long			delay_before_retry;	/* interval between retries */
 	unsigned			retry_it;		/* number of successive failures */
@@ -127,9 +128,13 @@ extern bool compare_conn_opts(const conn_opts_t *, const conn_opts_t *) __attrib
 extern void dump_checkers_queue(FILE *);
 extern void free_checkers_queue(void);
 extern void register_checkers_thread(void);
+extern void checker_add_timer(checker_t *, unsigned long);
 extern void install_checkers_keyword(void);
 extern void checker_set_dst_port(sockaddr_t *, uint16_t);
 extern void install_checker_common_keywords(bool);
 extern void update_checker_activity(sa_family_t, void *, bool);
+#ifdef THREAD_DUMP
+extern void register_check_api_addresses(void);
+#endif
 
 #endif
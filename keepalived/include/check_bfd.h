@@ -24,6 +24,7 @@
 #define _CHECK_BFD_H
 
 #include "scheduler.h"
+#include "name_hash.h"
 
 /* external bfd we read to track forwarding to remote systems */
 typedef struct _checker_tracked_bfd {
@@ -33,6 +34,9 @@ typedef struct _checker_tracked_bfd {
 
 	/* Linked list member */
 	list_head_t		e_list;
+
+	/* check_data->track_bfd_by_name member */
+	name_hash_node_t	e_name;
 } checker_tracked_bfd_t;
 
 /* Checker Reference Tracked bfd structure definition.
@@ -38,6 +38,7 @@
 #include "logger.h"
 #include "ip_vs.h"
 #include "list_head.h"
+#include "name_hash.h"
 #include "vector.h"
 #include "notify.h"
 #include "utils.h"
@@ -109,6 +110,7 @@ typedef struct _real_server {
 	bool				alive;
 	unsigned			num_failed_checkers;/* Number of failed checkers */
 	bool				set;		/* in the IPVS table */
+	bool				ipvs_retry;	/* a queued IPVS command failed, re-issue it */
 	bool				reloaded;	/* active state was copied from old config while reloading */
 	const char			*virtualhost;	/* Default virtualhost for HTTP and SSL health checkers */
 #if defined(_WITH_SNMP_CHECKER_)
@@ -165,9 +167,13 @@ typedef struct _virtual_server_group {
 #ifdef _WITH_NFTABLES_
 	unsigned			auto_fwmark[PROTO_INDEX_MAX];
 #endif
+	uint16_t			num_vs;		/* Virtual servers using the group */
 
 	/* Linked list member */
 	list_head_t			e_list;
+
+	/* check_data->vs_group_by_name member */
+	name_hash_node_t		e_name;
 } virtual_server_group_t;
 
 /* Virtual Server definition */
@@ -238,10 +244,12 @@ typedef struct _check_data {
 	bool				ssl_required;
 	ssl_data_t			*ssl;
 	list_head_t			vs_group;	/* virtual_server_group_t */
+	name_hash_t			vs_group_by_name; /* virtual_server_group_t by gname */
 	list_head_t			vs;		/* virtual_server_t */
 	list_head_t			track_files;	/* tracked_file_t */
 #ifdef _WITH_BFD_
 	list_head_t			track_bfds;	/* checker_tracked_bfd_t */
+	name_hash_t			track_bfd_by_name; /* checker_tracked_bfd_t by bname */
 #endif
 	unsigned			num_checker_fd_required;
 	unsigned			num_smtp_alert;
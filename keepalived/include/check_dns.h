@@ -28,6 +28,8 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include "check_udp_pool.h"
+
 #define DNS_DEFAULT_RETRY    3
 #define DNS_DEFAULT_TYPE  DNS_TYPE_SOA
 #define DNS_DEFAULT_NAME    ""
@@ -88,6 +90,7 @@ typedef struct _dns_check {
 	const char *name;
 	uint8_t sbuf[DNS_BUFFER_SIZE] __attribute__((aligned(__alignof__(dns_header_t))));
 	size_t slen;
+	udp_pool_req_t req;
 } dns_check_t;
 
 extern void install_dns_check_keyword(void);
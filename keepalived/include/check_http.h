@@ -40,6 +40,7 @@
 
 /* local includes */
 #include "scheduler.h"
+#include "check_api.h"
 
 typedef enum {
         HTTP_PROTOCOL_1_0,
@@ -65,6 +66,17 @@ typedef struct _request {
 	EVP_MD_CTX			*context;
 	size_t				content_len;
 	size_t				rx_bytes;
+	bool				keep_conn;	/* Connection can be reused after the response */
+	bool				complete;	/* Response framing complete */
+	bool				reused;		/* Request sent on a reused connection */
+	bool				idle;		/* fd is an idle persistent connection */
+	bool				head;		/* HEAD request, so no body */
+	bool				headers_only;	/* Only the status code is checked */
+	int				fd;
+	size_t				body_len;	/* Expected body length, SIZE_MAX if chunked */
+	size_t				body_rx;
+	unsigned			chunk_state;
+	size_t				chunk_len;
 #ifdef _WITH_REGEX_CHECK_
 	bool				regex_matched;
 	size_t				start_offset;	/* Offset into buffer to match from */
@@ -125,6 +137,11 @@ typedef struct _http_checker {
 	bool				enable_sni;
 #endif
 	bool				fast_recovery;
+	bool				persistent;	/* Reuse connection across requests */
+	bool				head_request;	/* Use HEAD if only checking the status code */
+	SSL_SESSION			*ssl_session;	/* Session to resume on reconnect */
+	unsigned			ssl_resumed;
+	unsigned			ssl_full_handshakes;
 	int				genhash_flags;
 } http_checker_t;
 
@@ -151,6 +168,9 @@ extern void timeout_epilog(thread_ref_t, const char *);
 extern void dump_digest(unsigned char *, unsigned);
 extern void http_process_response(thread_ref_t, request_t *, size_t, url_t *);
 extern void http_handle_response(thread_ref_t, unsigned char digest[16], bool);
+extern bool http_response_done(const request_t *) __attribute__ ((pure));
+extern void http_handle_complete_response(thread_ref_t, request_t *, url_t *);
+extern bool http_reconnect_reused(thread_ref_t);
 extern void http_connect_thread(thread_ref_t);
 #ifdef THREAD_DUMP
 extern void register_check_http_addresses(void);
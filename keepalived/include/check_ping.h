@@ -23,14 +23,27 @@
 #ifndef _CHECK_PING_H
 #define _CHECK_PING_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #include "check_api.h"
+#include "list_head.h"
+#include "rbtree_types.h"
+#include "timer.h"
 
 typedef struct _ping_check {
+	checker_t		*checker;
+	uint16_t		seq;		/* Sequence number of outstanding echo request */
+	bool			pending;
+	timeval_t		sands;		/* Reply timeout */
+	hlist_node_t		e_hash;
+	rb_node_t		n;
 } ping_check_t;
 
 /* function prototypes */
 extern bool set_ping_group_range(bool);
 extern void install_ping_check_keyword(void);
+extern void checker_ping_dispatcher_release(void);
 #ifdef THREAD_DUMP
 extern void register_check_ping_addresses(void);
 #endif
@@ -27,6 +27,8 @@
 
 #include <inttypes.h>
 
+#include "check_udp_pool.h"
+
 
 typedef struct _udp_check {
 	uint16_t	payload_len;
@@ -37,6 +39,7 @@ typedef struct _udp_check {
 	uint8_t		*reply_mask;
 	uint16_t	min_reply_len;
 	uint16_t	max_reply_len;
+	udp_pool_req_t	req;
 } udp_check_t;
 
 /* Prototypes defs */
@@ -0,0 +1,67 @@
+/*
+ * Soft:        Keepalived is a failover program for the LVS project
+ *              <www.linuxvirtualserver.org>. It monitor & manipulate
+ *              a loadbalanced server pool using multi-layer checks.
+ *
+ * Part:        check_udp_pool.c include file.
+ *
+ * Author:      Alexandre Cassen, <acassen@linux-vs.org>
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *              See the GNU General Public License for more details.
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              as published by the Free Software Foundation; either version
+ *              2 of the License, or (at your option) any later version.
+ *
+ * Copyright (C) 2001-2024 Alexandre Cassen, <acassen@gmail.com>
+ */
+
+#ifndef _CHECK_UDP_POOL_H
+#define _CHECK_UDP_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "check_api.h"
+#include "layer4.h"
+#include "list_head.h"
+#include "rbtree_types.h"
+#include "timer.h"
+
+typedef struct _udp_pool_sock udp_pool_sock_t;
+typedef struct _udp_pool_req udp_pool_req_t;
+
+/* Called with connect_success and the datagram when a reply is received,
+ * connect_error if an ICMP unreachable is received, or connect_timeout.
+ * For a reply, returning false leaves the request outstanding. */
+typedef bool (*udp_pool_func_t)(udp_pool_req_t *, enum connect_result, const uint8_t *, size_t);
+
+/* An outstanding request on a pooled socket. Replies are matched on the
+ * source address and port, and if match_id is set on the first two octets
+ * of the datagram (the DNS transaction ID). */
+struct _udp_pool_req {
+	checker_t		*checker;
+	udp_pool_func_t		func;
+	bool			match_id;
+	uint16_t		id;
+	bool			pending;
+	udp_pool_sock_t		*sock;
+	timeval_t		sands;		/* Reply timeout */
+	hlist_node_t		e_hash;
+	rb_node_t		n;
+};
+
+/* Prototypes defs */
+extern enum connect_result udp_pool_send(udp_pool_req_t *, const void *, size_t);
+extern void udp_pool_cancel(udp_pool_req_t *);
+extern void udp_pool_release(void);
+#ifdef THREAD_DUMP
+extern void register_check_udp_pool_addresses(void);
+#endif
+
+#endif
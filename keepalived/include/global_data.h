@@ -211,6 +211,7 @@ typedef struct _data {
 	bool				have_bfd_config;
 	char				bfd_process_priority;
 	bool				bfd_no_swap;
+	bool				bfd_shared_socket;
 	unsigned			bfd_realtime_priority;
 	cpu_set_t			bfd_cpu_mask;
 	rlim_t				bfd_rlimit_rt;
@@ -248,6 +249,12 @@ typedef struct _data {
 	bool				enable_dbus;
 	const char			*dbus_service_name;
 #endif
+#ifdef _WITH_JSON_
+	const char			*json_socket;
+#ifdef _WITH_LVS_
+	const char			*lvs_json_socket;
+#endif
+#endif
 #ifdef _WITH_VRRP_
 	unsigned			vrrp_netlink_cmd_rcv_bufs;
 	bool				vrrp_netlink_cmd_rcv_bufs_force;
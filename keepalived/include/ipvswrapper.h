@@ -66,7 +66,12 @@ extern int ipvs_start(void);
 extern void ipvs_stop(void);
 extern void ipvs_set_timeouts(const ipvs_timeout_t *);
 extern void ipvs_flush_cmd(void);
-extern virtual_server_group_t *ipvs_get_group_by_name(const char *, list_head_t *) __attribute__ ((pure));
+extern void ipvs_cmd_batch_start(void);
+extern void ipvs_cmd_batch_end(void);
+extern void ipvs_cmd_queue_start(void);
+extern void ipvs_cmd_queue_end(void);
+extern void dump_ipvs_queue(FILE *);
+extern virtual_server_group_t *ipvs_get_group_by_name(const char *, const check_data_t *) __attribute__ ((pure));
 extern void ipvs_group_sync_entry(virtual_server_t *vs, virtual_server_group_entry_t *vsge);
 extern void ipvs_group_remove_entry(virtual_server_t *, virtual_server_group_entry_t *);
 extern void unset_vsge_alive(virtual_server_group_entry_t *, const virtual_server_t *);
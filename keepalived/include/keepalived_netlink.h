@@ -48,6 +48,30 @@ typedef struct _nl_handle {
 } nl_handle_t;
 
 /* Define types */
+#ifdef _WITH_VRRP_
+/* Requests sent to the kernel in a single sendmsg() */
+#define NL_BATCH_MAX_LEN	(32 * 1024)
+#define NL_BATCH_REPLY_SIZE	4096	/* Receive buffer space allowed for each reply */
+
+typedef struct _nl_batch_entry {
+	void			*obj;		/* The object the request is for */
+	int			error_ignore;	/* netlink_error_ignore when queued */
+	int			status;		/* 0 on success, -1 on failure */
+} nl_batch_entry_t;
+
+typedef struct _nl_batch {
+	char			*buf;
+	size_t			len;
+	size_t			buf_size;
+	nl_batch_entry_t	*entries;
+	unsigned		num;
+	unsigned		max_entries;
+	unsigned		unsent;		/* Index of first entry not yet sent */
+	unsigned		max_unsent;	/* Maximum requests in a single send */
+	uint32_t		first_seq;	/* Sequence number of first unsent entry */
+} nl_batch_t;
+#endif
+
 #ifndef NLMSG_TAIL
 #define NLMSG_TAIL(nmsg) ((void *)(((char *) (nmsg)) + NLMSG_ALIGN((nmsg)->nlmsg_len)))
 #endif
@@ -128,6 +152,9 @@ rta_addattr64(struct rtattr *rta, size_t maxlen, unsigned short type, uint64_t d
 extern struct rtattr *rta_nest(struct rtattr *, size_t, unsigned short);
 extern size_t rta_nest_end(struct rtattr *, struct rtattr *);
 extern ssize_t netlink_talk(nl_handle_t *, struct nlmsghdr *);
+extern void netlink_batch_add(nl_batch_t *, struct nlmsghdr *, void *);
+extern void netlink_batch_send(nl_batch_t *);
+extern void netlink_batch_free(nl_batch_t *);
 extern int netlink_interface_lookup(char *);
 extern void kernel_netlink_poll(void);
 extern void process_if_status_change(interface_t *);
@@ -33,6 +33,10 @@ typedef struct ip_vs_service_entry_app	ipvs_service_entry_t;
 typedef struct ip_vs_dest_entry_app	ipvs_dest_entry_t;
 
 
+/* Called with the result of each command sent in a batch */
+typedef void (*ipvs_batch_done_t)(int);
+
+
 /* init socket and get ipvs info */
 extern int ipvs_init(void);
 
@@ -63,6 +67,12 @@ extern int ipvs_update_dest(ipvs_service_t *svc, ipvs_dest_t *dest);
 /* remove a destination server from a service */
 extern int ipvs_del_dest(ipvs_service_t *svc, ipvs_dest_t *dest);
 
+/* queue service and destination commands to be sent together */
+extern bool ipvs_batch_start(ipvs_batch_done_t);
+
+/* send any queued commands and stop queueing */
+extern void ipvs_batch_end(void);
+
 /* start a connection synchronizaiton daemon (master/backup) */
 extern int ipvs_start_daemon(ipvs_daemon_t *dm);
 
@@ -76,6 +86,9 @@ extern struct ip_vs_get_dests_app *ipvs_get_dests(ipvs_service_entry_t *svc);
 /* get an ipvs service entry */
 extern ipvs_service_entry_t *
 ipvs_get_service(__u32 fwmark, __u16 af, __u16 protocol, union nf_inet_addr *addr, __u16 port);
+
+/* get all the ipvs service entries */
+extern struct ip_vs_get_services_app *ipvs_get_services(void);
 #endif
 
 /* close the socket */
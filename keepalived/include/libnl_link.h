@@ -54,6 +54,8 @@ extern uint32_t (*nla_get_u32_addr)(const struct nlattr *);
 extern uint64_t (*nla_get_u64_addr)(const struct nlattr *);
 extern int (*nla_memcpy_addr)(void *, const struct nlattr *, int);
 extern int (*nla_parse_nested_addr)(struct nlattr **, int, struct nlattr *, struct nla_policy *);
+extern void (*nl_complete_msg_addr)(struct nl_sock *, struct nl_msg *);
+extern int (*nl_sendto_addr)(struct nl_sock *, void *, size_t);
 #endif
 #endif
 
@@ -86,6 +88,8 @@ extern int (*nla_parse_nested_addr)(struct nlattr **, int, struct nlattr *, stru
 #define nla_get_u64 (*nla_get_u64_addr)
 #define nla_memcpy (*nla_memcpy_addr)
 #define nla_parse_nested (*nla_parse_nested_addr)
+#define nl_complete_msg (*nl_complete_msg_addr)
+#define nl_sendto (*nl_sendto_addr)
 #endif
 #endif
 
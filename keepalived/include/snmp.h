@@ -72,13 +72,45 @@ typedef union {
 	u_char *p;
 } snmp_ret_t;
 
+/* An index of the rows of a table, so that a GET or GETNEXT doesn't have
+ * to walk the lists to find the row. Row n of a table with a single index
+ * is outer[n - 1]. For a table indexed by two values, row (i, j) is
+ * entries[start[i - 1] + j - 1], and outer[i - 1] is the outer entry.
+ * The index is rebuilt when it is next used after the configuration has
+ * been (re)loaded. */
+typedef struct _snmp_index {
+	unsigned		generation;
+	void			**outer;
+	size_t			*start;		/* max_outer + 1 entries */
+	size_t			num_outer;
+	size_t			max_outer;
+	void			**entries;
+	size_t			num;
+	size_t			max;
+
+	/* Linking */
+	list_head_t		e_list;
+} snmp_index_t;
+
 extern unsigned long snmp_scope(int ) __attribute__ ((const));
+extern void snmp_index_invalidate(void);
+extern bool snmp_index_current(const snmp_index_t *) __attribute__ ((pure));
+extern void snmp_index_reset(snmp_index_t *);
+extern void snmp_index_add_outer(snmp_index_t *, void *);
+extern void snmp_index_add(snmp_index_t *, void *);
+extern void *snmp_index_row(const snmp_index_t *, oid, oid, void **);
+extern void *snmp_index_table(struct variable *, oid *, size_t *,
+			      int, size_t *, WriteMethod **,
+			      const snmp_index_t *);
+extern void *snmp_index_find(struct variable *, oid *, size_t *,
+			     int, size_t *, WriteMethod **,
+			     const snmp_index_t *, void **);
 extern list_head_t *snmp_header_list_head_table(struct variable *, oid *, size_t *,
 						int, size_t *, WriteMethod **,
-						list_head_t *);
+						list_head_t *, snmp_index_t *);
 extern list_head_t *snmp_find_element(struct variable *, oid *, size_t *,
 				      int, size_t *, WriteMethod **,
-				      list_head_t *, size_t, size_t);
+				      list_head_t *, size_t, size_t, snmp_index_t *);
 extern void snmp_agent_init(const char *, bool);
 extern void snmp_register_mib(oid *, size_t, const char *,
 			      struct variable *, size_t, size_t);
@@ -47,6 +47,7 @@
 #include "vrrp_sock.h"
 #include "vrrp_track.h"
 #include "sockaddr.h"
+#include "name_hash.h"
 
 struct _ip_address;
 
@@ -170,6 +171,9 @@ typedef struct _vrrp_sgroup {
 
 	/* linked list member */
 	list_head_t		e_list;
+
+	/* vrrp_data->vrrp_sync_group_by_name member */
+	name_hash_node_t	e_name;
 } vrrp_sgroup_t;
 
 /* Statistics */
@@ -233,6 +237,7 @@ typedef struct {
 
 typedef struct _unicast_peer_t {
 	sockaddr_t		address;
+	char			*send_buffer;		/* IPv4 advert for this peer */
 #ifdef _CHECKSUM_DEBUG_
 	checksum_check_t	chk;
 #endif
@@ -405,6 +410,9 @@ typedef struct _vrrp_t {
 
 	/* Linked list member */
 	list_head_t		e_list;
+
+	/* vrrp_data->vrrp_by_name member */
+	name_hash_node_t	e_name;
 } vrrp_t;
 
 /* VRRP state machine -- rfc2338.6.4 */
@@ -427,6 +435,9 @@ typedef struct _vrrp_t {
 
 /* VRRP Packet fixed length */
 #define VRRP_AUTH_LEN		8
+
+/* Maximum number of adverts sent by one sendmmsg() call */
+#define VRRP_SEND_BATCH		64
 #define VRRP_VIP_TYPE		(1 << 0)
 #define VRRP_EVIP_TYPE		(1 << 1)
 
@@ -469,6 +480,8 @@ extern size_t vrrp_adv_len(const vrrp_t *) __attribute__ ((pure));
 extern const vrrphdr_t *vrrp_get_header(sa_family_t, const char *, size_t);
 extern void open_sockpool_socket(sock_t *);
 extern int new_vrrp_socket(vrrp_t *);
+extern void vrrp_tx_batch_start(void);
+extern void vrrp_tx_batch_end(void);
 extern void vrrp_send_adv(vrrp_t *, uint8_t);
 extern void vrrp_send_link_update(vrrp_t *, unsigned);
 extern void add_vrrp_to_interface(vrrp_t *, interface_t *, int, bool, bool, track_t);
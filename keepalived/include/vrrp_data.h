@@ -30,29 +30,38 @@
 
 /* local includes */
 #include "list_head.h"
+#include "name_hash.h"
 #include "vector.h"
 #include "vrrp_static_track.h"
 
+/* Maximum number of adverts read by one recvmmsg() call */
+#define VRRP_RECV_BATCH		16
 
 /* Configuration data root */
 typedef struct _vrrp_data {
 	list_head_t		static_track_groups;	/* static_track_group_t */
+	name_hash_t		static_track_group_by_name; /* static_track_group_t by gname */
 	list_head_t		static_addresses;	/* ip_address_t */
 	list_head_t		static_routes;		/* ip_route_t */
 	list_head_t		static_rules;		/* ip_rule_t */
 	list_head_t		vrrp_sync_group;	/* vrrp_sgroup_t */
+	name_hash_t		vrrp_sync_group_by_name; /* vrrp_sgroup_t by gname */
 	list_head_t		vrrp;			/* vrrp_t */
+	name_hash_t		vrrp_by_name;		/* vrrp_t by iname */
 	list_head_t		vrrp_socket_pool;	/* sock_t */
 	list_head_t		vrrp_script;		/* vrrp_script_t */
+	name_hash_t		vrrp_script_by_name;	/* vrrp_script_t by sname */
 	list_head_t		vrrp_track_files;	/* tracked_file_t */
 #ifdef _WITH_TRACK_PROCESS_
 	list_head_t		vrrp_track_processes;	/* vrrp_tracked_process_t */
+	name_hash_t		vrrp_track_process_by_name; /* vrrp_tracked_process_t by pname */
 	size_t			vrrp_max_process_name_len;
 	bool			vrrp_use_process_cmdline;
 	bool			vrrp_use_process_comm;
 #endif
 #ifdef _WITH_BFD_
 	list_head_t		vrrp_track_bfds;	/* vrrp_tracked_bfd_t */
+	name_hash_t		vrrp_track_bfd_by_name;	/* vrrp_tracked_bfd_t by bname */
 #endif
 	unsigned		num_smtp_alert;		/* No of smtp_alerts configured */
 } vrrp_data_t;
@@ -182,6 +182,13 @@ typedef struct _interface {
 	uint32_t		reset_promote_secondaries; /* Count of how many vrrps have changed promote_secondaries on interface */
 	list_head_t		tracking_vrrp;		/* tracking_obj_t - vrrp instances tracking this interface */
 
+	/* Hash members, indexed by ifindex, name and MAC address */
+	hlist_node_t		e_hash_ifindex;
+	hlist_node_t		e_hash_name;
+#ifdef _HAVE_VRRP_VMAC_
+	hlist_node_t		e_hash_hw_addr;
+#endif
+
 	/* linked list member */
 	list_head_t		e_list;
 } interface_t;
@@ -239,6 +246,7 @@ extern interface_t * if_get_by_vmac(uint8_t, int, const interface_t *, const u_c
 #endif
 extern interface_t *get_default_if(void);
 extern interface_t *if_get_by_ifname(const char *, if_lookup_t);
+extern void if_update_hash(interface_t *);
 extern sin_addr_t *if_extra_ipaddress_alloc(interface_t *, void *, unsigned char);
 extern void if_extra_ipaddress_free(sin_addr_t *);
 extern void if_extra_ipaddress_free_list(list_head_t *);
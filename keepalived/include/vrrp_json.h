@@ -27,5 +27,8 @@
 
 /* Prototypes */
 extern void vrrp_print_json(void);
+extern void vrrp_json_notify(const char *, const char *, const char *, int);
+extern void vrrp_json_socket_open(void);
+extern void vrrp_json_socket_close(void);
 
 #endif
@@ -28,6 +28,7 @@
 
 /* local includes */
 #include "vector.h"
+#include "name_hash.h"
 #include "vrrp_if.h"
 
 /* Parameters for static track groups */
@@ -38,6 +39,9 @@ typedef struct _static_track_group {
 
 	/* linked list member */
 	list_head_t		e_list;
+
+	/* vrrp_data->static_track_group_by_name member */
+	name_hash_node_t	e_name;
 } static_track_group_t;
 
 extern void free_static_track_group(static_track_group_t *);
@@ -31,6 +31,7 @@
 /* local includes */
 #include "vector.h"
 #include "list_head.h"
+#include "name_hash.h"
 #include "vrrp_if.h"
 #include "vrrp.h"
 #include "notify.h"
@@ -79,6 +80,9 @@ typedef struct _vrrp_script {
 
 	/* linked list member */
 	list_head_t		e_list;
+
+	/* vrrp_data->vrrp_script_by_name member */
+	name_hash_node_t	e_name;
 } vrrp_script_t;
 
 /* Tracked script structure definition */
@@ -122,6 +126,9 @@ typedef struct _vrrp_tracked_process {
 
 	/* linked list member */
 	list_head_t		e_list;
+
+	/* vrrp_data->vrrp_track_process_by_name member */
+	name_hash_node_t	e_name;
 } vrrp_tracked_process_t;
 
 /* Tracked process structure definition */
@@ -163,6 +170,9 @@ typedef struct _vrrp_tracked_bfd {
 
 	/* linked list member */
 	list_head_t		e_list;
+
+	/* vrrp_data->vrrp_track_bfd_by_name member */
+	name_hash_node_t	e_name;
 } vrrp_tracked_bfd_t;
 
 /* Tracked bfd structure definition */
@@ -196,7 +206,7 @@ extern void alloc_track_process(const char *, list_head_t *, const vector_t *);
 #endif
 #ifdef _WITH_BFD_
 extern vrrp_tracked_bfd_t *find_vrrp_tracked_bfd_by_name(const char *) __attribute__ ((pure));
-extern vrrp_tracked_bfd_t *alloc_vrrp_tracked_bfd(const char *, list_head_t *);
+extern vrrp_tracked_bfd_t *alloc_vrrp_tracked_bfd(const char *);
 extern void dump_tracked_bfd_list(FILE *, const list_head_t *);
 extern void free_track_bfd(tracked_bfd_t *);
 extern void free_track_bfd_list(list_head_t *);
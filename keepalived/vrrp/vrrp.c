@@ -102,6 +102,23 @@ static bool monitor_ipv6_routes;
 static bool monitor_ipv4_rules;
 static bool monitor_ipv6_rules;
 
+/* Adverts queued for sending by a single sendmmsg() */
+typedef struct _vrrp_tx_msg {
+	vrrp_t			*vrrp;
+	unicast_peer_t		*peer;
+	uint8_t			prio;
+	char			cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(unsigned))]
+					__attribute__((aligned(__alignof__(struct cmsghdr))));
+} vrrp_tx_msg_t;
+
+static struct mmsghdr vrrp_tx_mmsg[VRRP_SEND_BATCH];
+static struct iovec vrrp_tx_iov[VRRP_SEND_BATCH];
+static vrrp_tx_msg_t vrrp_tx_msg[VRRP_SEND_BATCH];
+static unsigned vrrp_tx_num;
+static int vrrp_tx_fd = -1;
+static int vrrp_tx_flags;
+static unsigned vrrp_tx_batch_depth;
+
 #ifdef _NETWORK_TIMESTAMP_
 bool do_network_timestamp;
 #endif
@@ -370,35 +387,29 @@ expected_vrrp_pkt_len(const vrrphdr_t *vh, int family)
 	return len;
 }
 
-static void
-vrrp_update_pkt(vrrp_t *vrrp, uint8_t prio, sockaddr_t *addr)
+/* Return the VRRP header within an advert buffer */
+static vrrphdr_t *
+vrrp_pkt_hdr(const vrrp_t *vrrp, char *buffer)
 {
-	char *bufptr = vrrp->send_buffer;
-	vrrphdr_t *hd;
-#ifdef _WITH_VRRP_AUTH_
-	bool final_update;
-	unicast_peer_t *peer = NULL;
-#endif
-	uint32_t new_saddr = 0;
-	uint32_t new_daddr;
-
-#ifdef _WITH_VRRP_AUTH_
-	/* We will need to be called again if there is more than one unicast peer, so don't calculate checksums */
-	if (__test_bit(VRRP_FLAG_UNICAST, &vrrp->flags))
-		peer = list_first_entry(&vrrp->unicast_peer, unicast_peer_t, e_list);
-	final_update = (!peer || list_is_last(&peer->e_list, &vrrp->unicast_peer) || addr);
-#endif
-
 	if (vrrp->family == AF_INET) {
-		bufptr += sizeof(struct iphdr);
+		buffer += sizeof(struct iphdr);
 
 #ifdef _WITH_VRRP_AUTH_
 		if (vrrp->auth_type == VRRP_AUTH_AH)
-			bufptr += sizeof(ipsec_ah_t);
+			buffer += sizeof(ipsec_ah_t);
 #endif
 	}
 
-	hd = PTR_CAST(vrrphdr_t, bufptr);
+	return PTR_CAST(vrrphdr_t, buffer);
+}
+
+/* Update the fields of an advert buffer that can change between adverts */
+static void
+vrrp_update_buf(vrrp_t *vrrp, char *buffer, uint8_t prio)
+{
+	vrrphdr_t *hd = vrrp_pkt_hdr(vrrp, buffer);
+	uint32_t new_saddr = 0;
+
 	if (hd->priority != prio) {
 		if (vrrp->family == AF_INET) {
 			/* HC' = ~(~HC + ~m + m') */
@@ -413,29 +424,10 @@ vrrp_update_pkt(vrrp_t *vrrp, uint8_t prio, sockaddr_t *addr)
 	}
 
 	if (vrrp->family == AF_INET) {
-		struct iphdr *ip = PTR_CAST(struct iphdr, (vrrp->send_buffer));
-		if (!addr) {
-			/* kernel will fill in ID if left to 0, so we overflow to 1 */
-			if (!++vrrp->ip_id)
-				++vrrp->ip_id;
-			ip->id = htons(vrrp->ip_id);
-		}
-		else {
-			/* If unicast address */
-			if (vrrp->version == VRRP_VERSION_2)
-				ip->daddr = inet_sockaddrip4(addr);
-			else {
-				new_daddr = inet_sockaddrip4(addr);
+		struct iphdr *ip = PTR_CAST(struct iphdr, buffer);
 
-				if (ip->daddr != new_daddr) {
-#ifdef _WITH_UNICAST_CHKSUM_COMPAT_
-					if (vrrp->unicast_chksum_compat < CHKSUM_COMPATIBILITY_MIN_COMPAT)
-#endif
-						hd->chksum = csum_incremental_update32(hd->chksum, ip->daddr, new_daddr);
-					ip->daddr = new_daddr;
-				}
-			}
-		}
+		/* The IP header checksum is filled in by the kernel */
+		ip->id = htons(vrrp->ip_id);
 
 		/* Has the source address changed? */
 		if (!__test_bit(VRRP_FLAG_SADDR_FROM_CONFIG, &vrrp->flags) &&
@@ -452,77 +444,95 @@ vrrp_update_pkt(vrrp_t *vrrp, uint8_t prio, sockaddr_t *addr)
 #ifdef _WITH_VRRP_AUTH_
 		if (vrrp->auth_type == VRRP_AUTH_AH) {
 			unsigned char digest[MD5_DIGEST_LENGTH];
-			ipsec_ah_t *ah = PTR_CAST(ipsec_ah_t, (vrrp->send_buffer + sizeof (struct iphdr)));
+			ipsec_ah_t *ah = PTR_CAST(ipsec_ah_t, (buffer + sizeof (struct iphdr)));
+			struct iphdr iph = *ip;
 
 			if (new_saddr)
 				ah->spi = new_saddr;
 
-			if (!addr) {
-				/* Processing sequence number.
-				   Cycled assumed if 0xFFFFFFFD reached. So the MASTER state is free for another srv.
-				   Here can result a flapping MASTER state owner when max seq_number value reached.
-				   => We REALLY REALLY REALLY don't need to worry about this. We only use authentication
-				   for VRRPv2, for which the adver_int is specified in whole seconds, therefore the minimum
-				   adver_int is 1 second. 2^32-3 seconds is 4294967293 seconds, or in excess of 136 years,
-				   so since the sequence number always starts from 0, we are not going to reach the limit.
-				   In the current implementation if counter has cycled, we stop sending adverts and
-				   become BACKUP. We are ever the optimist and think we might run continuously for over
-				   136 years without someone redesigning their network!
-				   If all the master are down we reset the counter for becoming MASTER.
-				 */
-				if (vrrp->ipsecah_counter.seq_number > 0xFFFFFFFD) {
-					vrrp->ipsecah_counter.cycle = true;
-				} else {
-					vrrp->ipsecah_counter.seq_number++;
-				}
+			ah->seq_number = htonl(vrrp->ipsecah_counter.seq_number);
 
-				ah->seq_number = htonl(vrrp->ipsecah_counter.seq_number);
-			}
+			/* zero the ip mutable fields */
+			iph.tos = 0;
+			iph.frag_off = 0;
+			if (__test_bit(VRRP_FLAG_UNICAST, &vrrp->flags))
+				iph.ttl = 0;
+			/* Compute the ICV & trunc the digest to 96bits
+			   => No padding needed.
+			   -- rfc2402.3.3.3.1.1.1 & rfc2401.5
+			 */
+			memset(&ah->auth_data, 0, sizeof(ah->auth_data));
+			hmac_md5(PTR_CAST_CONST(unsigned char, &iph), sizeof iph, PTR_CAST_CONST(unsigned char, ah),
+				 vrrp->send_buffer_size - sizeof(struct iphdr), vrrp->auth_data,
+				 sizeof(vrrp->auth_data), digest);
+			memcpy(ah->auth_data, digest, HMAC_MD5_TRUNC);
+		}
+#endif
+	}
+}
 
-			if (final_update) {
-				struct iphdr iph = *ip;
-
-				/* zero the ip mutable fields */
-				iph.tos = 0;
-				iph.frag_off = 0;
-				if (__test_bit(VRRP_FLAG_UNICAST, &vrrp->flags))
-					iph.ttl = 0;
-				/* Compute the ICV & trunc the digest to 96bits
-				   => No padding needed.
-				   -- rfc2402.3.3.3.1.1.1 & rfc2401.5
-				 */
-				memset(&ah->auth_data, 0, sizeof(ah->auth_data));
-				hmac_md5(PTR_CAST_CONST(unsigned char, &iph), sizeof iph, PTR_CAST_CONST(unsigned char, ah),
-					 vrrp->send_buffer_size - sizeof(struct iphdr), vrrp->auth_data,
-					 sizeof(vrrp->auth_data), digest);
-				memcpy(ah->auth_data, digest, HMAC_MD5_TRUNC);
+/* Update the advert(s) ready for sending. IPv4 unicast peers each have
+ * their own copy of the packet with the destination address (and VRRPv3
+ * checksum) already set, so only the fields that change between adverts
+ * are updated, using incremental checksum updates. */
+static void
+vrrp_update_pkt(vrrp_t *vrrp, uint8_t prio)
+{
+	unicast_peer_t *peer;
+
+	if (vrrp->family == AF_INET) {
+		/* kernel will fill in ID if left to 0, so we overflow to 1 */
+		if (!++vrrp->ip_id)
+			++vrrp->ip_id;
+
+#ifdef _WITH_VRRP_AUTH_
+		if (vrrp->auth_type == VRRP_AUTH_AH) {
+			/* Processing sequence number.
+			   Cycled assumed if 0xFFFFFFFD reached. So the MASTER state is free for another srv.
+			   Here can result a flapping MASTER state owner when max seq_number value reached.
+			   => We REALLY REALLY REALLY don't need to worry about this. We only use authentication
+			   for VRRPv2, for which the adver_int is specified in whole seconds, therefore the minimum
+			   adver_int is 1 second. 2^32-3 seconds is 4294967293 seconds, or in excess of 136 years,
+			   so since the sequence number always starts from 0, we are not going to reach the limit.
+			   In the current implementation if counter has cycled, we stop sending adverts and
+			   become BACKUP. We are ever the optimist and think we might run continuously for over
+			   136 years without someone redesigning their network!
+			   If all the master are down we reset the counter for becoming MASTER.
+			 */
+			if (vrrp->ipsecah_counter.seq_number > 0xFFFFFFFD) {
+				vrrp->ipsecah_counter.cycle = true;
+			} else {
+				vrrp->ipsecah_counter.seq_number++;
 			}
 		}
 #endif
+
+		if (__test_bit(VRRP_FLAG_UNICAST, &vrrp->flags)) {
+			list_for_each_entry(peer, &vrrp->unicast_peer, e_list)
+				vrrp_update_buf(vrrp, peer->send_buffer, prio);
+			return;
+		}
 	}
+
+	vrrp_update_buf(vrrp, vrrp->send_buffer, prio);
 }
 
 #ifdef _WITH_UNICAST_CHKSUM_COMPAT_
 static void
 vrrp_csum_mcast(vrrp_t *vrrp)
 {
-	char *bufptr = vrrp->send_buffer;
+	unicast_peer_t *peer;
+	struct iphdr *ip;
 	vrrphdr_t *hd;
 
-	bufptr += sizeof(struct iphdr);
-
-#ifdef _WITH_VRRP_AUTH_
-	if (vrrp->auth_type == VRRP_AUTH_AH)
-		bufptr += sizeof(ipsec_ah_t);
-#endif
-
-	hd = PTR_CAST(vrrphdr_t, bufptr);
+	list_for_each_entry(peer, &vrrp->unicast_peer, e_list) {
+		ip = PTR_CAST(struct iphdr, peer->send_buffer);
+		hd = vrrp_pkt_hdr(vrrp, peer->send_buffer);
 
-	struct iphdr *ip = PTR_CAST(struct iphdr, (vrrp->send_buffer));
-	if (vrrp->unicast_chksum_compat == CHKSUM_COMPATIBILITY_AUTO &&
-	    ip->daddr != global_data->vrrp_mcast_group4.sin_addr.s_addr) {
-		/* The checksum is calculated using the standard multicast address */
-		hd->chksum = csum_incremental_update32(hd->chksum, ip->daddr, global_data->vrrp_mcast_group4.sin_addr.s_addr);
+		if (ip->daddr != global_data->vrrp_mcast_group4.sin_addr.s_addr) {
+			/* The checksum is calculated using the standard multicast address */
+			hd->chksum = csum_incremental_update32(hd->chksum, ip->daddr, global_data->vrrp_mcast_group4.sin_addr.s_addr);
+		}
 	}
 }
 #endif
@@ -622,8 +632,9 @@ vrrp_in_chk_vips(const vrrp_t *vrrp, const ip_address_t *ipaddress, const unsign
 static void
 check_tx_checksum(vrrp_t *vrrp, unicast_peer_t *peer)
 {
-	struct iphdr *ip = PTR_CAST(struct iphdr, vrrp->send_buffer);
-	vrrphdr_t *hd = PTR_CAST(vrrphdr_t, ((char *)vrrp->send_buffer + sizeof(struct iphdr)));
+	char *buffer = (peer && peer->send_buffer) ? peer->send_buffer : vrrp->send_buffer;
+	struct iphdr *ip = PTR_CAST(struct iphdr, buffer);
+	vrrphdr_t *hd = PTR_CAST(vrrphdr_t, (buffer + sizeof(struct iphdr)));
 	size_t vrrppkt_len;
 	uint32_t acc_csum;
 	ipv4_phdr_t ipv4_phdr;
@@ -692,7 +703,7 @@ check_tx_checksum(vrrp_t *vrrp, unicast_peer_t *peer)
 
 		if (vrrp->version == VRRP_VERSION_3)
 			log_buffer("IPv4 pseudo header", &ipv4_phdr, sizeof ipv4_phdr);
-		log_buffer("Advert packet", vrrp->send_buffer, vrrp->send_buffer_size);
+		log_buffer("Advert packet", buffer, vrrp->send_buffer_size);
 
 		chk->sent_to = true;
 		chk->last_tx_checksum = acc_csum;
@@ -1348,10 +1359,34 @@ vrrp_build_vrrp(vrrp_t *vrrp, char *buffer, struct iphdr *ip_hdr)
 		vrrp_build_vrrp_v2(vrrp, buffer);
 }
 
+/* Build the advert for a unicast peer from the instance's advert */
+static void
+vrrp_build_peer_pkt(vrrp_t *vrrp, unicast_peer_t *peer)
+{
+	struct iphdr *ip = PTR_CAST(struct iphdr, peer->send_buffer);
+	vrrphdr_t *hd = vrrp_pkt_hdr(vrrp, peer->send_buffer);
+	uint32_t new_daddr = inet_sockaddrip4(&peer->address);
+
+	memcpy(peer->send_buffer, vrrp->send_buffer, vrrp->send_buffer_size);
+
+	if (ip->daddr == new_daddr)
+		return;
+
+	/* The VRRPv3 checksum includes the destination address in the pseudo header */
+	if (vrrp->version == VRRP_VERSION_3
+#ifdef _WITH_UNICAST_CHKSUM_COMPAT_
+	    && vrrp->unicast_chksum_compat < CHKSUM_COMPATIBILITY_MIN_COMPAT
+#endif
+									     )
+		hd->chksum = csum_incremental_update32(hd->chksum, ip->daddr, new_daddr);
+	ip->daddr = new_daddr;
+}
+
 /* build VRRP packet */
 static void
 vrrp_build_pkt(vrrp_t * vrrp)
 {
+	unicast_peer_t *peer;
 	char *bufptr;
 
 	if (vrrp->family == AF_INET) {
@@ -1375,12 +1410,17 @@ vrrp_build_pkt(vrrp_t * vrrp)
 		if (vrrp->auth_type == VRRP_AUTH_AH)
 			vrrp_build_ipsecah(vrrp, vrrp->send_buffer, vrrp->send_buffer_size);
 #endif
+
+		if (__test_bit(VRRP_FLAG_UNICAST, &vrrp->flags)) {
+			list_for_each_entry(peer, &vrrp->unicast_peer, e_list)
+				vrrp_build_peer_pkt(vrrp, peer);
+		}
 	}
 	else if (vrrp->family == AF_INET6)
 		vrrp_build_vrrp(vrrp, vrrp->send_buffer, NULL);
 }
 
-/* send VRRP packet */
+/* build IPv6 ancillary data */
 static int
 vrrp_build_ancillary_data(struct msghdr *msg, char *cbuf, sockaddr_t *src, const vrrp_t *vrrp)
 {
@@ -1430,58 +1470,147 @@ vrrp_build_ancillary_data(struct msghdr *msg, char *cbuf, sockaddr_t *src, const
 	return 0;
 }
 
-static ssize_t
-vrrp_send_pkt(vrrp_t * vrrp, unicast_peer_t *peer)
+/* Send all the queued adverts */
+static void
+vrrp_tx_flush(void)
+{
+	unsigned sent = 0;
+	int ret;
+	vrrp_tx_msg_t *tx;
+
+	while (sent < vrrp_tx_num) {
+		ret = sendmmsg(vrrp_tx_fd, &vrrp_tx_mmsg[sent], vrrp_tx_num - sent, vrrp_tx_flags);
+		if (ret > 0) {
+			sent += (unsigned)ret;
+			continue;
+		}
+
+		/* The first unsent message failed. Don't log an error if it is a
+		 * prio 0 message and the interface is down. */
+		tx = &vrrp_tx_msg[sent];
+		if (tx->prio != VRRP_PRIO_STOP || errno != ENETUNREACH || (tx->vrrp->ifp && IF_FLAGS_UP(tx->vrrp->ifp))) {
+			if (tx->peer)
+				log_message(LOG_INFO, "(%s) Cant send advert to %s (%m)"
+						    , tx->vrrp->iname, inet_sockaddrtos(&tx->peer->address));
+			else
+				log_message(LOG_INFO, "(%s): send advert error %d (%m)", tx->vrrp->iname, errno);
+		}
+		sent++;
+	}
+
+	vrrp_tx_num = 0;
+}
+
+/* Is an advert for the instance waiting to be sent? */
+static bool __attribute__ ((pure))
+vrrp_tx_pending(const vrrp_t *vrrp)
+{
+	unsigned i;
+
+	for (i = 0; i < vrrp_tx_num; i++) {
+		if (vrrp_tx_msg[i].vrrp == vrrp)
+			return true;
+	}
+
+	return false;
+}
+
+/* Queue VRRP packet for sending */
+static void
+vrrp_queue_pkt(vrrp_t *vrrp, unicast_peer_t *peer, uint8_t prio)
 {
 	sockaddr_t *src = &vrrp->saddr;
-	struct msghdr msg;
-	struct iovec iov;
-	char cbuf[256] __attribute__((aligned(__alignof__(struct cmsghdr))));
+	struct msghdr *msg;
+	struct iovec *iov;
+	vrrp_tx_msg_t *tx;
+	int flags = (peer) ? 0 : MSG_DONTROUTE;
+
+	if (vrrp_tx_num &&
+	    (vrrp_tx_num == VRRP_SEND_BATCH ||
+	     vrrp_tx_fd != vrrp->sockets->fd_out ||
+	     vrrp_tx_flags != flags))
+		vrrp_tx_flush();
+
+	vrrp_tx_fd = vrrp->sockets->fd_out;
+	vrrp_tx_flags = flags;
+
+	tx = &vrrp_tx_msg[vrrp_tx_num];
+	msg = &vrrp_tx_mmsg[vrrp_tx_num].msg_hdr;
+	iov = &vrrp_tx_iov[vrrp_tx_num];
+	vrrp_tx_num++;
+
+	tx->vrrp = vrrp;
+	tx->peer = peer;
+	tx->prio = prio;
 
 	/* Build the message data */
-	memset(&msg, 0, sizeof(msg));
-	msg.msg_iov = &iov;
-	msg.msg_iovlen = 1;
-	iov.iov_base = vrrp->send_buffer;
-	iov.iov_len = vrrp->send_buffer_size;
+	memset(msg, 0, sizeof(*msg));
+	msg->msg_iov = iov;
+	msg->msg_iovlen = 1;
+	iov->iov_base = (peer && peer->send_buffer) ? peer->send_buffer : vrrp->send_buffer;
+	iov->iov_len = vrrp->send_buffer_size;
 
 	/* glibc's CMSG_NXTHDR requires the buffer to have been initialised to all 0s */
 	if (vrrp->family == AF_INET6)
-		memset(cbuf, 0, sizeof(cbuf));
+		memset(tx->cbuf, 0, sizeof(tx->cbuf));
 
 	/* Unicast sending path */
 	if (peer && peer->address.ss_family == AF_INET) {
-		msg.msg_name = &peer->address;
-		msg.msg_namelen = sizeof(struct sockaddr_in);
+		msg->msg_name = &peer->address;
+		msg->msg_namelen = sizeof(struct sockaddr_in);
 	} else if (peer && peer->address.ss_family == AF_INET6) {
-		msg.msg_name = &peer->address;
-		msg.msg_namelen = sizeof(struct sockaddr_in6);
-		vrrp_build_ancillary_data(&msg, cbuf, src, vrrp);
+		msg->msg_name = &peer->address;
+		msg->msg_namelen = sizeof(struct sockaddr_in6);
+		vrrp_build_ancillary_data(msg, tx->cbuf, src, vrrp);
 	} else if (vrrp->family == AF_INET) { /* Multicast sending path */
-		msg.msg_name = &vrrp->mcast_daddr;
-		msg.msg_namelen = sizeof(struct sockaddr_in);
+		msg->msg_name = &vrrp->mcast_daddr;
+		msg->msg_namelen = sizeof(struct sockaddr_in);
 	} else if (vrrp->family == AF_INET6) {
-		msg.msg_name = &vrrp->mcast_daddr;
-		msg.msg_namelen = sizeof(struct sockaddr_in6);
-		vrrp_build_ancillary_data(&msg, cbuf, src, vrrp);
+		msg->msg_name = &vrrp->mcast_daddr;
+		msg->msg_namelen = sizeof(struct sockaddr_in6);
+		vrrp_build_ancillary_data(msg, tx->cbuf, src, vrrp);
 	}
 
 #ifdef _CHECKSUM_DEBUG_
 	if (vrrp->family == AF_INET && do_checksum_debug)
 		check_tx_checksum(vrrp, peer);
 #endif
+}
 
-	/* Send the packet */
-	return sendmsg(vrrp->sockets->fd_out, &msg, (peer) ? 0 : MSG_DONTROUTE);
+/* Adverts sent between vrrp_tx_batch_start() and vrrp_tx_batch_end()
+ * are sent together when vrrp_tx_batch_end() is called. */
+void
+vrrp_tx_batch_start(void)
+{
+	vrrp_tx_batch_depth++;
+}
+
+void
+vrrp_tx_batch_end(void)
+{
+	if (vrrp_tx_batch_depth && --vrrp_tx_batch_depth)
+		return;
+
+	if (vrrp_tx_num)
+		vrrp_tx_flush();
 }
 
 /* Allocate the sending buffer */
 static void
 vrrp_alloc_send_buffer(vrrp_t * vrrp)
 {
+	unicast_peer_t *peer;
+
 	vrrp->send_buffer_size = vrrp_adv_len(vrrp);
 
 	vrrp->send_buffer = MALLOC(vrrp->send_buffer_size);
+
+	/* IPv4 unicast adverts differ by destination address, so each
+	 * peer has its own prebuilt copy of the packet. */
+	if (vrrp->family == AF_INET && __test_bit(VRRP_FLAG_UNICAST, &vrrp->flags)) {
+		list_for_each_entry(peer, &vrrp->unicast_peer, e_list)
+			peer->send_buffer = MALLOC(vrrp->send_buffer_size);
+	}
 }
 
 /* send VRRP advertisement */
@@ -1506,28 +1635,28 @@ vrrp_send_adv(vrrp_t * vrrp, uint8_t prio)
 	}
 #endif
 
-	/* build the packet */
-	vrrp_update_pkt(vrrp, prio, NULL);
+	/* The send buffer is about to be updated, so any advert already
+	 * queued for this instance must be sent first */
+	if (vrrp_tx_pending(vrrp))
+		vrrp_tx_flush();
 
-	/* Send the packet, but don't log an error if it is a prio 0 message
-	 * and the interface is down. */
+	/* update the packet(s) */
+	vrrp_update_pkt(vrrp, prio);
+
+	/* Queue the packet(s) */
 	if (!__test_bit(VRRP_FLAG_UNICAST, &vrrp->flags)) {
 // What if mcast_src_ip is configured?
-		if (vrrp_send_pkt(vrrp, NULL) == -1 &&
-		    (prio != VRRP_PRIO_STOP || errno != ENETUNREACH || (vrrp->ifp && IF_FLAGS_UP(vrrp->ifp))))
-			log_message(LOG_INFO, "(%s): send advert error %d (%m)", vrrp->iname, errno);
+		vrrp_queue_pkt(vrrp, NULL, prio);
 	}
 	else {
-		list_for_each_entry(peer, &vrrp->unicast_peer, e_list) {
-			if (vrrp->family == AF_INET)
-				vrrp_update_pkt(vrrp, prio, &peer->address);
-			if (vrrp_send_pkt(vrrp, peer) == -1 &&
-			    (prio != VRRP_PRIO_STOP || errno != ENETUNREACH || (vrrp->ifp && IF_FLAGS_UP(vrrp->ifp))))
-				log_message(LOG_INFO, "(%s) Cant send advert to %s (%m)"
-						    , vrrp->iname, inet_sockaddrtos(&peer->address));
-		}
+		list_for_each_entry(peer, &vrrp->unicast_peer, e_list)
+			vrrp_queue_pkt(vrrp, peer, prio);
 	}
 
+	/* If not batching adverts, send them now */
+	if (!vrrp_tx_batch_depth)
+		vrrp_tx_flush();
+
 	++vrrp->stats->advert_sent;
 }
 
@@ -2009,6 +2138,10 @@ vrrp_state_master_tx(vrrp_t * vrrp)
 	vrrp_send_adv(vrrp, vrrp->effective_priority);
 
 	if (!VRRP_VIP_ISSET(vrrp)) {
+		/* Don't let batching delay the advert until after the GARPs */
+		if (vrrp_tx_num)
+			vrrp_tx_flush();
+
 		log_message(LOG_INFO, "(%s) Entering MASTER STATE"
 				    , vrrp->iname);
 		vrrp_state_become_master(vrrp);
@@ -2665,6 +2798,7 @@ shutdown_vrrp_instances(void)
 					netlink_link_del_vmac(&addr_vrrp);
 
 					vip->ifp->ifindex = 0;		/* We are no longer running the kernel_netlink_monitor */
+					if_update_hash(vip->ifp);
 				}
 			}
 #endif
@@ -3602,6 +3736,7 @@ vrrp_complete_instance(vrrp_t * vrrp)
 						ifp->hw_addr[4] = vrrp->family == AF_INET ?  0x01 : 0x02;
 						ifp->hw_addr[5] = vrrp->vrid;
 					}
+					if_update_hash(ifp);
 					vrrp->ifp = ifp;
 				}
 			}
@@ -3745,6 +3880,7 @@ vrrp_complete_instance(vrrp_t * vrrp)
 							ifp->hw_addr[4] = ip_addr->ifa.ifa_family == AF_INET ?  0x01 : 0x02;
 							ifp->hw_addr[5] = vrrp->vrid;
 						}
+						if_update_hash(ifp);
 					}
 
 					if (!ip_addr->dont_track)
@@ -4753,13 +4889,7 @@ vrrp_complete_init(void)
 #ifdef _WITH_LVS_
 	/* Set up the lvs_syncd vrrp */
 	if (global_data->lvs_syncd.vrrp_name) {
-		list_for_each_entry(vrrp, &vrrp_data->vrrp, e_list) {
-			if (!strcmp(global_data->lvs_syncd.vrrp_name, vrrp->iname)) {
-				global_data->lvs_syncd.vrrp = vrrp;
-
-				break;
-			}
-		}
+		global_data->lvs_syncd.vrrp = vrrp_get_instance(global_data->lvs_syncd.vrrp_name);
 
 		if (!global_data->lvs_syncd.vrrp) {
 			report_config_error(CONFIG_GENERAL_ERROR, "Unable to find vrrp instance %s"
@@ -5081,13 +5211,9 @@ set_previous_sync_group_states(void)
 	vrrp_sgroup_t *ogroup, *ngroup;
 
 	list_for_each_entry(ngroup, &vrrp_data->vrrp_sync_group, e_list) {
-		list_for_each_entry(ogroup, &old_vrrp_data->vrrp_sync_group, e_list) {
-			if (!strcmp(ngroup->gname, ogroup->gname)) {
-				if (ngroup->state == ogroup->state)
-					ngroup->state_same_at_reload = true;
-				break;
-			}
-		}
+		ogroup = name_hash_find_entry(&old_vrrp_data->vrrp_sync_group_by_name, ngroup->gname, vrrp_sgroup_t, e_name);
+		if (ogroup && ngroup->state == ogroup->state)
+			ngroup->state_same_at_reload = true;
 	}
 }
 
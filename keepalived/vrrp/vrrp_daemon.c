@@ -36,6 +36,7 @@
 #include "snmp.h"
 #endif
 #include "scheduler.h"
+#include "notify.h"
 #include "smtp.h"
 #include "vrrp_track.h"
 #endif
@@ -58,6 +59,7 @@
 #include "bitops.h"
 #include "rttables.h"
 #if defined _WITH_SNMP_RFC_ || defined _WITH_SNMP_VRRP_
+  #include "snmp.h"
   #include "vrrp_snmp.h"
 #endif
 #ifdef _WITH_DBUS_
@@ -71,6 +73,7 @@
 #include "track_file.h"
 #ifdef _WITH_JSON_
 #include "vrrp_json.h"
+#include "json_socket.h"
 #endif
 #ifdef _WITH_BFD_
 #include "bfd_daemon.h"
@@ -299,6 +302,10 @@ vrrp_terminate_phase2(int exit_status)
 	firewall_fini();
 #endif
 
+#ifdef _WITH_JSON_
+	vrrp_json_socket_close();
+#endif
+
 	kernel_netlink_close_cmd();
 	thread_destroy_master(master);
 	master = NULL;
@@ -558,6 +565,9 @@ start_vrrp(data_t *prev_global_data)
 				snmp_epoll_info(master);
 			else
 				vrrp_snmp_agent_init(global_data->snmp_socket);
+
+			/* The table indices refer to the previous configuration */
+			snmp_index_invalidate();
 #ifdef _WITH_SNMP_RFC_
 			snmp_vrrp_start_time = time_now;
 #endif
@@ -605,6 +615,10 @@ start_vrrp(data_t *prev_global_data)
 		/* Init & start the VRRP packet dispatcher */
 		thread_add_event(master, vrrp_dispatcher_init, NULL, 0);
 
+#ifdef _WITH_JSON_
+		vrrp_json_socket_open();
+#endif
+
 		if (!reload && global_data->vrrp_startup_delay) {
 			vrrp_delayed_start_time = timer_add_long(time_now, global_data->vrrp_startup_delay);
 			thread_add_timer(master, delayed_start_clear_thread, NULL, global_data->vrrp_startup_delay);
@@ -839,6 +853,9 @@ reload_vrrp_thread(__attribute__((unused)) thread_ref_t thread)
 	cancel_vrrp_threads();
 #endif
 	cancel_kernel_netlink_threads();
+#ifdef _WITH_JSON_
+	vrrp_json_socket_close();
+#endif
 	thread_cleanup_master(master, true);
 	thread_add_base_threads(master, with_snmp);
 
@@ -966,6 +983,9 @@ register_vrrp_thread_addresses(void)
 	register_vrrp_dbus_addresses();
 #endif
 	register_vrrp_fifo_addresses();
+#ifdef _WITH_JSON_
+	register_json_socket_addresses();
+#endif
 	register_track_file_inotify_addresses();
 #ifdef _WITH_TRACK_PROCESS_
 	register_process_monitor_addresses();
@@ -1051,12 +1071,9 @@ start_vrrp_child(void)
 #endif
 
 #ifdef _WITH_BFD_
-	/* Close the write end of the BFD vrrp event notification pipe */
-	close(bfd_vrrp_event_pipe[1]);
-
 #ifdef _WITH_LVS_
-	close(bfd_checker_event_pipe[0]);
-	close(bfd_checker_event_pipe[1]);
+	/* Close the BFD checker event ring */
+	bfd_event_chan_close(&bfd_checker_event_chan);
 #endif
 #endif
 
@@ -1109,6 +1126,9 @@ start_vrrp_child(void)
 	/* Create the new master thread */
 	thread_destroy_master(master);	/* This destroys any residual settings from the parent */
 	master = thread_make_master();
+
+	/* Start the helper that runs scripts before our memory usage grows */
+	script_helper_start();
 #endif
 
 	/* If last process died during a reload, we can get there and we
@@ -150,6 +150,7 @@ void
 free_sync_group(vrrp_sgroup_t *sgroup)
 {
 	list_del_init(&sgroup->e_list);
+	name_hash_del(&sgroup->e_name);
 	if (sgroup->iname) {
 		/* If we are terminating at init time, sgroup->vrrp_instances may not be initialised
 		 * yet, or it may have only one member, in which case sgroup->iname will still be set */
@@ -273,6 +274,7 @@ void
 free_vscript(vrrp_script_t *vscript)
 {
 	list_del_init(&vscript->e_list);
+	name_hash_del(&vscript->e_name);
 	free_tracking_obj_list(&vscript->tracking_vrrp);
 	FREE_CONST(vscript->sname);
 	FREE_PTR(vscript->script.args);
@@ -336,6 +338,7 @@ void
 free_vprocess(vrrp_tracked_process_t *vprocess)
 {
 	list_del_init(&vprocess->e_list);
+	name_hash_del(&vprocess->e_name);
 	free_tracking_obj_list(&vprocess->tracking_vrrp);
 	FREE_CONST(vprocess->pname);
 	FREE_CONST(vprocess->process_path);
@@ -402,6 +405,7 @@ void
 free_vrrp_tracked_bfd(vrrp_tracked_bfd_t *vbfd)
 {
 	list_del_init(&vbfd->e_list);
+	name_hash_del(&vbfd->e_name);
 	free_tracking_obj_list(&vbfd->tracking_vrrp);
 	FREE(vbfd);
 }
@@ -508,6 +512,7 @@ static void
 free_unicast_peer(unicast_peer_t *peer)
 {
 	list_del_init(&peer->e_list);
+	FREE_PTR(peer->send_buffer);
 	FREE(peer);
 }
 static void
@@ -542,6 +547,7 @@ dump_unicast_peer_list(FILE *fp, const list_head_t *l)
 static void
 free_vrrp(vrrp_t *vrrp)
 {
+	name_hash_del(&vrrp->e_name);
 	FREE_CONST(vrrp->iname);
 #ifdef _HAVE_VRRP_IPVLAN_
 	FREE_PTR(vrrp->ipvlan_addr);
@@ -1184,6 +1190,7 @@ alloc_vrrp_process(const char *pname)
 #endif
 
 /* data facility functions */
+/* The buffer holds VRRP_RECV_BATCH packets each of length vrrp_buffer_len */
 void
 alloc_vrrp_buffer(size_t len)
 {
@@ -1193,7 +1200,7 @@ alloc_vrrp_buffer(size_t len)
 	if (vrrp_buffer)
 		FREE(vrrp_buffer);
 
-	vrrp_buffer = MALLOC(len);
+	vrrp_buffer = MALLOC(len * VRRP_RECV_BATCH);
 	vrrp_buffer_len = (vrrp_buffer) ? len : 0;
 }
 
@@ -1242,16 +1249,22 @@ free_vrrp_data(vrrp_data_t * data)
 	free_iproute_list(&data->static_routes);
 	free_iprule_list(&data->static_rules);
 	free_static_track_groups_list(&data->static_track_groups);
+	name_hash_free(&data->static_track_group_by_name);
 	free_sync_group_list(&data->vrrp_sync_group);
+	name_hash_free(&data->vrrp_sync_group_by_name);
 	free_vscript_list(&data->vrrp_script);
+	name_hash_free(&data->vrrp_script_by_name);
 	free_track_file_list(&data->vrrp_track_files);
 #ifdef _WITH_TRACK_PROCESS_
 	free_vprocess_list(&data->vrrp_track_processes);
+	name_hash_free(&data->vrrp_track_process_by_name);
 #endif
 #ifdef _WITH_BFD_
 	free_vrrp_tracked_bfd_list(&data->vrrp_track_bfds);
+	name_hash_free(&data->vrrp_track_bfd_by_name);
 #endif
 	free_vrrp_list(&data->vrrp);
+	name_hash_free(&data->vrrp_by_name);
 	FREE(data);
 }
 
@@ -73,6 +73,16 @@
 
 /* Local vars */
 static LIST_HEAD_INITIALIZE(if_queue);
+
+/* Hash tables for looking up interfaces, maintained by if_update_hash() */
+#define IF_HASH_BITS	10
+#define IF_HASH_SIZE	(1U << IF_HASH_BITS)
+#define IF_HASH_MASK	(IF_HASH_SIZE - 1)
+static hlist_head_t if_hash_ifindex[IF_HASH_SIZE];
+static hlist_head_t if_hash_name[IF_HASH_SIZE];
+#ifdef _HAVE_VRRP_VMAC_
+static hlist_head_t if_hash_hw_addr[IF_HASH_SIZE];
+#endif
 #ifdef _WITH_LINKBEAT_
 static struct ifreq ifr;
 static int linkbeat_fd = -1;
@@ -84,12 +94,60 @@ static LIST_HEAD_INITIALIZE(old_garp_delay);
 LIST_HEAD_INITIALIZE(garp_delay);
 
 /* Helper functions */
+static inline unsigned __attribute__ ((const))
+if_hashkey_ifindex(ifindex_t ifindex)
+{
+	return ifindex & IF_HASH_MASK;
+}
+
+static unsigned __attribute__ ((pure))
+if_hashkey_name(const char *ifname)
+{
+	uint32_t key = 0;
+
+	while (*ifname)
+		key = key * 31 + (unsigned char)*ifname++;
+
+	return (key ^ key >> IF_HASH_BITS) & IF_HASH_MASK;
+}
+
+#ifdef _HAVE_VRRP_VMAC_
+static unsigned __attribute__ ((pure))
+if_hashkey_hw_addr(const u_char hw_addr[ETH_ALEN])
+{
+	uint32_t key = 0;
+	unsigned i;
+
+	for (i = 0; i < ETH_ALEN; i++)
+		key = key * 31 + hw_addr[i];
+
+	return (key ^ key >> IF_HASH_BITS) & IF_HASH_MASK;
+}
+#endif
+
+/* This must be called whenever the ifindex, name or MAC address of an interface changes */
+void
+if_update_hash(interface_t *ifp)
+{
+	hlist_del_init(&ifp->e_hash_ifindex);
+	hlist_add_head(&ifp->e_hash_ifindex, &if_hash_ifindex[if_hashkey_ifindex(ifp->ifindex)]);
+
+	hlist_del_init(&ifp->e_hash_name);
+	hlist_add_head(&ifp->e_hash_name, &if_hash_name[if_hashkey_name(ifp->ifname)]);
+
+#ifdef _HAVE_VRRP_VMAC_
+	hlist_del_init(&ifp->e_hash_hw_addr);
+	hlist_add_head(&ifp->e_hash_hw_addr, &if_hash_hw_addr[if_hashkey_hw_addr(ifp->hw_addr)]);
+#endif
+}
+
 interface_t * __attribute__ ((pure))
 if_get_by_ifindex(ifindex_t ifindex)
 {
 	interface_t *ifp;
+	hlist_node_t *pos;
 
-	list_for_each_entry(ifp, &if_queue, e_list) {
+	hlist_for_each_entry(ifp, pos, &if_hash_ifindex[if_hashkey_ifindex(ifindex)], e_hash_ifindex) {
 		if (ifp->ifindex == ifindex)
 			return ifp;
 	}
@@ -102,24 +160,21 @@ interface_t * __attribute__ ((pure))
 if_get_by_vmac(uint8_t vrid, int family, const interface_t *base_ifp, const u_char hw_addr[ETH_ALEN])
 {
 	interface_t *ifp;
+	hlist_node_t *pos;
+	u_char vrrp_hw_addr[ETH_ALEN] = { 0x00, 0x00, 0x5e, 0x00, 0x00, vrid };
 
-	list_for_each_entry(ifp, &if_queue, e_list) {
+	if (!hw_addr) {
+		vrrp_hw_addr[4] = family == AF_INET ? 0x01 : 0x02;
+		hw_addr = vrrp_hw_addr;
+	}
+
+	hlist_for_each_entry(ifp, pos, &if_hash_hw_addr[if_hashkey_hw_addr(hw_addr)], e_hash_hw_addr) {
 		if (ifp->if_type != IF_TYPE_MACVLAN || ifp->vmac_type !=  MACVLAN_MODE_PRIVATE)
 			continue;
 		if (ifp->base_ifp != base_ifp)
 			continue;
-		if (hw_addr) {
-		       if (memcmp(ifp->hw_addr, hw_addr, ETH_ALEN))
-			       continue;
-		} else {
-			if (ifp->hw_addr[0] || ifp->hw_addr[1] || ifp->hw_addr[2] != 0x5e || ifp->hw_addr[3])
-				continue;
-			if ((family == AF_INET && ifp->hw_addr[4] != 0x01) ||
-			    (family == AF_INET6 && ifp->hw_addr[4] != 0x02))
-				continue;
-			if (ifp->hw_addr[5] != vrid)
-				continue;
-		}
+		if (memcmp(ifp->hw_addr, hw_addr, ETH_ALEN))
+			continue;
 
 		ifp->is_ours = true;
 
@@ -194,8 +249,9 @@ interface_t *
 if_get_by_ifname(const char *ifname, if_lookup_t create)
 {
 	interface_t *ifp;
+	hlist_node_t *pos;
 
-	list_for_each_entry(ifp, &if_queue, e_list) {
+	hlist_for_each_entry(ifp, pos, &if_hash_name[if_hashkey_name(ifname)], e_hash_name) {
 		if (!strcmp(ifp->ifname, ifname))
 			return create == IF_CREATE_NOT_EXIST ? NULL : ifp;
 	}
@@ -220,6 +276,7 @@ if_get_by_ifname(const char *ifname, if_lookup_t create)
 	INIT_LIST_HEAD(&ifp->tracking_vrrp);
 	INIT_LIST_HEAD(&ifp->e_list);
 	list_add_tail(&ifp->e_list, &if_queue);
+	if_update_hash(ifp);
 
 	if (create == IF_CREATE_IF_DYNAMIC)
 		log_message(LOG_INFO, "Configuration specifies interface %s which doesn't currently exist - will use if created", ifname);
@@ -515,6 +572,11 @@ free_if(interface_t *ifp)
 	free_tracking_obj_list(&ifp->tracking_vrrp);
 	if_extra_ipaddress_free_list(&ifp->sin_addr_l);
 	if_extra_ipaddress_free_list(&ifp->sin6_addr_l);
+	hlist_del_init(&ifp->e_hash_ifindex);
+	hlist_del_init(&ifp->e_hash_name);
+#ifdef _HAVE_VRRP_VMAC_
+	hlist_del_init(&ifp->e_hash_hw_addr);
+#endif
 	FREE(ifp);
 }
 
@@ -1475,6 +1537,7 @@ cleanup_lost_interface(interface_t *ifp)
 	interface_down(ifp);
 
 	ifp->ifindex = 0;
+	if_update_hash(ifp);
 	ifp->ifi_flags = 0;
 	ifp->seen_up = false;
 #ifdef _HAVE_VRRP_VMAC_
@@ -108,9 +108,10 @@ compare_ipaddress(const ip_address_t *X, const ip_address_t *Y)
 	return X->u.sin.sin_addr.s_addr != Y->u.sin.sin_addr.s_addr;
 }
 
-/* Add/Delete IP address to a specific interface_t */
-int
-netlink_ipaddress(ip_address_t *ip_addr, int cmd)
+/* Add/Delete IP address to a specific interface_t. If batch is
+ * set, the request is queued on it rather than being sent. */
+static int
+netlink_ipaddress_batch(ip_address_t *ip_addr, int cmd, nl_batch_t *batch)
 {
 	struct ifa_cacheinfo cinfo;
 	int status = 1;
@@ -223,19 +224,29 @@ netlink_ipaddress(ip_address_t *ip_addr, int cmd)
 #endif
 													     ))
 		netlink_error_ignore = ENODEV;
-	if (netlink_talk(&nl_cmd, &req.n) < 0)
+	if (batch)
+		netlink_batch_add(batch, &req.n, ip_addr);
+	else if (netlink_talk(&nl_cmd, &req.n) < 0)
 		status = -1;
 	netlink_error_ignore = 0;
 
 	return status;
 }
 
+int
+netlink_ipaddress(ip_address_t *ip_addr, int cmd)
+{
+	return netlink_ipaddress_batch(ip_addr, cmd, NULL);
+}
+
 /* Add/Delete a list of IP addresses */
 bool
 netlink_iplist(list_head_t *ip_list, int cmd, bool force)
 {
 	ip_address_t *ip_addr;
 	bool changed_entries = false;
+	nl_batch_t batch = { .buf = NULL };
+	unsigned i;
 
 	/*
 	 * If "--dont-release-vrrp" is set then try to release addresses
@@ -250,15 +261,27 @@ netlink_iplist(list_head_t *ip_list, int cmd, bool force)
 			if (force)
 				netlink_error_ignore = ENODEV;
 
-			if (netlink_ipaddress(ip_addr, cmd) > 0) {
-				ip_addr->set = (cmd == IPADDRESS_ADD);
-				changed_entries = true;
-			}
-			else
+			/* The addresses are all sent together, and the results
+			 * processed below */
+			if (netlink_ipaddress_batch(ip_addr, cmd, &batch) <= 0)
 				ip_addr->set = false;
 		}
 	}
 
+	netlink_batch_send(&batch);
+
+	for (i = 0; i < batch.num; i++) {
+		ip_addr = batch.entries[i].obj;
+		if (!batch.entries[i].status) {
+			ip_addr->set = (cmd == IPADDRESS_ADD);
+			changed_entries = true;
+		}
+		else
+			ip_addr->set = false;
+	}
+
+	netlink_batch_free(&batch);
+
 	return changed_entries;
 }
 
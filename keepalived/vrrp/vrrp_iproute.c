@@ -289,12 +289,26 @@ add_nexthops(ip_route_t *route, struct nlmsghdr *nlh, struct rtmsg *rtm)
 		addattr_l(nlh, sizeof(buf), RTA_MULTIPATH, RTA_DATA(rta), RTA_PAYLOAD(rta));
 }
 
+/* Returns true if a failed route command should be treated as an error */
+static bool
+netlink_route_failed(__attribute__((unused)) const ip_route_t *iproute, __attribute__((unused)) int cmd)
+{
+#if HAVE_DECL_RTA_EXPIRES
+	/* If an expiry was set on the route, it may have disappeared already */
+	if (cmd == IPROUTE_DEL && (iproute->mask & IPROUTE_BIT_EXPIRES))
+		return false;
+#endif
+
+	return true;
+}
+
 /* Add/Delete IP route to/from a specific interface.
  * Note: By default we do not set the NLM_F_EXCL flag, and so the
  * equivalent ip route command to add a route is: ip route prepend ...
+ * If batch is set, the request is queued on it rather than being sent.
  */
 static bool
-netlink_route(ip_route_t *iproute, int cmd)
+netlink_route(ip_route_t *iproute, int cmd, nl_batch_t *batch)
 {
 	struct {
 		struct nlmsghdr n;
@@ -506,15 +520,15 @@ netlink_route(ip_route_t *iproute, int cmd)
 		log_message(LOG_INFO, "%.*", MAX_LOG_MSG, lbuf+j);
 #endif
 
+	if (batch) {
+		netlink_batch_add(batch, &req.n, iproute);
+		return false;
+	}
+
 	/* This returns ESRCH if the address of via address doesn't exist */
 	/* ENETDOWN if dev p33p1.40 for example is down */
-	if (netlink_talk(&nl_cmd, &req.n) < 0) {
-#if HAVE_DECL_RTA_EXPIRES
-		/* If an expiry was set on the route, it may have disappeared already */
-		if (cmd != IPROUTE_DEL || !(iproute->mask & IPROUTE_BIT_EXPIRES))
-#endif
-			return true;
-	}
+	if (netlink_talk(&nl_cmd, &req.n) < 0)
+		return netlink_route_failed(iproute, cmd);
 
 	return false;
 }
@@ -524,20 +538,31 @@ bool
 netlink_rtlist(list_head_t *rt_list, int cmd, bool force)
 {
 	ip_route_t *ip_route;
+	nl_batch_t batch = { .buf = NULL };
+	unsigned i;
 
 	/* No routes to add */
 	if (list_empty(rt_list))
 		return false;
 
+	/* The routes are all sent together, and the results processed below */
 	list_for_each_entry(ip_route, rt_list, e_list) {
-		if ((cmd == IPROUTE_DEL) == ip_route->set || force) {
-			if (!netlink_route(ip_route, cmd))
-				ip_route->set = (cmd == IPROUTE_ADD);
-			else if (cmd != IPROUTE_ADD)
-				ip_route->set = false;
-		}
+		if ((cmd == IPROUTE_DEL) == ip_route->set || force)
+			netlink_route(ip_route, cmd, &batch);
 	}
 
+	netlink_batch_send(&batch);
+
+	for (i = 0; i < batch.num; i++) {
+		ip_route = batch.entries[i].obj;
+		if (!batch.entries[i].status || !netlink_route_failed(ip_route, cmd))
+			ip_route->set = (cmd == IPROUTE_ADD);
+		else if (cmd != IPROUTE_ADD)
+			ip_route->set = false;
+	}
+
+	netlink_batch_free(&batch);
+
 	return true;
 }
 
@@ -2044,7 +2069,7 @@ clear_diff_routes(list_head_t *l, list_head_t *n)
 				if (__test_bit(LOG_DETAIL_BIT, &debug))
 					log_message(LOG_INFO, "Removing route %s"
 							    , ipaddresstos(NULL, route->dst));
-				netlink_route(route, IPROUTE_DEL);
+				netlink_route(route, IPROUTE_DEL, NULL);
 				continue;
 			}
 
@@ -2057,9 +2082,9 @@ clear_diff_routes(list_head_t *l, list_head_t *n)
 			 * it as not set, and then it will be added later when any new
 			 * routes are added. */
 			netlink_error_ignore = EINVAL;
-			if (netlink_route(new_route, IPROUTE_REPLACE)) {
+			if (netlink_route(new_route, IPROUTE_REPLACE, NULL)) {
 				netlink_error_ignore = 0;
-				netlink_route(route, IPROUTE_DEL);
+				netlink_route(route, IPROUTE_DEL, NULL);
 				new_route->set = false;
 			} else
 				netlink_error_ignore = 0;
@@ -2079,7 +2104,7 @@ reinstate_static_route(ip_route_t *route)
 {
 	char buf[256];
 
-	route->set = !netlink_route(route, IPROUTE_ADD);
+	route->set = !netlink_route(route, IPROUTE_ADD, NULL);
 
 	format_iproute(route, buf, sizeof(buf));
 	log_message(LOG_INFO, "Restoring deleted static route %s", buf);
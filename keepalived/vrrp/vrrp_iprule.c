@@ -141,9 +141,10 @@ inet_proto_a2n(const char *buf)
 }
 #endif
 
-/* Add/Delete IP rule to/from a specific IP/network */
+/* Add/Delete IP rule to/from a specific IP/network. If batch is
+ * set, the request is queued on it rather than being sent. */
 static int
-netlink_rule(ip_rule_t *iprule, int cmd)
+netlink_rule(ip_rule_t *iprule, int cmd, nl_batch_t *batch)
 {
 	int status = 1;
 	struct {
@@ -267,7 +268,9 @@ netlink_rule(ip_rule_t *iprule, int cmd)
 
 	req.frh.action = iprule->action;
 
-	if (netlink_talk(&nl_cmd, &req.n) < 0)
+	if (batch)
+		netlink_batch_add(batch, &req.n, iprule);
+	else if (netlink_talk(&nl_cmd, &req.n) < 0)
 		status = -1;
 
 	return status;
@@ -278,7 +281,7 @@ reinstate_static_rule(ip_rule_t *rule)
 {
 	char buf[256];
 
-	rule->set = (netlink_rule(rule, IPRULE_ADD) > 0);
+	rule->set = (netlink_rule(rule, IPRULE_ADD, NULL) > 0);
 
 	format_iprule(rule, buf, sizeof(buf));
 	log_message(LOG_INFO, "Restoring deleted static rule %s", buf);
@@ -288,6 +291,8 @@ void
 netlink_rulelist(list_head_t *l, int cmd, bool force)
 {
 	ip_rule_t *rule;
+	nl_batch_t batch = { .buf = NULL };
+	unsigned i;
 
 	/* No rules to add */
 	if (list_empty(l))
@@ -299,18 +304,24 @@ netlink_rulelist(list_head_t *l, int cmd, bool force)
 	if (force && cmd == IPRULE_DEL)
 		netlink_error_ignore = ENOENT;
 
+	/* The rules are all sent together, and the results processed below */
 	list_for_each_entry(rule, l, e_list) {
 		if (force ||
 		    (cmd == IPRULE_ADD && !rule->set) ||
-		    (cmd == IPRULE_DEL && rule->set)) {
-			if (netlink_rule(rule, cmd) > 0)
-				rule->set = (cmd == IPRULE_ADD);
-			else
-				rule->set = false;
-		}
+		    (cmd == IPRULE_DEL && rule->set))
+			netlink_rule(rule, cmd, &batch);
 	}
 
 	netlink_error_ignore = 0;
+
+	netlink_batch_send(&batch);
+
+	for (i = 0; i < batch.num; i++) {
+		rule = batch.entries[i].obj;
+		rule->set = !batch.entries[i].status && cmd == IPRULE_ADD;
+	}
+
+	netlink_batch_free(&batch);
 }
 
 /* Rule dump/allocation */
@@ -913,7 +924,7 @@ clear_diff_rules(list_head_t *l, list_head_t *n)
 					    rule->to_addr ? to_addr : "");
 			}
 
-			netlink_rule(rule, IPRULE_DEL);
+			netlink_rule(rule, IPRULE_DEL, NULL);
 		}
 	}
 }
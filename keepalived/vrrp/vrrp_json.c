@@ -27,6 +27,7 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "vrrp.h"
 #include "vrrp_track.h"
@@ -39,6 +40,10 @@
 #include "timer.h"
 #include "utils.h"
 #include "json_writer.h"
+#include "json_socket.h"
+#include "global_data.h"
+
+static json_socket_t *json_ctl;
 
 static inline double
 timeval_to_double(const timeval_t *t)
@@ -254,7 +259,7 @@ vrrp_json_stats_dump(json_writer_t *wr, vrrp_t *vrrp)
  *	socket fd to a FILE stream.
  */
 static int
-vrrp_json_dump(FILE *fp)
+vrrp_json_dump(FILE *fp, const char *names, bool stats_only)
 {
 	json_writer_t *wr;
 	vrrp_t *vrrp;
@@ -263,8 +268,17 @@ vrrp_json_dump(FILE *fp)
 	jsonw_start_array(wr);
 
 	list_for_each_entry(vrrp, &vrrp_data->vrrp, e_list) {
+		if (!json_socket_name_selected(names, vrrp->iname))
+			continue;
+
 		jsonw_start_object(wr);
-		vrrp_json_data_dump(wr, vrrp);
+		if (stats_only) {
+			jsonw_string_field(wr, "iname", vrrp->iname);
+			jsonw_uint_field(wr, "state", vrrp->state);
+			jsonw_uint_field(wr, "effective_priority", vrrp->effective_priority);
+			jsonw_float_field_fmt(wr, "last_transition", "%f", timeval_to_double(&vrrp->last_transition));
+		} else
+			vrrp_json_data_dump(wr, vrrp);
 		vrrp_json_stats_dump(wr, vrrp);
 		jsonw_end_object(wr);
 	}
@@ -286,10 +300,70 @@ vrrp_print_json(void)
 	filename = make_tmp_filename("keepalived.json");
 	fp = fopen_safe(filename, "w");
 	if (fp) {
-		vrrp_json_dump(fp);
+		vrrp_json_dump(fp, NULL, false);
 		fclose(fp);
 	} else
 		log_message(LOG_INFO, "Can't open %s/keepalived.json (%d: %m)", tmp_dir, errno);
 
 	FREE_CONST(filename);
 }
+
+/* Write the reply to a JSON socket request */
+static bool
+vrrp_json_request(FILE *fp, const char *req, const char *names)
+{
+	if (!strcmp(req, "instances"))
+		vrrp_json_dump(fp, names, false);
+	else if (!strcmp(req, "stats"))
+		vrrp_json_dump(fp, names, true);
+	else
+		return false;
+
+	return true;
+}
+
+/* Send a state change event to any streaming clients */
+void
+vrrp_json_notify(const char *type, const char *name, const char *state, int priority)
+{
+	char *buf = NULL;
+	size_t len = 0;
+	json_writer_t *wr;
+	FILE *fp;
+
+	if (!json_socket_streaming(json_ctl))
+		return;
+
+	if (!(fp = open_memstream(&buf, &len)))
+		return;
+
+	wr = jsonw_new(fp);
+	jsonw_start_object(wr);
+	jsonw_string_field(wr, "type", type);
+	jsonw_string_field(wr, "name", name);
+	jsonw_string_field(wr, "state", state);
+	jsonw_int_field(wr, "priority", priority);
+	jsonw_float_field_fmt(wr, "time", "%f", timeval_to_double(&time_now));
+	jsonw_end_object(wr);
+	jsonw_destroy(&wr);
+	fclose(fp);
+
+	json_socket_event(json_ctl, name, buf, len);
+
+	/* open_memstream() uses malloc, not MALLOC */
+	free(buf);
+}
+
+void
+vrrp_json_socket_open(void)
+{
+	if (global_data->json_socket && !json_ctl)
+		json_ctl = json_socket_open(global_data->json_socket, vrrp_json_request);
+}
+
+void
+vrrp_json_socket_close(void)
+{
+	json_socket_close(json_ctl);
+	json_ctl = NULL;
+}
@@ -40,6 +40,9 @@
 #include "vrrp_snmp.h"
 #endif
 #include "smtp.h"
+#ifdef _WITH_JSON_
+#include "vrrp_json.h"
+#endif
 
 static notify_script_t*
 get_iscript(vrrp_t * vrrp)
@@ -95,10 +98,6 @@ notify_fifo(const char *name, int state_num, bool group, uint8_t priority)
 	char *line;
 	const char *type;
 
-	if (global_data->notify_fifo.fd == -1 &&
-	    global_data->vrrp_notify_fifo.fd == -1)
-		return;
-
 	switch (state_num) {
 	case VRRP_STATE_MAST:
 		state = "MASTER";
@@ -128,6 +127,14 @@ notify_fifo(const char *name, int state_num, bool group, uint8_t priority)
 
 	type = group ? "GROUP" : "INSTANCE";
 
+#ifdef _WITH_JSON_
+	vrrp_json_notify(type, name, state, priority);
+#endif
+
+	if (global_data->notify_fifo.fd == -1 &&
+	    global_data->vrrp_notify_fifo.fd == -1)
+		return;
+
 	size = strlen(type) + strlen(state) + strlen(name) + 10;
 	line = MALLOC(size);
 	if (!line)
@@ -87,7 +87,6 @@ static vrrp_tracked_process_t *current_tp;
 static void
 static_track_group_handler(const vector_t *strvec)
 {
-	static_track_group_t *tg;
 	const char *gname;
 
 	if (!strvec)
@@ -102,13 +101,11 @@ static_track_group_handler(const vector_t *strvec)
 	gname = strvec_slot(strvec, 1);
 
 	/* check group doesn't already exist */
-	list_for_each_entry(tg, &vrrp_data->static_track_groups, e_list) {
-		if (!strcmp(gname,tg->gname)) {
-			report_config_error(CONFIG_GENERAL_ERROR, "track_group %s already defined"
-								, gname);
-			skip_block(true);
-			return;
-		}
+	if (static_track_group_find(gname)) {
+		report_config_error(CONFIG_GENERAL_ERROR, "track_group %s already defined"
+							, gname);
+		skip_block(true);
+		return;
 	}
 
 	current_stg = alloc_static_track_group(gname);
@@ -139,6 +136,7 @@ static_track_group_end_handler(void)
 	}
 
 	list_add_tail(&current_stg->e_list, &vrrp_data->static_track_groups);
+	name_hash_add(&vrrp_data->static_track_group_by_name, &current_stg->e_name, current_stg->gname);
 }
 
 /* Static addresses handler */
@@ -226,7 +224,6 @@ linkbeat_interfaces_handler(const vector_t *strvec)
 static void
 vrrp_sync_group_handler(const vector_t *strvec)
 {
-	vrrp_sgroup_t *sgroup;
 	const char *gname;
 
 	if (!strvec)
@@ -241,12 +238,10 @@ vrrp_sync_group_handler(const vector_t *strvec)
 	gname = strvec_slot(strvec, 1);
 
 	/* check group doesn't already exist */
-	list_for_each_entry(sgroup, &vrrp_data->vrrp_sync_group, e_list) {
-		if (!strcmp(gname, sgroup->gname)) {
-			report_config_error(CONFIG_GENERAL_ERROR, "vrrp sync group %s already defined", gname);
-			skip_block(true);
-			return;
-		}
+	if (name_hash_find(&vrrp_data->vrrp_sync_group_by_name, gname)) {
+		report_config_error(CONFIG_GENERAL_ERROR, "vrrp sync group %s already defined", gname);
+		skip_block(true);
+		return;
 	}
 
 	current_vsyncg = alloc_vrrp_sync_group(gname);
@@ -314,6 +309,7 @@ vrrp_sync_group_end_handler(void)
 	}
 
 	list_add_tail(&current_vsyncg->e_list, &vrrp_data->vrrp_sync_group);
+	name_hash_add(&vrrp_data->vrrp_sync_group_by_name, &current_vsyncg->e_name, current_vsyncg->gname);
 }
 
 static inline notify_script_t*
@@ -416,7 +412,6 @@ vrrp_sg_notify_priority_changes_handler(const vector_t *strvec)
 static void
 vrrp_handler(const vector_t *strvec)
 {
-	vrrp_t *vrrp;
 	const char *iname;
 
 	global_data->have_vrrp_config = true;
@@ -433,12 +428,10 @@ vrrp_handler(const vector_t *strvec)
 	iname = strvec_slot(strvec,1);
 
 	/* Make sure the vrrp instance doesn't already exist */
-	list_for_each_entry(vrrp, &vrrp_data->vrrp, e_list) {
-		if (!strcmp(iname, vrrp->iname)) {
-			report_config_error(CONFIG_GENERAL_ERROR, "vrrp instance %s already defined", iname);
-			skip_block(true);
-			return;
-		}
+	if (vrrp_get_instance(iname)) {
+		report_config_error(CONFIG_GENERAL_ERROR, "vrrp instance %s already defined", iname);
+		skip_block(true);
+		return;
 	}
 
 	current_vrrp = alloc_vrrp(iname);
@@ -476,6 +469,7 @@ vrrp_end_handler(void)
 		__clear_bit(VRRP_FLAG_LINKBEAT_USE_POLLING, &current_vrrp->flags);
 
 	list_add_tail(&current_vrrp->e_list, &vrrp_data->vrrp);
+	name_hash_add(&vrrp_data->vrrp_by_name, &current_vrrp->e_name, current_vrrp->iname);
 }
 
 #ifdef _HAVE_VRRP_VMAC_
@@ -1576,6 +1570,7 @@ vrrp_vscript_end_handler(void)
 	}
 
 	list_add_tail(&current_vscr->e_list, &vrrp_data->vrrp_script);
+	name_hash_add(&vrrp_data->vrrp_script_by_name, &current_vscr->e_name, current_vscr->sname);
 }
 
 #ifdef _WITH_TRACK_PROCESS_
@@ -1775,6 +1770,7 @@ vrrp_tprocess_end_handler(void)
 		vrrp_data->vrrp_use_process_comm = true;
 
 	list_add_tail(&current_tp->e_list, &vrrp_data->vrrp_track_processes);
+	name_hash_add(&vrrp_data->vrrp_track_process_by_name, &current_tp->e_name, current_tp->pname);
 }
 #endif
 static void
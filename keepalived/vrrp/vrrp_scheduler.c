@@ -74,6 +74,13 @@
 #define DEBUG_RECVMSG	1
 #endif
 
+/* Size of control message buffer for each received advert */
+#ifdef _NETWORK_TIMESTAMP_
+#define VRRP_RX_CONTROL_LEN	128
+#else
+#define VRRP_RX_CONTROL_LEN	64
+#endif
+
 /* global vars */
 timeval_t garp_next_time;
 thread_ref_t garp_thread;
@@ -400,7 +407,7 @@ vrrp_register_workers(list_head_t *l)
 // TODO - should we only do this if we have track_bfd? Probably not
 		/* Init BFD tracking thread */
 		bfd_thread = thread_add_read(master, vrrp_bfd_thread, NULL,
-					     bfd_vrrp_event_pipe[0], TIMER_NEVER, 0);
+					     bfd_vrrp_event_chan.fd, TIMER_NEVER, 0);
 	}
 #endif
 
@@ -755,7 +762,7 @@ try_up_instance(vrrp_t *vrrp, bool leaving_init)
 
 #ifdef _WITH_BFD_
 static void
-vrrp_handle_bfd_event(bfd_event_t * evt)
+vrrp_handle_bfd_event(const bfd_event_t *evt)
 {
 	vrrp_tracked_bfd_t *vbfd;
 	tracking_obj_t *tbfd;
@@ -773,47 +780,41 @@ vrrp_handle_bfd_event(bfd_event_t * evt)
 			    evt->iname, BFD_STATE_STR(evt->state), delivery_time);
 	}
 
-	list_for_each_entry(vbfd, &vrrp_data->vrrp_track_bfds, e_list) {
-		if (strcmp(vbfd->bname, evt->iname))
-			continue;
-
-		if ((vbfd->bfd_up && evt->state == BFD_STATE_UP) ||
-		    (!vbfd->bfd_up && evt->state == BFD_STATE_DOWN))
-			continue;
-
-		vbfd->bfd_up = (evt->state == BFD_STATE_UP);
+	if (!(vbfd = find_vrrp_tracked_bfd_by_name(evt->iname)))
+		return;
 
-		list_for_each_entry(tbfd, &vbfd->tracking_vrrp, e_list) {
-			vrrp = tbfd->obj.vrrp;
+	if ((vbfd->bfd_up && evt->state == BFD_STATE_UP) ||
+	    (!vbfd->bfd_up && evt->state == BFD_STATE_DOWN))
+		return;
 
-			log_message(LOG_INFO, "VRRP_Instance(%s) Tracked BFD"
-				    " instance %s is %s", vrrp->iname, evt->iname, vbfd->bfd_up ? "UP" : "DOWN");
+	vbfd->bfd_up = (evt->state == BFD_STATE_UP);
 
-			if (tbfd->weight) {
-				if (vbfd->bfd_up)
-					vrrp->total_priority += abs(tbfd->weight) * tbfd->weight_multiplier;
-				else
-					vrrp->total_priority -= abs(tbfd->weight) * tbfd->weight_multiplier;
-				vrrp_set_effective_priority(vrrp);
+	list_for_each_entry(tbfd, &vbfd->tracking_vrrp, e_list) {
+		vrrp = tbfd->obj.vrrp;
 
-				continue;
-			}
+		log_message(LOG_INFO, "VRRP_Instance(%s) Tracked BFD"
+			    " instance %s is %s", vrrp->iname, evt->iname, vbfd->bfd_up ? "UP" : "DOWN");
 
-			if (!!vbfd->bfd_up == (tbfd->weight_multiplier == 1))
-				try_up_instance(vrrp, false);
+		if (tbfd->weight) {
+			if (vbfd->bfd_up)
+				vrrp->total_priority += abs(tbfd->weight) * tbfd->weight_multiplier;
 			else
-				down_instance(vrrp);
+				vrrp->total_priority -= abs(tbfd->weight) * tbfd->weight_multiplier;
+			vrrp_set_effective_priority(vrrp);
+
+			continue;
 		}
 
-		break;
+		if (!!vbfd->bfd_up == (tbfd->weight_multiplier == 1))
+			try_up_instance(vrrp, false);
+		else
+			down_instance(vrrp);
 	}
 }
 
 static void
 vrrp_bfd_thread(thread_ref_t thread)
 {
-	bfd_event_t evt;
-
 	if (thread->type == THREAD_READ_ERROR) {
 		thread_close_fd(thread);
 		return;
@@ -825,8 +826,7 @@ vrrp_bfd_thread(thread_ref_t thread)
 	if (thread->type != THREAD_READY_READ_FD)
 		return;
 
-	while (read(thread->u.f.fd, &evt, sizeof(bfd_event_t)) != -1)
-		vrrp_handle_bfd_event(&evt);
+	bfd_event_receive(&bfd_vrrp_event_chan, vrrp_handle_bfd_event);
 }
 #endif
 
@@ -868,50 +868,267 @@ vrrp_dispatcher_read_timeout(sock_t *sock)
 	return sock->fd_in;
 }
 
-/* Handle dispatcher read packet */
-static int
-vrrp_dispatcher_read(sock_t *sock)
+/* Handle a received packet. Returns true if no more packets should be read */
+static bool
+vrrp_dispatcher_read_pkt(sock_t *sock, struct msghdr *msghdr, ssize_t len, unsigned long *rx_vrid_map)
 {
 	vrrp_t *vrrp;
 	rb_node_t *vrrp_node;
 	const vrrphdr_t *hd;
-	ssize_t len = 0;
 	int prev_state = 0;
-	sockaddr_t src_addr = { .ss_family = AF_UNSPEC };
-#ifdef _NETWORK_TIMESTAMP_
-	char control_buf[128] __attribute__((aligned(__alignof__(struct cmsghdr))));
-#else
-	char control_buf[64] __attribute__((aligned(__alignof__(struct cmsghdr))));
-#endif
-	struct iovec iovec = { .iov_base = vrrp_buffer, .iov_len = vrrp_buffer_len };
-	struct msghdr msghdr = { .msg_name = &src_addr, .msg_namelen = sizeof(src_addr),
-				 .msg_iov = &iovec, .msg_iovlen = 1,
-				 .msg_control = control_buf, .msg_controllen = sizeof(control_buf) };
+	const sockaddr_t *src_addr = msghdr->msg_name;
+	const void *buffer = msghdr->msg_iov->iov_base;
 	struct cmsghdr *cmsg;
 	bool expected_cmsg;
+	bool terminate_receiving = false;
+	const struct iphdr *iph;
+	unicast_peer_t *unicast_peer;
+
+	/* Don't attempt to process data if no data received */
+	if (len == 0) {
+		log_message(LOG_INFO, "recvmsg(%d) returned data length 0", sock->fd_in);
+		return false;
+	}
+
+#ifdef _RECVMSG_DEBUG_
+	if (do_recvmsg_debug_dump) {
+		log_buffer("Received data", buffer, len);
+	}
+#endif
+
+	if (msghdr->msg_flags & MSG_TRUNC) {
+		log_message(LOG_INFO, "recvmsg(%d) message truncated from %zd to %zu bytes"
+				    , sock->fd_in, len, vrrp_buffer_len);
+		return false;
+	}
+
+	if (msghdr->msg_flags & MSG_CTRUNC) {
+		log_message(LOG_INFO, "recvmsg(%d), control message truncated from %d to %" PRI_MSG_CONTROLLEN " bytes"
+				    , sock->fd_in, VRRP_RX_CONTROL_LEN, msghdr->msg_controllen);
+		msghdr->msg_controllen = 0;
+	}
+
+	if (vrrp_delayed_start_time.tv_sec)
+		return false;
+
+	/* Check the received data includes at least the IP, possibly
+	 * the AH header and the VRRP header */
+	if (!(hd = vrrp_get_header(sock->family, buffer, len)))
+		return true;
+
+	vrrp_node = rb_find(&hd->vrid, &sock->rb_vrid, vrrp_vrid_cmp);
+
+	/* No instance found => ignore the advert */
+	if (!vrrp_node) {
+		if (global_data->log_unknown_vrids)
+			log_message(LOG_INFO, "Unknown VRID(%d) received on interface(%s). ignoring..."
+					    , hd->vrid, IF_NAME(sock->ifp));
+		return false;
+	}
+	vrrp = rb_entry(vrrp_node, vrrp_t, rb_vrid);
+
+	/* Defense strategy here is to handle no more than one advert
+	 * per VRID in order to flush socket rcvq...
+	 * This is a best effort mitigation */
+	if (__test_and_set_bit_array(hd->vrid, rx_vrid_map))
+		terminate_receiving = true;
+
+	if (__test_bit(VRRP_FLAG_UNICAST_DUPLICATE_VRID, &vrrp->flags)) {
+		rb_node_t *first = vrrp_node;	/* Save for second loop */
+
+		/* First check the address we last received an advert from. This is
+		 * an optimisation since we are most likely to receive an advert from
+		 * the same address as last time, and it saves searching all the peers. */
+		for (; vrrp_node; vrrp_node = rb_next_match(&hd->vrid, vrrp_node, vrrp_vrid_cmp)) {
+			vrrp = rb_entry(vrrp_node, vrrp_t, rb_vrid);
+			if (!inet_sockaddrcmp(src_addr, &vrrp->pkt_saddr))
+				break;
+		}
+
+		if (!vrrp_node) {
+			/* Loop through VRRP instances matching hd->vrid if unicast to match
+			 * src address of packet against configured peers */
+			for (vrrp_node = first; vrrp_node; vrrp_node = rb_next_match(&hd->vrid, vrrp_node, vrrp_vrid_cmp)) {
+				vrrp = rb_entry(vrrp_node, vrrp_t, rb_vrid);
+
+				list_for_each_entry(unicast_peer, &vrrp->unicast_peer, e_list) {
+					if (inet_sockaddrcmp(src_addr, &unicast_peer->address) == 0)
+						break;
+					if (list_is_last(&unicast_peer->e_list, &vrrp->unicast_peer)) {
+						unicast_peer = NULL;
+						break;
+					}
+				}
+
+				/* We have found the matching peer */
+				if (unicast_peer)
+					break;
+			}
+
+			if (!vrrp_node) {
+				/* Do nothing and fail because we didn't match any good instance */
+				if (global_data->log_unknown_vrids)
+					log_message(LOG_INFO, "Unknown VRID(%d) received on interface(%s) from %s. ignoring..."
+							    , hd->vrid, IF_NAME(sock->ifp), inet_sockaddrtos(src_addr));
+
+				return terminate_receiving;
+			}
+		}
+	}
+
+	if (vrrp->state == VRRP_STATE_FAULT || vrrp->state == VRRP_STATE_INIT) {
+		/* We just ignore a message received when we are in fault state or
+		 * not yet fully initialised */
+		return terminate_receiving;
+	}
+
+	/* Save non packet data */
+	vrrp->pkt_saddr = *src_addr;
+	vrrp->rx_ttl_hop_limit = -1;           /* Default to not received */
+	if (sock->family == AF_INET) {
+		iph = PTR_CAST_CONST(struct iphdr, buffer);
+		vrrp->multicast_pkt = IN_MULTICAST(htonl(iph->daddr));
+		vrrp->rx_ttl_hop_limit = iph->ttl;
+	} else
+		vrrp->multicast_pkt = false;
+	for (cmsg = CMSG_FIRSTHDR(msghdr); cmsg; cmsg = CMSG_NXTHDR(msghdr, cmsg)) {
+		expected_cmsg = false;
+		if (cmsg->cmsg_level == IPPROTO_IPV6) {
+			expected_cmsg = true;
+
+			if (cmsg->cmsg_type == IPV6_HOPLIMIT &&
+			    cmsg->cmsg_len - sizeof(struct cmsghdr) == sizeof(unsigned int))
+				vrrp->rx_ttl_hop_limit = *PTR_CAST(unsigned int, CMSG_DATA(cmsg));
+			else
+			if (cmsg->cmsg_type == IPV6_PKTINFO &&
+			    cmsg->cmsg_len - sizeof(struct cmsghdr) == sizeof(struct in6_pktinfo))
+				vrrp->multicast_pkt = IN6_IS_ADDR_MULTICAST(&(PTR_CAST(struct in6_pktinfo, CMSG_DATA(cmsg)))->ipi6_addr);
+			else
+				expected_cmsg = false;
+		}
+#ifdef _NETWORK_TIMESTAMP_
+		else if (do_network_timestamp && cmsg->cmsg_level == SOL_SOCKET) {
+			struct timespec *ts = (void *)CMSG_DATA(cmsg);
+			char time_buf[9];
+
+			expected_cmsg = true;
+			if (cmsg->cmsg_type == SO_TIMESTAMPNS) {
+				strftime(time_buf, sizeof time_buf, "%T", localtime(&ts->tv_sec));
+				log_message(LOG_INFO, "TIMESTAMPNS (socket %d - VRID %u) %s.%9.9ld"
+						    , sock->fd_in, hd->vrid, time_buf, ts->tv_nsec);
+			}
+#if 0
+			if (cmsg->cmsg_type == SO_TIMESTAMP) {
+				struct timeval *tv = (void *)CMSG_DATA(cmsg);
+				log_message(LOG_INFO, "TIMESTAMP message (%d - %u)  %ld.%9.9ld"
+						    , sock->fd_in, hd->vrid, tv->tv_sec, tv->tv_usec);
+			}
+			else if (cmsg->cmsg_type == SO_TIMESTAMPING) {
+				struct timespec *ts = (void *)CMSG_DATA(cmsg);
+				log_message(LOG_INFO, "TIMESTAMPING message (%d - %u)  %ld.%9.9ld, raw %ld.%9.9ld"
+						    , sock->fd_in, hd->vrid, ts->tv_sec, ts->tv_nsec, (ts+2)->tv_sec, (ts+2)->tv_nsec);
+			}
+#endif
+			else
+				expected_cmsg = false;
+		}
+#endif
+
+		if (!expected_cmsg)
+			log_message(LOG_INFO, "fd %d, unexpected control msg len %" PRI_MSG_CONTROLLEN ", level %d, type %d"
+					    , sock->fd_in, cmsg->cmsg_len
+					    , cmsg->cmsg_level, cmsg->cmsg_type);
+	}
+
+	/* For multicast, we attempt to bind the socket to ::1 to stop receiving any (non ::1)
+	 * unicast packets, but if that fails we will receive unicast packets on the multicast socket,
+	 * so just discard them here.
+	 * For unicast sockets, if any other instance on the same interface is using multicast we
+	 * will also receive the multicast packets, so also discard them here. */
+	if (sock->family == AF_INET6 && vrrp->multicast_pkt == __test_bit(VRRP_FLAG_UNICAST, &vrrp->flags)) {
+		if (__test_bit(LOG_DETAIL_BIT, &debug))
+			log_message(LOG_INFO, "(%s) discarding %sicast packet on %sicast instance", vrrp->iname,
+					vrrp->multicast_pkt ? "mult" : "un", __test_bit(VRRP_FLAG_UNICAST, &vrrp->flags) ? "un" : "mult");
+		return terminate_receiving;
+	}
+
+	prev_state = vrrp->state;
+
+	if (vrrp->state == VRRP_STATE_BACK)
+		vrrp_state_backup(vrrp, hd, buffer, len);
+	else if (vrrp->state == VRRP_STATE_MAST) {
+		if (vrrp_state_master_rx(vrrp, hd, buffer, len))
+			vrrp_state_leave_master(vrrp, false);
+	} else
+		log_message(LOG_INFO, "(%s) In dispatcher_read with state %d"
+				    , vrrp->iname, vrrp->state);
+
+
+	/* handle instance synchronization */
+#ifdef _TSM_DEBUG_
+	if (do_tsm_debug)
+		log_message(LOG_INFO, "Read [%s] TSM transition : [%d,%d] Wantstate = [%d]"
+				    , vrrp->iname, prev_state, vrrp->state, vrrp->wantstate);
+#endif
+	VRRP_TSM_HANDLE(prev_state, vrrp);
+
+	/* If we have sent an advert, reset the timer */
+	if (vrrp->state != VRRP_STATE_MAST || !vrrp->lower_prio_no_advert)
+		vrrp_init_instance_sands(vrrp);
+
+	return terminate_receiving;
+}
+
+/* Handle dispatcher read packet */
+static int
+vrrp_dispatcher_read(sock_t *sock)
+{
+	sockaddr_t src_addr[VRRP_RECV_BATCH];
+	char control_buf[VRRP_RECV_BATCH][VRRP_RX_CONTROL_LEN] __attribute__((aligned(__alignof__(struct cmsghdr))));
+	struct iovec iovec[VRRP_RECV_BATCH];
+	struct mmsghdr msgs[VRRP_RECV_BATCH];
+	int num_msgs;
+	int i;
 	unsigned eintr_count;
 	unsigned long rx_vrid_map[BIT_WORD(256 + BIT_PER_LONG - 1)] = { 0 };
 	bool terminate_receiving = false;
 #ifdef DEBUG_RECVMSG
 	unsigned recv_data_count = 0;
 #endif
-	const struct iphdr *iph;
-	unicast_peer_t *unicast_peer;
+
+	for (i = 0; i < VRRP_RECV_BATCH; i++) {
+		iovec[i].iov_base = PTR_CAST(char, vrrp_buffer) + i * vrrp_buffer_len;
+		iovec[i].iov_len = vrrp_buffer_len;
+		msgs[i].msg_hdr.msg_iov = &iovec[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
 
 	/* Strategy here is to handle incoming adverts pending into socket recvq
 	 * but stop if receive 2nd advert for a VRID on socket (this applies to
 	 * both configured and unconfigured VRIDs).
+	 * Adverts are read in batches of up to VRRP_RECV_BATCH, and any adverts
+	 * in a batch following the 2nd advert for a VRID are still processed,
+	 * since they have already been removed from the recvq.
 	 * Seems a good tradeoff while simulating */
 	while (!terminate_receiving) {
-		/* read & affect received buffer */
+		for (i = 0; i < VRRP_RECV_BATCH; i++) {
+			src_addr[i].ss_family = AF_UNSPEC;
+			msgs[i].msg_hdr.msg_name = &src_addr[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(src_addr[i]);
+			msgs[i].msg_hdr.msg_control = control_buf[i];
+			msgs[i].msg_hdr.msg_controllen = sizeof(control_buf[i]);
+			msgs[i].msg_hdr.msg_flags = 0;
+		}
+
+		/* read & affect received buffers */
 		eintr_count = 0;
-		while ((len = recvmsg(sock->fd_in, &msghdr, MSG_TRUNC | MSG_CTRUNC)) == -1 &&
+		while ((num_msgs = recvmmsg(sock->fd_in, msgs, VRRP_RECV_BATCH, MSG_TRUNC | MSG_CTRUNC, NULL)) == -1 &&
 		       check_EINTR(errno) && eintr_count++ < 10);
-		if (len < 0) {
+		if (num_msgs < 0) {
 #ifdef DEBUG_RECVMSG
 #ifdef _RECVMSG_DEBUG_
 			if (do_recvmsg_debug && (!recv_data_count || !check_EAGAIN(errno)))
-				log_message(LOG_INFO, "recvmsg(%d) returned errno %d, %u eintr", sock->fd_in, errno, eintr_count);
+				log_message(LOG_INFO, "recvmmsg(%d) returned errno %d, %u eintr", sock->fd_in, errno, eintr_count);
 #endif
 
 #ifdef _RECVMSG_DEBUG_
@@ -919,13 +1136,13 @@ vrrp_dispatcher_read(sock_t *sock)
 #endif
 			{
 				if (check_EINTR(errno))
-					log_message(LOG_INFO, "recvmsg(%d) looped %u times due to EINTR before terminating loop"
+					log_message(LOG_INFO, "recvmmsg(%d) looped %u times due to EINTR before terminating loop"
 							    , sock->fd_in, eintr_count);
 			}
 #endif
 
 			if (!check_EAGAIN(errno))
-				log_message(LOG_INFO, "recvmsg(%d) returned %d (%m)"
+				log_message(LOG_INFO, "recvmmsg(%d) returned %d (%m)"
 						    , sock->fd_in, errno);
 #ifdef DEBUG_RECVMSG
 			else if (
@@ -933,226 +1150,46 @@ vrrp_dispatcher_read(sock_t *sock)
 				 do_recvmsg_debug &&
 #endif
 				 recv_data_count == 0)
-				log_message(LOG_INFO, "recvmsg(%d) returned EAGAIN without any data being received"
+				log_message(LOG_INFO, "recvmmsg(%d) returned EAGAIN without any data being received"
 						    , sock->fd_in);
-
-#ifdef _RECVMSG_DEBUG_
-			if (do_recvmsg_debug)
-#endif
-			{
-				if (recv_data_count != 1)
-					log_message(LOG_INFO, "recvmsg(%d) loop received %u packets"
-							    , sock->fd_in, recv_data_count);
-			}
 #endif
 			break;
 		}
 #ifdef _RECVMSG_DEBUG_
 		else if (do_recvmsg_debug)
-			log_message(LOG_INFO, "recvmsg(%d) looped %u times due to EINTR before returning %zd bytes from %s"
-					    , sock->fd_in, eintr_count, len, inet_sockaddrtos(&src_addr));
+			log_message(LOG_INFO, "recvmmsg(%d) looped %u times due to EINTR before returning %d packets, first from %s"
+					    , sock->fd_in, eintr_count, num_msgs, inet_sockaddrtos(&src_addr[0]));
 #elif defined DEBUG_RECVMSG
 		if (eintr_count)
-			log_message(LOG_INFO, "recvmsg(%d) looped %u times due to EINTR before returning %ld"
-					    , sock->fd_in, eintr_count, len);
-#endif
-
-		/* Don't attempt to process data if no data received */
-		if (len == 0) {
-			log_message(LOG_INFO, "recvmsg(%d) returned data length 0", sock->fd_in);
-			continue;
-		}
-
-#ifdef _RECVMSG_DEBUG_
-		if (do_recvmsg_debug_dump) {
-			log_buffer("Received data", vrrp_buffer, len);
-		}
+			log_message(LOG_INFO, "recvmmsg(%d) looped %u times due to EINTR before returning %d packets"
+					    , sock->fd_in, eintr_count, num_msgs);
 #endif
 
+		for (i = 0; i < num_msgs; i++) {
 #ifdef DEBUG_RECVMSG
-		recv_data_count++;
+			if (msgs[i].msg_len)
+				recv_data_count++;
 #endif
 
-		if (msghdr.msg_flags & MSG_TRUNC) {
-			log_message(LOG_INFO, "recvmsg(%d) message truncated from %zd to %zu bytes"
-					    , sock->fd_in, len, vrrp_buffer_len);
-			continue;
+			if (vrrp_dispatcher_read_pkt(sock, &msgs[i].msg_hdr, (ssize_t)msgs[i].msg_len, rx_vrid_map))
+				terminate_receiving = true;
 		}
 
-		if (msghdr.msg_flags & MSG_CTRUNC) {
-			log_message(LOG_INFO, "recvmsg(%d), control message truncated from %zu to %" PRI_MSG_CONTROLLEN " bytes"
-					    , sock->fd_in, sizeof(control_buf), msghdr.msg_controllen);
-			msghdr.msg_controllen = 0;
-		}
-
-		if (vrrp_delayed_start_time.tv_sec)
-			continue;
-
-		/* Check the received data includes at least the IP, possibly
-		 * the AH header and the VRRP header */
-		if (!(hd = vrrp_get_header(sock->family, vrrp_buffer, len)))
+		/* A short batch means the recvq has been emptied */
+		if (num_msgs < VRRP_RECV_BATCH)
 			break;
+	}
 
-		vrrp_node = rb_find(&hd->vrid, &sock->rb_vrid, vrrp_vrid_cmp);
-
-		/* No instance found => ignore the advert */
-		if (!vrrp_node) {
-			if (global_data->log_unknown_vrids)
-				log_message(LOG_INFO, "Unknown VRID(%d) received on interface(%s). ignoring..."
-						    , hd->vrid, IF_NAME(sock->ifp));
-			continue;
-		}
-		vrrp = rb_entry(vrrp_node, vrrp_t, rb_vrid);
-
-		/* Defense strategy here is to handle no more than one advert
-		 * per VRID in order to flush socket rcvq...
-		 * This is a best effort mitigation */
-		if (__test_and_set_bit_array(hd->vrid, rx_vrid_map))
-			terminate_receiving = true;
-
-		if (__test_bit(VRRP_FLAG_UNICAST_DUPLICATE_VRID, &vrrp->flags)) {
-			rb_node_t *first = vrrp_node;	/* Save for second loop */
-
-			/* First check the address we last received an advert from. This is
-			 * an optimisation since we are most likely to receive an advert from
-			 * the same address as last time, and it saves searching all the peers. */
-			for (; vrrp_node; vrrp_node = rb_next_match(&hd->vrid, vrrp_node, vrrp_vrid_cmp)) {
-				vrrp = rb_entry(vrrp_node, vrrp_t, rb_vrid);
-				if (!inet_sockaddrcmp(&src_addr, &vrrp->pkt_saddr))
-					break;
-			}
-
-			if (!vrrp_node) {
-				/* Loop through VRRP instances matching hd->vrid if unicast to match
-				 * src address of packet against configured peers */
-				for (vrrp_node = first; vrrp_node; vrrp_node = rb_next_match(&hd->vrid, vrrp_node, vrrp_vrid_cmp)) {
-					vrrp = rb_entry(vrrp_node, vrrp_t, rb_vrid);
-
-					list_for_each_entry(unicast_peer, &vrrp->unicast_peer, e_list) {
-						if (inet_sockaddrcmp(&src_addr, &unicast_peer->address) == 0)
-							break;
-						if (list_is_last(&unicast_peer->e_list, &vrrp->unicast_peer)) {
-							unicast_peer = NULL;
-							break;
-						}
-					}
-
-					/* We have found the matching peer */
-					if (unicast_peer)
-						break;
-				}
-
-				if (!vrrp_node) {
-					/* Do nothing and fail because we didn't match any good instance */
-					if (global_data->log_unknown_vrids)
-						log_message(LOG_INFO, "Unknown VRID(%d) received on interface(%s) from %s. ignoring..."
-								    , hd->vrid, IF_NAME(sock->ifp), inet_sockaddrtos(&src_addr));
-
-					continue;
-				}
-			}
-		}
-
-		if (vrrp->state == VRRP_STATE_FAULT || vrrp->state == VRRP_STATE_INIT) {
-			/* We just ignore a message received when we are in fault state or
-			 * not yet fully initialised */
-			continue;
-		}
-
-		/* Save non packet data */
-		vrrp->pkt_saddr = src_addr;
-		vrrp->rx_ttl_hop_limit = -1;           /* Default to not received */
-		if (sock->family == AF_INET) {
-			iph = PTR_CAST_CONST(struct iphdr, vrrp_buffer);
-			vrrp->multicast_pkt = IN_MULTICAST(htonl(iph->daddr));
-			vrrp->rx_ttl_hop_limit = iph->ttl;
-		} else
-			vrrp->multicast_pkt = false;
-		for (cmsg = CMSG_FIRSTHDR(&msghdr); cmsg; cmsg = CMSG_NXTHDR(&msghdr, cmsg)) {
-			expected_cmsg = false;
-			if (cmsg->cmsg_level == IPPROTO_IPV6) {
-				expected_cmsg = true;
-
-				if (cmsg->cmsg_type == IPV6_HOPLIMIT &&
-				    cmsg->cmsg_len - sizeof(struct cmsghdr) == sizeof(unsigned int))
-					vrrp->rx_ttl_hop_limit = *PTR_CAST(unsigned int, CMSG_DATA(cmsg));
-				else
-				if (cmsg->cmsg_type == IPV6_PKTINFO &&
-				    cmsg->cmsg_len - sizeof(struct cmsghdr) == sizeof(struct in6_pktinfo))
-					vrrp->multicast_pkt = IN6_IS_ADDR_MULTICAST(&(PTR_CAST(struct in6_pktinfo, CMSG_DATA(cmsg)))->ipi6_addr);
-				else
-					expected_cmsg = false;
-			}
-#ifdef _NETWORK_TIMESTAMP_
-			else if (do_network_timestamp && cmsg->cmsg_level == SOL_SOCKET) {
-				struct timespec *ts = (void *)CMSG_DATA(cmsg);
-				char time_buf[9];
-
-				expected_cmsg = true;
-				if (cmsg->cmsg_type == SO_TIMESTAMPNS) {
-					strftime(time_buf, sizeof time_buf, "%T", localtime(&ts->tv_sec));
-					log_message(LOG_INFO, "TIMESTAMPNS (socket %d - VRID %u) %s.%9.9ld"
-							    , sock->fd_in, hd->vrid, time_buf, ts->tv_nsec);
-				}
-#if 0
-				if (cmsg->cmsg_type == SO_TIMESTAMP) {
-					struct timeval *tv = (void *)CMSG_DATA(cmsg);
-					log_message(LOG_INFO, "TIMESTAMP message (%d - %u)  %ld.%9.9ld"
-							    , sock->fd_in, hd->vrid, tv->tv_sec, tv->tv_usec);
-				}
-				else if (cmsg->cmsg_type == SO_TIMESTAMPING) {
-					struct timespec *ts = (void *)CMSG_DATA(cmsg);
-					log_message(LOG_INFO, "TIMESTAMPING message (%d - %u)  %ld.%9.9ld, raw %ld.%9.9ld"
-							    , sock->fd_in, hd->vrid, ts->tv_sec, ts->tv_nsec, (ts+2)->tv_sec, (ts+2)->tv_nsec);
-				}
-#endif
-				else
-					expected_cmsg = false;
-			}
-#endif
-
-			if (!expected_cmsg)
-				log_message(LOG_INFO, "fd %d, unexpected control msg len %" PRI_MSG_CONTROLLEN ", level %d, type %d"
-						    , sock->fd_in, cmsg->cmsg_len
-						    , cmsg->cmsg_level, cmsg->cmsg_type);
-		}
-
-		/* For multicast, we attempt to bind the socket to ::1 to stop receiving any (non ::1)
-		 * unicast packets, but if that fails we will receive unicast packets on the multicast socket,
-		 * so just discard them here.
-		 * For unicast sockets, if any other instance on the same interface is using multicast we
-		 * will also receive the multicast packets, so also discard them here. */
-		if (sock->family == AF_INET6 && vrrp->multicast_pkt == __test_bit(VRRP_FLAG_UNICAST, &vrrp->flags)) {
-			if (__test_bit(LOG_DETAIL_BIT, &debug))
-				log_message(LOG_INFO, "(%s) discarding %sicast packet on %sicast instance", vrrp->iname,
-						vrrp->multicast_pkt ? "mult" : "un", __test_bit(VRRP_FLAG_UNICAST, &vrrp->flags) ? "un" : "mult");
-			continue;
-		}
-
-		prev_state = vrrp->state;
-
-		if (vrrp->state == VRRP_STATE_BACK)
-			vrrp_state_backup(vrrp, hd, vrrp_buffer, len);
-		else if (vrrp->state == VRRP_STATE_MAST) {
-			if (vrrp_state_master_rx(vrrp, hd, vrrp_buffer, len))
-				vrrp_state_leave_master(vrrp, false);
-		} else
-			log_message(LOG_INFO, "(%s) In dispatcher_read with state %d"
-					    , vrrp->iname, vrrp->state);
-
-
-		/* handle instance synchronization */
-#ifdef _TSM_DEBUG_
-		if (do_tsm_debug)
-			log_message(LOG_INFO, "Read [%s] TSM transition : [%d,%d] Wantstate = [%d]"
-					    , vrrp->iname, prev_state, vrrp->state, vrrp->wantstate);
+#ifdef DEBUG_RECVMSG
+#ifdef _RECVMSG_DEBUG_
+	if (do_recvmsg_debug)
 #endif
-		VRRP_TSM_HANDLE(prev_state, vrrp);
-
-		/* If we have sent an advert, reset the timer */
-		if (vrrp->state != VRRP_STATE_MAST || !vrrp->lower_prio_no_advert)
-			vrrp_init_instance_sands(vrrp);
+	{
+		if (recv_data_count != 1)
+			log_message(LOG_INFO, "recvmmsg(%d) loop received %u packets"
+					    , sock->fd_in, recv_data_count);
 	}
+#endif
 
 	return sock->fd_in;
 }
@@ -1167,11 +1204,13 @@ vrrp_read_dispatcher_thread(thread_ref_t thread)
 	/* Fetch thread arg */
 	sock = THREAD_ARG(thread);
 
-	/* Dispatcher state handler */
+	/* Dispatcher state handler. Any adverts sent are batched. */
+	vrrp_tx_batch_start();
 	if (thread->type == THREAD_READ_TIMEOUT || sock->fd_in == -1)
 		fd = vrrp_dispatcher_read_timeout(sock);
 	else
 		fd = vrrp_dispatcher_read(sock);
+	vrrp_tx_batch_end();
 
 	/* register next dispatcher thread */
 	if (fd != -1)
@@ -548,13 +548,14 @@ static u_char*
 vrrp_snmp_script(struct variable *vp, oid *name, size_t *length,
 		 int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	vrrp_script_t *scr;
 	list_head_t *e;
 	snmp_ret_t ret;
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					     var_len, write_method,
-					     &vrrp_data->vrrp_script)) == NULL)
+					     &vrrp_data->vrrp_script, &table_index)) == NULL)
 		return NULL;
 	scr = list_entry(e, vrrp_script_t, e_list);
 
@@ -603,13 +604,14 @@ static u_char*
 vrrp_snmp_file(struct variable *vp, oid *name, size_t *length,
 		 int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	tracked_file_t *file;
 	list_head_t *e;
 	snmp_ret_t ret;
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					     var_len, write_method,
-					     &vrrp_data->vrrp_track_files)) == NULL)
+					     &vrrp_data->vrrp_track_files, &table_index)) == NULL)
 		return NULL;
 	file = list_entry(e, tracked_file_t, e_list);
 
@@ -642,13 +644,14 @@ static u_char*
 vrrp_snmp_bfd(struct variable *vp, oid *name, size_t *length,
 		 int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	vrrp_tracked_bfd_t *bfd;
 	list_head_t *e;
 	snmp_ret_t ret;
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					     var_len, write_method,
-					     &vrrp_data->vrrp_track_bfds)) == NULL)
+					     &vrrp_data->vrrp_track_bfds, &table_index)) == NULL)
 		return NULL;
 	bfd = list_entry(e, vrrp_tracked_bfd_t, e_list);
 
@@ -678,13 +681,14 @@ static u_char*
 vrrp_snmp_process(struct variable *vp, oid *name, size_t *length,
 		 int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	vrrp_tracked_process_t *proc;
 	list_head_t *e;
 	snmp_ret_t ret;
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					     var_len, write_method,
-					     &vrrp_data->vrrp_track_processes)) == NULL)
+					     &vrrp_data->vrrp_track_processes, &table_index)) == NULL)
 		return NULL;
 	proc = list_entry(e, vrrp_tracked_process_t, e_list);
 
@@ -1772,13 +1776,14 @@ static u_char *
 vrrp_snmp_syncgroup(struct variable *vp, oid *name, size_t *length,
 		    int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	vrrp_sgroup_t *group;
 	list_head_t *e;
 	snmp_ret_t ret;
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					     var_len, write_method,
-					     &vrrp_data->vrrp_sync_group)) == NULL)
+					     &vrrp_data->vrrp_sync_group, &table_index)) == NULL)
 		return NULL;
 	group = list_entry(e, vrrp_sgroup_t, e_list);
 
@@ -1849,6 +1854,7 @@ static u_char *
 vrrp_snmp_syncgroupmember(struct variable *vp, oid *name, size_t *length,
 			  int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	snmp_ret_t ret;
 	vrrp_t *vrrp;
 	list_head_t *e;
@@ -1856,7 +1862,8 @@ vrrp_snmp_syncgroupmember(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp_sync_group,
 			      offsetof(vrrp_sgroup_t, e_list),
-			      offsetof(vrrp_sgroup_t, vrrp_instances));
+			      offsetof(vrrp_sgroup_t, vrrp_instances),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2040,13 +2047,14 @@ static u_char*
 vrrp_snmp_instance(struct variable *vp, oid *name, size_t *length,
 		   int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	snmp_ret_t ret;
 	list_head_t *e;
 	vrrp_t *rt;
 
 	if ((e = snmp_header_list_head_table(vp, name, length, exact,
 					     var_len, write_method,
-					     &vrrp_data->vrrp)) == NULL)
+					     &vrrp_data->vrrp, &table_index)) == NULL)
 		return NULL;
 	rt = list_entry(e, vrrp_t, e_list);
 
@@ -2234,6 +2242,7 @@ static u_char *
 vrrp_snmp_trackedinterface(struct variable *vp, oid *name, size_t *length,
 			   int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_if_t *bifp;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2241,7 +2250,8 @@ vrrp_snmp_trackedinterface(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp,
 			      offsetof(vrrp_t, e_list),
-			      offsetof(vrrp_t, track_ifp));
+			      offsetof(vrrp_t, track_ifp),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2266,6 +2276,7 @@ static u_char*
 vrrp_snmp_trackedscript(struct variable *vp, oid *name, size_t *length,
 			int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_sc_t *bscr;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2273,7 +2284,8 @@ vrrp_snmp_trackedscript(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp,
 			      offsetof(vrrp_t, e_list),
-			      offsetof(vrrp_t, track_script));
+			      offsetof(vrrp_t, track_script),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2298,6 +2310,7 @@ static u_char*
 vrrp_snmp_trackedfile(struct variable *vp, oid *name, size_t *length,
 			int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_file_monitor_t *bfile;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2305,7 +2318,8 @@ vrrp_snmp_trackedfile(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp,
 			      offsetof(vrrp_t, e_list),
-			      offsetof(vrrp_t, track_file));
+			      offsetof(vrrp_t, track_file),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2332,6 +2346,7 @@ static u_char*
 vrrp_snmp_trackedbfd(struct variable *vp, oid *name, size_t *length,
 			int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_bfd_t *bbfd;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2339,7 +2354,8 @@ vrrp_snmp_trackedbfd(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp,
 			      offsetof(vrrp_t, e_list),
-			      offsetof(vrrp_t, track_bfd));
+			      offsetof(vrrp_t, track_bfd),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2367,6 +2383,7 @@ static u_char*
 vrrp_snmp_trackedprocess(struct variable *vp, oid *name, size_t *length,
 			int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_process_t *bproc;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2374,7 +2391,8 @@ vrrp_snmp_trackedprocess(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp,
 			      offsetof(vrrp_t, e_list),
-			      offsetof(vrrp_t, track_process));
+			      offsetof(vrrp_t, track_process),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2401,6 +2419,7 @@ static u_char*
 vrrp_snmp_group_trackedinterface(struct variable *vp, oid *name, size_t *length,
 			   int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_if_t *bifp;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2408,7 +2427,8 @@ vrrp_snmp_group_trackedinterface(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp_sync_group,
 			      offsetof(vrrp_sgroup_t, e_list),
-			      offsetof(vrrp_sgroup_t, track_ifp));
+			      offsetof(vrrp_sgroup_t, track_ifp),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2433,6 +2453,7 @@ static u_char*
 vrrp_snmp_group_trackedscript(struct variable *vp, oid *name, size_t *length,
 			int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_sc_t *bscr;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2440,7 +2461,8 @@ vrrp_snmp_group_trackedscript(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp_sync_group,
 			      offsetof(vrrp_sgroup_t, e_list),
-			      offsetof(vrrp_sgroup_t, track_script));
+			      offsetof(vrrp_sgroup_t, track_script),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2465,6 +2487,7 @@ static u_char*
 vrrp_snmp_group_trackedfile(struct variable *vp, oid *name, size_t *length,
 			int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_file_monitor_t *bfile;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2472,7 +2495,8 @@ vrrp_snmp_group_trackedfile(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp_sync_group,
 			      offsetof(vrrp_sgroup_t, e_list),
-			      offsetof(vrrp_sgroup_t, track_file));
+			      offsetof(vrrp_sgroup_t, track_file),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2499,6 +2523,7 @@ static u_char*
 vrrp_snmp_group_trackedbfd(struct variable *vp, oid *name, size_t *length,
 			int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_bfd_t *bbfd;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2506,7 +2531,8 @@ vrrp_snmp_group_trackedbfd(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp_sync_group,
 			      offsetof(vrrp_sgroup_t, e_list),
-			      offsetof(vrrp_sgroup_t, track_bfd));
+			      offsetof(vrrp_sgroup_t, track_bfd),
+			      &table_index);
 	if (!e)
 		return NULL;
 
@@ -2534,6 +2560,7 @@ static u_char*
 vrrp_snmp_group_trackedprocess(struct variable *vp, oid *name, size_t *length,
 			int exact, size_t *var_len, WriteMethod **write_method)
 {
+	static snmp_index_t table_index;
 	const tracked_process_t *bproc;
 	list_head_t *e;
 	snmp_ret_t ret;
@@ -2541,7 +2568,8 @@ vrrp_snmp_group_trackedprocess(struct variable *vp, oid *name, size_t *length,
 	e = snmp_find_element(vp, name, length, exact, var_len, write_method,
 			      &vrrp_data->vrrp_sync_group,
 			      offsetof(vrrp_sgroup_t, e_list),
-			      offsetof(vrrp_sgroup_t, track_process));
+			      offsetof(vrrp_sgroup_t, track_process),
+			      &table_index);
 	if (!e)
 		return NULL;
 
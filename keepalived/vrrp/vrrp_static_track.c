@@ -55,6 +55,7 @@ free_static_track_group(static_track_group_t *tgroup)
 		free_strvec(tgroup->iname);
 	}
 	list_del_init(&tgroup->e_list);
+	name_hash_del(&tgroup->e_name);
 	FREE_CONST(tgroup->gname);
 	free_static_track_group_vrrp_list(&tgroup->vrrp_instances);
 	FREE(tgroup);
@@ -76,13 +77,7 @@ dump_static_track_group(FILE *fp, const static_track_group_t *tgroup)
 static_track_group_t * __attribute__ ((pure))
 static_track_group_find(const char *gname)
 {
-	static_track_group_t *tgroup;
-
-	list_for_each_entry(tgroup, &vrrp_data->static_track_groups, e_list)
-		if (!strcmp(gname, tgroup->gname))
-			return tgroup;
-
-	return NULL;
+	return name_hash_find_entry(&vrrp_data->static_track_group_by_name, gname, static_track_group_t, e_name);
 }
 
 static bool
@@ -34,15 +34,9 @@
 
 /* Instance name lookup */
 vrrp_t * __attribute__ ((pure))
-vrrp_get_instance(char *iname)
+vrrp_get_instance(const char *iname)
 {
-	vrrp_t *vrrp;
-
-	list_for_each_entry(vrrp, &vrrp_data->vrrp, e_list) {
-		if (strcmp(vrrp->iname, iname) == 0)
-			return vrrp;
-	}
-	return NULL;
+	return name_hash_find_entry(&vrrp_data->vrrp_by_name, iname, vrrp_t, e_name);
 }
 
 /* Set instances group pointer */
@@ -23,6 +23,7 @@
 #include "config.h"
 
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include <stdint.h>
 
@@ -51,6 +52,43 @@ size_t extract_content_length(const char *buffer, size_t size)
 	return len;
 }
 
+/*
+ * Return true if the http header field name has token in its
+ * comma separated list of values. The header field name and
+ * token are matched case insensitively.
+ */
+bool __attribute__ ((pure))
+extract_header_token(const char *buffer, size_t size, const char *name, const char *token)
+{
+	const char *buf_end = buffer + size;
+	const char *cur, *end;
+	size_t name_len = strlen(name);
+	size_t token_len = strlen(token);
+
+	for (cur = buffer; cur < buf_end; cur++) {
+		/* Find the start of the next header line */
+		if (cur != buffer && cur[-1] != '\n')
+			continue;
+
+		if ((size_t)(buf_end - cur) <= name_len ||
+		    strncasecmp(cur, name, name_len) ||
+		    cur[name_len] != ':')
+			continue;
+
+		for (cur += name_len + 1; cur < buf_end && *cur != '\r' && *cur != '\n'; cur = end) {
+			while (cur < buf_end && (*cur == ' ' || *cur == '\t' || *cur == ','))
+				cur++;
+			for (end = cur; end < buf_end && *end != ',' && *end != ' ' && *end != '\t' && *end != '\r' && *end != '\n'; end++);
+
+			if ((size_t)(end - cur) == token_len &&
+			    !strncasecmp(cur, token, token_len))
+				return true;
+		}
+	}
+
+	return false;
+}
+
 /*
  * Return the http header error code. According
  * to rfc2616.6.1 status code is between HTTP_Version
@@ -24,10 +24,12 @@
 #define _HTML_H
 
 #include <sys/types.h>
+#include <stdbool.h>
 
 /* Prototypes */
 extern size_t extract_content_length(const char *buffer, size_t size);
 extern int extract_status_code(const char *buffer, size_t size);
+extern bool extract_header_token(const char *buffer, size_t size, const char *name, const char *token) __attribute__ ((pure));
 extern const char *extract_html(const char *buffer, size_t size_buffer) __attribute__ ((pure));
 
 #endif
@@ -0,0 +1,436 @@
+/*
+ * Soft:        Keepalived is a failover program for the LVS project
+ *              <www.linuxvirtualserver.org>. It monitor & manipulate
+ *              a loadbalanced server pool using multi-layer checks.
+ *
+ * Part:        Unix domain socket serving JSON state queries and
+ *              streaming state change events.
+ *
+ * Author:      Alexandre Cassen, <acassen@linux-vs.org>
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *              See the GNU General Public License for more details.
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              as published by the Free Software Foundation; either version
+ *              2 of the License, or (at your option) any later version.
+ *
+ * Copyright (C) 2001-2024 Alexandre Cassen, <acassen@gmail.com>
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "json_socket.h"
+#include "list_head.h"
+#include "logger.h"
+#include "memory.h"
+#include "scheduler.h"
+#include "utils.h"
+
+/* Control socket connections */
+#define JSON_CTL_MAX_REQUEST	1024
+#define JSON_CTL_MAX_CLIENTS	32
+#define JSON_CTL_MAX_PENDING	(1024 * 1024)	/* Output queued to a slow reader */
+
+struct _json_socket {
+	int			fd;
+	thread_ref_t		thread;
+	const char		*path;
+	json_socket_request_t	request;
+	list_head_t		clients;	/* json_ctl_client_t */
+	unsigned		num_clients;
+	unsigned		num_streams;
+};
+
+typedef struct _json_ctl_client {
+	json_socket_t		*sock;
+	int			fd;
+	thread_ref_t		read_thread;
+	thread_ref_t		write_thread;
+	char			rbuf[JSON_CTL_MAX_REQUEST];
+	size_t			rlen;
+	char			*wbuf;
+	size_t			wlen;
+	size_t			wofs;
+	bool			stream;
+	const char		*stream_names;	/* NULL for all names */
+
+	/* Linking */
+	list_head_t		e_list;
+} json_ctl_client_t;
+
+/* Is name in the space separated list names ? A NULL list selects all */
+bool __attribute__ ((pure))
+json_socket_name_selected(const char *names, const char *name)
+{
+	size_t len = strlen(name);
+	const char *p = names;
+
+	if (!names)
+		return true;
+
+	while ((p = strstr(p, name))) {
+		if ((p == names || p[-1] == ' ') && (p[len] == ' ' || !p[len]))
+			return true;
+		p += len;
+	}
+
+	return false;
+}
+
+/* thread is the client's read or write thread if it is the one running,
+ * since the scheduler still has the fd registered for it. */
+static void
+json_ctl_close_client(json_ctl_client_t *client, thread_ref_t thread)
+{
+	json_socket_t *sock = client->sock;
+
+	if (client->read_thread)
+		thread_cancel(client->read_thread);
+	if (client->write_thread)
+		thread_cancel(client->write_thread);
+	if (thread)
+		thread_close_fd(thread);
+	else
+		close(client->fd);
+
+	if (client->stream)
+		sock->num_streams--;
+	sock->num_clients--;
+
+	list_del_init(&client->e_list);
+	FREE_CONST_PTR(client->stream_names);
+	FREE_PTR(client->wbuf);
+	FREE(client);
+}
+
+/* Send as much of the queued output as the socket will take */
+static bool
+json_ctl_flush(json_ctl_client_t *client)
+{
+	ssize_t len;
+
+	while (client->wofs < client->wlen) {
+		len = send(client->fd, client->wbuf + client->wofs, client->wlen - client->wofs, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (len == -1) {
+			if (check_EINTR(errno))
+				continue;
+			if (check_EAGAIN(errno))
+				return true;
+			return false;
+		}
+		client->wofs += (size_t)len;
+	}
+
+	FREE_PTR(client->wbuf);
+	client->wbuf = NULL;
+	client->wlen = client->wofs = 0;
+
+	return true;
+}
+
+static void json_ctl_write_thread(thread_ref_t);
+
+/* Returns false if the client must be closed */
+static bool
+json_ctl_queue(json_ctl_client_t *client, const char *buf, size_t len)
+{
+	if (client->wlen - client->wofs + len > JSON_CTL_MAX_PENDING) {
+		log_message(LOG_INFO, "JSON socket client not reading - closing connection");
+		return false;
+	}
+
+	if (client->wofs) {
+		memmove(client->wbuf, client->wbuf + client->wofs, client->wlen - client->wofs);
+		client->wlen -= client->wofs;
+		client->wofs = 0;
+	}
+	client->wbuf = client->wbuf ? REALLOC(client->wbuf, client->wlen + len) : MALLOC(len);
+	memcpy(client->wbuf + client->wlen, buf, len);
+	client->wlen += len;
+
+	if (client->write_thread)
+		return true;
+
+	if (!json_ctl_flush(client))
+		return false;
+
+	if (client->wlen)
+		client->write_thread = thread_add_write(master, json_ctl_write_thread, client, client->fd, TIMER_NEVER, 0);
+
+	return true;
+}
+
+static void
+json_ctl_write_thread(thread_ref_t thread)
+{
+	json_ctl_client_t *client = THREAD_ARG(thread);
+
+	client->write_thread = NULL;
+
+	if (thread->type == THREAD_WRITE_ERROR || !json_ctl_flush(client)) {
+		json_ctl_close_client(client, thread);
+		return;
+	}
+
+	if (client->wlen)
+		client->write_thread = thread_add_write(master, json_ctl_write_thread, client, client->fd, TIMER_NEVER, 0);
+}
+
+/* Returns false if the client must be closed */
+static bool
+json_ctl_error(json_ctl_client_t *client, const char *error)
+{
+	char buf[128];
+	int len;
+
+	len = snprintf(buf, sizeof(buf), "{\"error\":\"%s\"}\n", error);
+	return json_ctl_queue(client, buf, (size_t)len);
+}
+
+/* Returns false if the client must be closed */
+static bool
+json_ctl_reply(json_ctl_client_t *client, const char *req, const char *names)
+{
+	FILE *fp;
+	char *buf = NULL;
+	size_t len = 0;
+	bool known;
+	bool ret;
+
+	if (!(fp = open_memstream(&buf, &len))) {
+		log_message(LOG_INFO, "JSON socket open_memstream failed (%d: %m)", errno);
+		return true;
+	}
+
+	known = client->sock->request(fp, req, names);
+	fclose(fp);
+
+	ret = known ? json_ctl_queue(client, buf, len) : json_ctl_error(client, "unknown request");
+
+	/* open_memstream() uses malloc, not MALLOC */
+	free(buf);
+
+	return ret;
+}
+
+/* Returns false if the client must be closed */
+static bool
+json_ctl_request(json_ctl_client_t *client, char *req)
+{
+	char *names;
+	char *p;
+
+	/* Collapse whitespace so that names are separated by single spaces */
+	for (p = req; *p; p++) {
+		if (*p == '\t' || *p == '\r')
+			*p = ' ';
+	}
+	while (*req == ' ')
+		req++;
+	while (p > req && p[-1] == ' ')
+		*--p = '\0';
+
+	if ((names = strchr(req, ' '))) {
+		*names++ = '\0';
+		while (*names == ' ')
+			names++;
+		for (p = names; *p; p++) {
+			if (*p == ' ' && p[1] == ' ')
+				memmove(p, p + 1, strlen(p));
+		}
+	}
+
+	if (!req[0])
+		return true;
+
+	if (strcmp(req, "stream"))
+		return json_ctl_reply(client, req, names);
+
+	if (!client->stream)
+		client->sock->num_streams++;
+	client->stream = true;
+	FREE_CONST_PTR(client->stream_names);
+	client->stream_names = names ? STRDUP(names) : NULL;
+
+	return true;
+}
+
+static void
+json_ctl_read_thread(thread_ref_t thread)
+{
+	json_ctl_client_t *client = THREAD_ARG(thread);
+	ssize_t len;
+	char *eol, *req;
+
+	client->read_thread = NULL;
+
+	if (thread->type == THREAD_READ_ERROR) {
+		json_ctl_close_client(client, thread);
+		return;
+	}
+
+	len = read(client->fd, client->rbuf + client->rlen, sizeof(client->rbuf) - client->rlen - 1);
+	if (len == -1 && (check_EAGAIN(errno) || check_EINTR(errno)))
+		goto next;
+	if (len <= 0) {
+		json_ctl_close_client(client, thread);
+		return;
+	}
+
+	client->rlen += (size_t)len;
+	client->rbuf[client->rlen] = '\0';
+
+	req = client->rbuf;
+	while ((eol = strchr(req, '\n'))) {
+		*eol = '\0';
+		if (!json_ctl_request(client, req)) {
+			json_ctl_close_client(client, thread);
+			return;
+		}
+		req = eol + 1;
+	}
+
+	client->rlen -= (size_t)(req - client->rbuf);
+	memmove(client->rbuf, req, client->rlen);
+	if (client->rlen == sizeof(client->rbuf) - 1) {
+		if (!json_ctl_error(client, "request too long")) {
+			json_ctl_close_client(client, thread);
+			return;
+		}
+		client->rlen = 0;
+	}
+
+next:
+	client->read_thread = thread_add_read(master, json_ctl_read_thread, client, client->fd, TIMER_NEVER, 0);
+}
+
+static void
+json_ctl_accept_thread(thread_ref_t thread)
+{
+	json_socket_t *sock = THREAD_ARG(thread);
+	json_ctl_client_t *client;
+	int fd;
+
+	sock->thread = thread_add_read(master, json_ctl_accept_thread, sock, thread->u.f.fd, TIMER_NEVER, 0);
+
+	if ((fd = accept4(thread->u.f.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) == -1) {
+		if (!check_EAGAIN(errno) && !check_EINTR(errno))
+			log_message(LOG_INFO, "JSON socket accept error (%d: %m)", errno);
+		return;
+	}
+
+	if (sock->num_clients >= JSON_CTL_MAX_CLIENTS) {
+		log_message(LOG_INFO, "Too many JSON socket connections - rejecting");
+		close(fd);
+		return;
+	}
+
+	PMALLOC(client);
+	client->sock = sock;
+	client->fd = fd;
+	list_add_tail(&client->e_list, &sock->clients);
+	sock->num_clients++;
+
+	client->read_thread = thread_add_read(master, json_ctl_read_thread, client, fd, TIMER_NEVER, 0);
+}
+
+/* Are any clients waiting for events ? */
+bool __attribute__ ((pure))
+json_socket_streaming(const json_socket_t *sock)
+{
+	return sock && sock->num_streams;
+}
+
+/* Send the event in buf, about name, to any streaming clients that selected it */
+void
+json_socket_event(json_socket_t *sock, const char *name, const char *buf, size_t len)
+{
+	json_ctl_client_t *client, *client_tmp;
+
+	if (!json_socket_streaming(sock))
+		return;
+
+	list_for_each_entry_safe(client, client_tmp, &sock->clients, e_list) {
+		if (client->stream && json_socket_name_selected(client->stream_names, name) &&
+		    !json_ctl_queue(client, buf, len))
+			json_ctl_close_client(client, NULL);
+	}
+}
+
+json_socket_t *
+json_socket_open(const char *path, json_socket_request_t request)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	json_socket_t *sock;
+	int fd;
+
+	strcpy_safe(addr.sun_path, path);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1) {
+		log_message(LOG_INFO, "Unable to create JSON socket (%d: %m)", errno);
+		return NULL;
+	}
+
+	/* A previous instance may have left the socket behind */
+	unlink(addr.sun_path);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    chmod(addr.sun_path, S_IRUSR | S_IWUSR) ||
+	    listen(fd, JSON_CTL_MAX_CLIENTS)) {
+		log_message(LOG_INFO, "Unable to listen on JSON socket %s (%d: %m)", addr.sun_path, errno);
+		close(fd);
+		unlink(addr.sun_path);
+		return NULL;
+	}
+
+	PMALLOC(sock);
+	sock->fd = fd;
+	sock->path = STRDUP(path);
+	sock->request = request;
+	INIT_LIST_HEAD(&sock->clients);
+	sock->thread = thread_add_read(master, json_ctl_accept_thread, sock, fd, TIMER_NEVER, 0);
+
+	return sock;
+}
+
+void
+json_socket_close(json_socket_t *sock)
+{
+	json_ctl_client_t *client, *client_tmp;
+
+	if (!sock)
+		return;
+
+	list_for_each_entry_safe(client, client_tmp, &sock->clients, e_list)
+		json_ctl_close_client(client, NULL);
+
+	if (sock->thread)
+		thread_cancel(sock->thread);
+	close(sock->fd);
+	unlink(sock->path);
+
+	FREE_CONST(sock->path);
+	FREE(sock);
+}
+
+#ifdef THREAD_DUMP
+void
+register_json_socket_addresses(void)
+{
+	register_thread_address("json_ctl_accept_thread", json_ctl_accept_thread);
+	register_thread_address("json_ctl_read_thread", json_ctl_read_thread);
+	register_thread_address("json_ctl_write_thread", json_ctl_write_thread);
+}
+#endif
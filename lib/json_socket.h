@@ -0,0 +1,46 @@
+/*
+ * Soft:        Keepalived is a failover program for the LVS project
+ *              <www.linuxvirtualserver.org>. It monitor & manipulate
+ *              a loadbalanced server pool using multi-layer checks.
+ *
+ * Part:        json_socket.c include file.
+ *
+ * Author:      Alexandre Cassen, <acassen@linux-vs.org>
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *              See the GNU General Public License for more details.
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              as published by the Free Software Foundation; either version
+ *              2 of the License, or (at your option) any later version.
+ *
+ * Copyright (C) 2001-2024 Alexandre Cassen, <acassen@gmail.com>
+ */
+
+#ifndef _JSON_SOCKET_H
+#define _JSON_SOCKET_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Opaque socket structure */
+typedef struct _json_socket json_socket_t;
+
+/* Writes the reply to a request to fp. names is a space separated list,
+ * or NULL if none were given. Returns false if the request is unknown. */
+typedef bool (*json_socket_request_t)(FILE *fp, const char *request, const char *names);
+
+/* Prototypes */
+extern bool json_socket_name_selected(const char *, const char *) __attribute__ ((pure));
+extern json_socket_t *json_socket_open(const char *, json_socket_request_t);
+extern bool json_socket_streaming(const json_socket_t *) __attribute__ ((pure));
+extern void json_socket_event(json_socket_t *, const char *, const char *, size_t);
+extern void json_socket_close(json_socket_t *);
+#ifdef THREAD_DUMP
+extern void register_json_socket_addresses(void);
+#endif
+
+#endif
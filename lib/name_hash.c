@@ -0,0 +1,145 @@
+/*
+ * Soft:        Keepalived is a failover program for the LVS project
+ *              <www.linuxvirtualserver.org>. It monitor & manipulate
+ *              a loadbalanced server pool using multi-layer checks.
+ *
+ * Part:        Hash tables of named objects, for resolving references
+ *              by name in the configuration.
+ *
+ * Author:      Alexandre Cassen, <acassen@linux-vs.org>
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *              See the GNU General Public License for more details.
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              as published by the Free Software Foundation; either version
+ *              2 of the License, or (at your option) any later version.
+ *
+ * Copyright (C) 2001-2024 Alexandre Cassen, <acassen@gmail.com>
+ */
+
+#include "config.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "name_hash.h"
+#include "memory.h"
+
+#define NAME_HASH_MIN_BITS	4
+
+/* The table is doubled in size when the average chain length exceeds this */
+#define NAME_HASH_MAX_LOAD	2U
+
+static unsigned __attribute__ ((pure))
+name_hashkey(const char *name, unsigned bits)
+{
+	uint32_t key = 0;
+
+	while (*name)
+		key = key * 31 + (unsigned char)*name++;
+
+	return (key * 0x9e3779b1U) >> (32 - bits);
+}
+
+/* Objects are added at the end of the chain, so that if more than one has
+ * the same name the first added is found, as when searching a list. */
+static void
+name_hash_insert(hlist_head_t *head, name_hash_node_t *node)
+{
+	hlist_node_t *pos;
+
+	if (!head->first) {
+		hlist_add_head(&node->e_hash, head);
+		return;
+	}
+
+	for (pos = head->first; pos->next; pos = pos->next);
+	hlist_add_after(pos, &node->e_hash);
+}
+
+static void
+name_hash_resize(name_hash_t *hash, unsigned bits)
+{
+	hlist_head_t *old_head = hash->head;
+	unsigned old_size = old_head ? 1U << hash->bits : 0;
+	name_hash_node_t *node;
+	hlist_node_t *pos;
+	unsigned i;
+
+	hash->head = MALLOC(sizeof(*hash->head) << bits);
+	hash->bits = bits;
+
+	for (i = 0; i < old_size; i++) {
+		while ((pos = old_head[i].first)) {
+			node = hlist_entry(pos, name_hash_node_t, e_hash);
+			__hlist_del(pos);
+			name_hash_insert(&hash->head[name_hashkey(node->name, bits)], node);
+		}
+	}
+
+	if (old_head)
+		FREE(old_head);
+}
+
+void
+name_hash_add(name_hash_t *hash, name_hash_node_t *node, const char *name)
+{
+	if (!hash->head)
+		name_hash_resize(hash, NAME_HASH_MIN_BITS);
+	else if (hash->count >= NAME_HASH_MAX_LOAD << hash->bits)
+		name_hash_resize(hash, hash->bits + 1);
+
+	node->name = name;
+	name_hash_insert(&hash->head[name_hashkey(name, hash->bits)], node);
+	hash->count++;
+}
+
+/* The node may not have been added. The count is not reduced, since
+ * objects are rarely removed other than when the table is freed */
+void
+name_hash_del(name_hash_node_t *node)
+{
+	hlist_del_init(&node->e_hash);
+}
+
+name_hash_node_t *
+name_hash_find(const name_hash_t *hash, const char *name)
+{
+	name_hash_node_t *node;
+	hlist_node_t *pos;
+
+	if (!hash->head)
+		return NULL;
+
+	hlist_for_each_entry(node, pos, &hash->head[name_hashkey(name, hash->bits)], e_hash) {
+		if (!strcmp(node->name, name))
+			return node;
+	}
+
+	return NULL;
+}
+
+/* Any objects still in the table are left unhashed */
+void
+name_hash_free(name_hash_t *hash)
+{
+	hlist_node_t *pos;
+	unsigned i;
+
+	if (!hash->head)
+		return;
+
+	for (i = 0; i < 1U << hash->bits; i++) {
+		while ((pos = hash->head[i].first))
+			hlist_del_init(pos);
+	}
+
+	FREE(hash->head);
+	hash->head = NULL;
+	hash->bits = 0;
+	hash->count = 0;
+}
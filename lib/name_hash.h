@@ -0,0 +1,54 @@
+/*
+ * Soft:        Keepalived is a failover program for the LVS project
+ *              <www.linuxvirtualserver.org>. It monitor & manipulate
+ *              a loadbalanced server pool using multi-layer checks.
+ *
+ * Part:        name_hash.c include file.
+ *
+ * Author:      Alexandre Cassen, <acassen@linux-vs.org>
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *              See the GNU General Public License for more details.
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              as published by the Free Software Foundation; either version
+ *              2 of the License, or (at your option) any later version.
+ *
+ * Copyright (C) 2001-2024 Alexandre Cassen, <acassen@gmail.com>
+ */
+
+#ifndef _NAME_HASH_H
+#define _NAME_HASH_H
+
+#include "list_head.h"
+
+/* A hash table of objects keyed by name. The object embeds a
+ * name_hash_node_t, whose name points to the object's own name. */
+typedef struct _name_hash_node {
+	const char		*name;
+	hlist_node_t		e_hash;
+} name_hash_node_t;
+
+/* An all zero name_hash_t is an empty table; the buckets are allocated
+ * when the first object is added, and grown as objects are added */
+typedef struct _name_hash {
+	hlist_head_t		*head;
+	unsigned		bits;
+	unsigned		count;
+} name_hash_t;
+
+/* Prototypes */
+extern void name_hash_add(name_hash_t *, name_hash_node_t *, const char *);
+extern void name_hash_del(name_hash_node_t *);
+extern name_hash_node_t *name_hash_find(const name_hash_t *, const char *) __attribute__ ((pure));
+extern void name_hash_free(name_hash_t *);
+
+/* Returns the object containing the node found, or NULL */
+#define name_hash_find_entry(hash, name, type, member) ({		\
+	name_hash_node_t *__node = name_hash_find(hash, name);		\
+	__node ? container_of(__node, type, member) : NULL; })
+
+#endif
@@ -34,6 +34,9 @@
 #include <sys/resource.h>
 #include <limits.h>
 #include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
 
 #include "notify.h"
 #include "signals.h"
@@ -69,6 +72,38 @@ static bool path_is_malloced;
 /* Buffer for expanding notify script commands */
 static char cmd_str_buf[MAXBUF];
 
+#ifndef _ONE_PROCESS_DEBUG_
+/* Script helper requests and replies */
+#define SCRIPT_HELPER_MAX_ARGS	64
+
+typedef struct _script_helper_req {
+	pid_t		reap;		/* If set, the parent has processed this script's termination */
+	uid_t		uid;
+	gid_t		gid;
+	int		flags;
+	int		num_args;
+	/* Followed by the nul terminated args */
+} script_helper_req_t;
+
+typedef struct _script_helper_reply {
+	pid_t		pid;
+	int		status;
+	bool		exited;
+} script_helper_reply_t;
+
+/* A script started by the helper */
+typedef struct _script_helper_child {
+	pid_t		pid;
+	bool		exited;		/* Exit reported to the parent, but not yet reaped */
+
+	/* Linked list member */
+	list_head_t	e_list;
+} script_helper_child_t;
+
+static int script_helper_fd = -1;
+static char script_helper_buf[8192] __attribute__((aligned(__alignof__(script_helper_req_t))));
+#endif
+
 static bool
 set_script_env(uid_t uid, gid_t gid)
 {
@@ -149,42 +184,14 @@ cmd_str(const notify_script_t *script)
 	return cmd_str_r(script, cmd_str_buf, sizeof cmd_str_buf);
 }
 
-int
-system_call_script(thread_master_t *m, thread_func_t func, void * arg, unsigned long timer, const notify_script_t* script)
+/* Child process part of running a script */
+static void __attribute__((noreturn))
+exec_script(const notify_script_t *script)
 {
-	pid_t pid;
 	const char *str;
 	int retval;
 	union non_const_args args;
 
-	/* Daemonization to not degrade our scheduling timer */
-#ifdef ENABLE_LOG_TO_FILE
-	if (log_file_name)
-		flush_log_file();
-#endif
-
-	pid = fork();
-
-	if (pid < 0) {
-		/* fork error */
-		log_message(LOG_INFO, "Failed fork process");
-		return -1;
-	}
-
-	if (pid) {
-		/* parent process */
-		if (func) {
-			thread_add_child(m, func, arg, pid, timer);
-#ifdef _SCRIPT_DEBUG_
-			if (do_script_debug)
-				log_message(LOG_INFO, "Running script %s with pid %d, timer %lu.%6.6lu", script->args[0], pid, timer / TIMER_HZ, timer % TIMER_HZ);
-#endif
-		}
-
-		return 0;
-	}
-
-	/* Child process */
 	reset_process_priorities();
 
 #ifdef _MEM_CHECK_
@@ -237,6 +244,326 @@ system_call_script(thread_master_t *m, thread_func_t func, void * arg, unsigned
 	exit(0); /* Script errors aren't server errors */
 }
 
+#ifndef _ONE_PROCESS_DEBUG_
+/* The script helper is a small process forked when the VRRP and checker
+ * processes start, before they have read their configuration. Forking
+ * it to run scripts is much cheaper than forking the main process.
+ * The helper returns the pid of each script it starts, and then its
+ * exit status when it terminates, followed by a SIGCHLD.
+ *
+ * The parent may still signal the process group of a script until it has
+ * processed the termination, so the helper leaves a terminated script as
+ * a zombie, keeping its pid from being reused, until the parent sends the
+ * pid back to be reaped. */
+static void
+script_helper_sigchld(__attribute__((unused)) int sig)
+{
+}
+
+static void
+script_helper_report_exits(int fd, list_head_t *children, pid_t parent)
+{
+	script_helper_child_t *child;
+	script_helper_reply_t reply = { .exited = true };
+	siginfo_t info;
+	bool sent = false;
+
+	list_for_each_entry(child, children, e_list) {
+		if (child->exited)
+			continue;
+
+		/* Collect the exit status without reaping the script */
+		info.si_pid = 0;
+		if (waitid(P_PID, (id_t)child->pid, &info, WEXITED | WNOHANG | WNOWAIT) || !info.si_pid)
+			continue;
+
+		reply.pid = child->pid;
+		if (info.si_code == CLD_EXITED)
+			reply.status = W_EXITCODE(info.si_status, 0);
+		else
+			reply.status = W_EXITCODE(0, info.si_status) | (info.si_code == CLD_DUMPED ? WCOREFLAG : 0);
+		send(fd, &reply, sizeof(reply), 0);
+
+		child->exited = true;
+		sent = true;
+	}
+
+	if (sent)
+		kill(parent, SIGCHLD);
+}
+
+static void
+script_helper_reap(list_head_t *children, pid_t pid)
+{
+	script_helper_child_t *child;
+
+	list_for_each_entry(child, children, e_list) {
+		if (child->pid == pid) {
+			waitpid(pid, NULL, 0);
+			list_del_init(&child->e_list);
+			FREE(child);
+			return;
+		}
+	}
+}
+
+static void __attribute__((noreturn))
+script_helper_run(int fd)
+{
+	script_helper_reply_t reply;
+	notify_script_t script;
+	const char *args[SCRIPT_HELPER_MAX_ARGS + 1];
+	script_helper_req_t *req = PTR_CAST(script_helper_req_t, script_helper_buf);
+	script_helper_child_t *child;
+	LIST_HEAD_INITIALIZE(children);
+	struct sigaction sa = { .sa_handler = script_helper_sigchld };
+	sigset_t sigchld, orig_mask;
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	pid_t parent = getppid();
+	ssize_t len;
+	char *p;
+	int i;
+	int sig;
+
+#ifdef _MEM_CHECK_
+	skip_mem_dump();
+#endif
+
+	set_process_name("ka_scripts");
+
+	/* Don't be affected by signals sent to all keepalived processes */
+	signal_handler_script();
+	for (sig = 1; sig <= SIGRTMAX; sig++) {
+		if (sig == SIGHUP || sig == SIGINT || sig == SIGUSR1 || sig == SIGUSR2 ||
+		    sig == SIGPIPE || sig >= SIGRTMIN)
+			signal(sig, SIG_IGN);
+	}
+
+	sigaction(SIGCHLD, &sa, NULL);
+	sigemptyset(&sigchld);
+	sigaddset(&sigchld, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &sigchld, &orig_mask);
+
+	while (true) {
+		script_helper_report_exits(fd, &children, parent);
+
+		if (ppoll(&pfd, 1, NULL, &orig_mask) < 0)
+			continue;
+
+		len = recv(fd, script_helper_buf, sizeof(script_helper_buf), 0);
+		if (len <= 0) {
+			if (len < 0 && (check_EINTR(errno) || check_EAGAIN(errno)))
+				continue;
+			break;
+		}
+
+		if (req->reap) {
+			script_helper_reap(&children, req->reap);
+			continue;
+		}
+
+		/* Rebuild the script from the request */
+		script.uid = req->uid;
+		script.gid = req->gid;
+		script.flags = req->flags;
+		script.num_args = req->num_args;
+		script.args = args;
+		for (i = 0, p = script_helper_buf + sizeof(*req); i < req->num_args; i++) {
+			args[i] = p;
+			p += strlen(p) + 1;
+		}
+		args[i] = NULL;
+
+		reply.pid = fork();
+		reply.status = 0;
+		reply.exited = false;
+		if (!reply.pid) {
+			close(fd);
+			sigprocmask(SIG_SETMASK, &orig_mask, NULL);
+			exec_script(&script);
+		}
+
+		if (reply.pid > 0) {
+			PMALLOC(child);
+			child->pid = reply.pid;
+			list_add_tail(&child->e_list, &children);
+		}
+
+		send(fd, &reply, sizeof(reply), 0);
+	}
+
+	exit(0);
+}
+
+void
+script_helper_start(void)
+{
+	int sv[2];
+	pid_t pid;
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv)) {
+		log_message(LOG_INFO, "Unable to create script helper socket - %m");
+		return;
+	}
+
+	pid = fork();
+	if (pid < 0) {
+		log_message(LOG_INFO, "Failed to fork script helper - %m");
+		close(sv[0]);
+		close(sv[1]);
+		return;
+	}
+
+	if (!pid) {
+		/* If our parent dies, we want to die too */
+		prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+		close(sv[0]);
+		script_helper_run(sv[1]);
+	}
+
+	close(sv[1]);
+	script_helper_fd = sv[0];
+}
+
+static void
+script_helper_close(void)
+{
+	log_message(LOG_INFO, "Script helper has terminated, forking scripts directly");
+
+	close(script_helper_fd);
+	script_helper_fd = -1;
+}
+
+/* Process the termination of a script, and let the helper reap it */
+static void
+script_helper_terminated(const script_helper_reply_t *reply)
+{
+	script_helper_req_t req = { .reap = reply->pid };
+
+	process_child_termination(reply->pid, reply->status);
+
+	if (send(script_helper_fd, &req, sizeof(req), 0) < 0)
+		script_helper_close();
+}
+
+/* Read script exit statuses, called when SIGCHLD is received */
+void
+script_helper_read(void)
+{
+	script_helper_reply_t reply;
+	ssize_t len;
+
+	while (script_helper_fd != -1) {
+		len = recv(script_helper_fd, &reply, sizeof(reply), MSG_DONTWAIT);
+		if (len < 0 && check_EINTR(errno))
+			continue;
+		if (len < 0 && check_EAGAIN(errno))
+			return;
+		if (len != sizeof(reply)) {
+			script_helper_close();
+			return;
+		}
+
+		if (reply.exited)
+			script_helper_terminated(&reply);
+	}
+}
+
+/* Ask the script helper to start a script. Returns the pid of the script,
+ * -1 if it couldn't be started, or 0 if the helper isn't available. */
+static pid_t
+script_helper_spawn(const notify_script_t *script)
+{
+	script_helper_req_t *req = PTR_CAST(script_helper_req_t, script_helper_buf);
+	script_helper_reply_t reply;
+	size_t len = sizeof(*req);
+	size_t arg_len;
+	ssize_t ret;
+	int i;
+
+	if (script->num_args > SCRIPT_HELPER_MAX_ARGS)
+		return 0;
+
+	req->reap = 0;
+	req->uid = script->uid;
+	req->gid = script->gid;
+	req->flags = script->flags;
+	req->num_args = script->num_args;
+	for (i = 0; i < script->num_args; i++) {
+		arg_len = strlen(script->args[i]) + 1;
+		if (len + arg_len > sizeof(script_helper_buf))
+			return 0;
+		memcpy(script_helper_buf + len, script->args[i], arg_len);
+		len += arg_len;
+	}
+
+	if (send(script_helper_fd, script_helper_buf, len, 0) < 0) {
+		script_helper_close();
+		return 0;
+	}
+
+	/* Exit statuses of other scripts may be received before the reply */
+	while (true) {
+		ret = recv(script_helper_fd, &reply, sizeof(reply), 0);
+		if (ret < 0 && check_EINTR(errno))
+			continue;
+		if (ret != sizeof(reply)) {
+			script_helper_close();
+			return 0;
+		}
+
+		if (!reply.exited)
+			return reply.pid;
+
+		script_helper_terminated(&reply);
+		if (script_helper_fd == -1)
+			return 0;
+	}
+}
+#endif
+
+int
+system_call_script(thread_master_t *m, thread_func_t func, void * arg, unsigned long timer, const notify_script_t* script)
+{
+	pid_t pid = 0;
+
+	/* Daemonization to not degrade our scheduling timer */
+#ifdef ENABLE_LOG_TO_FILE
+	if (log_file_name)
+		flush_log_file();
+#endif
+
+#ifndef _ONE_PROCESS_DEBUG_
+	if (script_helper_fd != -1)
+		pid = script_helper_spawn(script);
+	if (!pid)
+#endif
+		pid = fork();
+
+	if (pid < 0) {
+		/* fork error */
+		log_message(LOG_INFO, "Failed fork process");
+		return -1;
+	}
+
+	if (pid) {
+		/* parent process */
+		if (func) {
+			thread_add_child(m, func, arg, pid, timer);
+#ifdef _SCRIPT_DEBUG_
+			if (do_script_debug)
+				log_message(LOG_INFO, "Running script %s with pid %d, timer %lu.%6.6lu", script->args[0], pid, timer / TIMER_HZ, timer % TIMER_HZ);
+#endif
+		}
+
+		return 0;
+	}
+
+	/* Child process */
+	exec_script(script);
+}
+
 /* Execute external script/program */
 int
 notify_exec(const notify_script_t *script)
@@ -327,19 +654,24 @@ notify_fifo_close(notify_fifo_t* global_fifo, notify_fifo_t* fifo)
 static void
 child_killed_reload(thread_ref_t thread)
 {
+	pid_t pgid;
+
 	/* If the child didn't die, then force it */
-	if (thread->type == THREAD_CHILD_TIMEOUT)
-		kill(-getpgid(thread->u.c.pid), SIGKILL);
+	if (thread->type == THREAD_CHILD_TIMEOUT &&
+	    (pgid = getpgid(thread->u.c.pid)) > 0)
+		kill(-pgid, SIGKILL);
 }
 
 void
 child_killed_thread(thread_ref_t thread)
 {
 	thread_master_t *m = thread->master;
+	pid_t pgid;
 
 	/* If the child didn't die, then force it */
-	if (thread->type == THREAD_CHILD_TIMEOUT)
-		kill(-getpgid(thread->u.c.pid), SIGKILL);
+	if (thread->type == THREAD_CHILD_TIMEOUT &&
+	    (pgid = getpgid(thread->u.c.pid)) > 0)
+		kill(-pgid, SIGKILL);
 
 	/* If all children have died, we can now complete the
 	 * termination process */
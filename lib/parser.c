@@ -213,6 +213,27 @@ static bool config_file_error;
 
 /* local vars */
 static vector_t *current_keywords;
+
+/* Keywords are hashed on the keywords vector of their level and their name */
+#define KEYWORD_HASH_BITS	10
+#define KEYWORD_HASH_SIZE	(1U << KEYWORD_HASH_BITS)
+#define KEYWORD_HASH_MASK	(KEYWORD_HASH_SIZE - 1)
+static hlist_head_t keyword_hash[KEYWORD_HASH_SIZE];
+
+/* The token vectors of the lines being processed by process_stream(). There
+ * is at most one per nesting level, so the blocks are kept for reuse rather
+ * than allocating a vector and each string for every line. Words need not
+ * be separated by white space (e.g. a""), so a line can have as many words
+ * as it has characters, but fewer than MAXBUF. The strings cannot take more
+ * than one byte more than the line. */
+typedef struct _strvec_block {
+	vector_t	vec;
+	void		*slot[MAXBUF];
+	char		str[MAXBUF + MAXBUF / 2];
+
+	list_head_t	e_list;
+} strvec_block_t;
+static LIST_HEAD_INITIALIZE(strvec_blocks);	/* strvec_block_t */
 static int sublevel = 0;
 static int skip_sublevel = 0;
 static vpp_t cur_check_ptr;
@@ -812,6 +833,31 @@ set_random_seed(unsigned int seed)
 	random_seed_configured = true;
 }
 
+static unsigned __attribute__ ((pure))
+keyword_hashkey(const vector_t *keywords_vec, const char *string)
+{
+	uint32_t key = (uint32_t)((uintptr_t)keywords_vec >> 4);
+
+	while (*string)
+		key = key * 31 + (unsigned char)*string++;
+
+	return (key ^ key >> KEYWORD_HASH_BITS) & KEYWORD_HASH_MASK;
+}
+
+static keyword_t * __attribute__ ((pure))
+find_keyword(const vector_t *keywords_vec, const char *string)
+{
+	keyword_t *keyword;
+	hlist_node_t *n;
+
+	hlist_for_each_entry(keyword, n, &keyword_hash[keyword_hashkey(keywords_vec, string)], e_hash) {
+		if (keyword->level == keywords_vec && !strcmp(keyword->string, string))
+			return keyword;
+	}
+
+	return NULL;
+}
+
 static void
 keyword_alloc(vector_t *keywords_vec, const char *string, void (*handler) (const vector_t *), bool active)
 {
@@ -824,6 +870,12 @@ keyword_alloc(vector_t *keywords_vec, const char *string, void (*handler) (const
 	keyword->handler = handler;
 	keyword->active = active;
 	keyword->ptr = cur_check_ptr;
+	keyword->level = keywords_vec;
+
+	/* If a keyword is installed more than once at a level, the first
+	 * is used */
+	if (!find_keyword(keywords_vec, string))
+		hlist_add_head(&keyword->e_hash, &keyword_hash[keyword_hashkey(keywords_vec, string)]);
 
 	vector_set_slot(keywords_vec, keyword);
 }
@@ -958,6 +1010,8 @@ free_keywords(vector_t *keywords_vec)
 		keyword_vec = vector_slot(keywords_vec, i);
 		if (keyword_vec->sub)
 			free_keywords(keyword_vec->sub);
+		if (!hlist_unhashed(&keyword_vec->e_hash))
+			hlist_del(&keyword_vec->e_hash);
 		FREE(keyword_vec);
 	}
 	vector_free(keywords_vec);
@@ -1217,6 +1271,85 @@ alloc_strvec_r(const char *string)
 	return strvec;
 }
 
+/* As alloc_strvec_r(), but the vector and strings are in a single block
+ * which is reused once the line has been processed. The vector must be
+ * released with free_line_strvec(), and individual strings must not be
+ * freed. */
+static vector_t *
+alloc_line_strvec(const char *string)
+{
+	strvec_block_t *block;
+	const char *cp, *start;
+	char *str;
+	size_t str_len;
+	unsigned num = 0;
+
+	if (list_empty(&strvec_blocks)) {
+		PMALLOC(block);
+	} else {
+		block = list_first_entry(&strvec_blocks, strvec_block_t, e_list);
+		list_head_del(&block->e_list);
+	}
+	str = block->str;
+
+	cp = string;
+	while (true) {
+		cp += strspn(cp, WHITE_SPACE);
+		if (!*cp)
+			break;
+
+		start = cp;
+
+		/* Save a quoted string without the ""s as a single string */
+		if (*start == '"') {
+			start++;
+			if (!(cp = strchr(start, '"'))) {
+				report_config_error(CONFIG_UNMATCHED_QUOTE, "Unmatched quote: '%s'", string);
+				break;
+			}
+			str_len = (size_t)(cp - start);
+			cp++;
+		} else {
+			cp += strcspn(start, WHITE_SPACE_STR "\"");
+			str_len = (size_t)(cp - start);
+		}
+
+		memcpy(str, start, str_len);
+		str[str_len] = '\0';
+		block->slot[num++] = str;
+		str += str_len + 1;
+	}
+
+	block->vec.slot = block->slot;
+	block->vec.allocated = block->vec.active = num;
+
+	if (!num) {
+		list_head_add(&block->e_list, &strvec_blocks);
+		return NULL;
+	}
+
+	return &block->vec;
+}
+
+static void
+free_line_strvec(vector_t *strvec)
+{
+	strvec_block_t *block = container_of(strvec, strvec_block_t, vec);
+
+	list_head_add(&block->e_list, &strvec_blocks);
+}
+
+static void
+free_strvec_blocks(void)
+{
+	strvec_block_t *block, *block_tmp;
+
+	list_for_each_entry_safe(block, block_tmp, &strvec_blocks, e_list) {
+		list_head_del(&block->e_list);
+		FREE(block);
+	}
+}
+
 #ifdef _PARSER_DEBUG_
 static void
 dump_seq_lst(const seq_t *seq)
@@ -2986,7 +3119,7 @@ process_stream(vector_t *keywords_vec, int need_bob)
 
 	buf = MALLOC(MAXBUF);
 	while (read_line(buf, MAXBUF)) {
-		strvec = alloc_strvec(buf);
+		strvec = alloc_line_strvec(buf);
 
 		if (!strvec)
 			continue;
@@ -2999,7 +3132,7 @@ process_stream(vector_t *keywords_vec, int need_bob)
 				/* We've got the opening '{' now */
 				skip_sublevel = 1;
 				need_bob = 0;
-				free_strvec(strvec);
+				free_line_strvec(strvec);
 				continue;
 			}
 
@@ -3022,18 +3155,18 @@ process_stream(vector_t *keywords_vec, int need_bob)
 			 * next level up of keywords. */
 			if (!strcmp(str, EOB) && skip_sublevel == 0 && kw_level > 0) {
 				ret_err = true;
-				free_strvec(strvec);
+				free_line_strvec(strvec);
 				break;
 			}
 
-			free_strvec(strvec);
+			free_line_strvec(strvec);
 			continue;
 		}
 
 		if (need_bob) {
 			need_bob = 0;
 			if (!strcmp(str, BOB) && kw_level > 0) {
-				free_strvec(strvec);
+				free_line_strvec(strvec);
 				continue;
 			}
 			else
@@ -3041,79 +3174,70 @@ process_stream(vector_t *keywords_vec, int need_bob)
 		}
 		else if (!strcmp(str, BOB)) {
 			report_config_error(CONFIG_UNEXPECTED_BOB, "Unexpected '%s' - ignoring", BOB);
-			free_strvec(strvec);
+			free_line_strvec(strvec);
 			continue;
 		}
 
 		if (!strcmp(str, EOB) && kw_level > 0) {
-			free_strvec(strvec);
+			free_line_strvec(strvec);
 			break;
 		}
 
-		for (i = 0; i < vector_size(keywords_vec); i++) {
-			keyword_vec = vector_slot(keywords_vec, i);
+		if ((keyword_vec = find_keyword(keywords_vec, str))) {
+			if (!keyword_vec->active) {
+				if (!strcmp(vector_slot(strvec, vector_size(strvec)-1), BOB))
+					skip_sublevel = 1;
+				else
+					skip_sublevel = -1;
+
+				/* Sometimes a process wants to know if another process
+				 * has any of a type of configuration. For example, there
+				 * is no point starting the VRRP process of there are no
+				 * vrrp instances, and so the parent process would be
+				 * interested in that. */
+				if (keyword_vec->handler)
+					(*keyword_vec->handler)(NULL);
+			}
 
-			if (!strcmp(keyword_vec->string, str)) {
-				if (!keyword_vec->active) {
-					if (!strcmp(vector_slot(strvec, vector_size(strvec)-1), BOB))
-						skip_sublevel = 1;
-					else
-						skip_sublevel = -1;
-
-					/* Sometimes a process wants to know if another process
-					 * has any of a type of configuration. For example, there
-					 * is no point starting the VRRP process of there are no
-					 * vrrp instances, and so the parent process would be
-					 * interested in that. */
-					if (keyword_vec->handler)
-						(*keyword_vec->handler)(NULL);
+			/* There is an inconsistency here. 'static_ipaddress' for example
+			 * does not have sub levels, but needs a '{' */
+			if (keyword_vec->sub) {
+				/* Remove a trailing '{' */
+				if (!strcmp(vector_slot(strvec, vector_size(strvec)-1), BOB)) {
+					vector_unset(strvec, vector_size(strvec)-1);
+					bob_needed = 0;
 				}
+				else
+					bob_needed = 1;
+			}
 
-				/* There is an inconsistency here. 'static_ipaddress' for example
-				 * does not have sub levels, but needs a '{' */
-				if (keyword_vec->sub) {
-					/* Remove a trailing '{' */
-					char *bob = vector_slot(strvec, vector_size(strvec)-1) ;
-					if (!strcmp(bob, BOB)) {
-						vector_unset(strvec, vector_size(strvec)-1);
-						FREE(bob);
-						bob_needed = 0;
-					}
-					else
-						bob_needed = 1;
-				}
+			if (keyword_vec->active && keyword_vec->handler && (!keyword_vec->ptr || *keyword_vec->ptr)) {
+				buf_extern = buf;	/* In case the raw line wants to be accessed */
+				(*keyword_vec->handler) (strvec);
+			}
 
-				if (keyword_vec->active && keyword_vec->handler && (!keyword_vec->ptr || *keyword_vec->ptr)) {
-					buf_extern = buf;	/* In case the raw line wants to be accessed */
-					(*keyword_vec->handler) (strvec);
+			if (keyword_vec->sub) {
+				kw_level++;
+				ret = process_stream(keyword_vec->sub, bob_needed);
+				kw_level--;
+
+				/* We mustn't run any close handler if the block was skipped */
+				if (!ret &&
+				    keyword_vec->active) {
+					if (keyword_vec->sub_close_handler &&
+					    (!keyword_vec->sub_close_ptr || *keyword_vec->sub_close_ptr))
+						(*keyword_vec->sub_close_handler)();
+
+					/* We have finished the block, so the *keyword_vec->sub_close_ptr item is no longer current */
+					if (keyword_vec->sub_close_ptr)
+						*keyword_vec->sub_close_ptr = NULL;
 				}
 
-				if (keyword_vec->sub) {
-					kw_level++;
-					ret = process_stream(keyword_vec->sub, bob_needed);
-					kw_level--;
-
-					/* We mustn't run any close handler if the block was skipped */
-					if (!ret &&
-					    keyword_vec->active) {
-						if (keyword_vec->sub_close_handler &&
-						    (!keyword_vec->sub_close_ptr || *keyword_vec->sub_close_ptr))
-							(*keyword_vec->sub_close_handler)();
-
-						/* We have finished the block, so the *keyword_vec->sub_close_ptr item is no longer current */
-						if (keyword_vec->sub_close_ptr)
-							*keyword_vec->sub_close_ptr = NULL;
-					}
-
-				}
-				break;
 			}
-		}
-
-		if (i >= vector_size(keywords_vec))
+		} else
 			report_config_error(CONFIG_UNKNOWN_KEYWORD, "Unknown keyword '%s'", str);
 
-		free_strvec(strvec);
+		free_line_strvec(strvec);
 	}
 
 	current_keywords = prev_keywords;
@@ -3270,6 +3394,7 @@ init_data(const char *conf_file, const vector_t * (*init_keywords) (void), bool
 	endpwent();
 
 	free_keywords(keywords);
+	free_strvec_blocks();
 	free_parser_data();
 
 	notify_resource_release();
@@ -33,6 +33,7 @@
 #include "vector.h"
 #include "memory.h"
 #include "warnings.h"
+#include "list_head.h"
 
 
 /* Global definitions */
@@ -85,6 +86,8 @@ typedef struct _keyword {
 	bool active;
 	vpp_t ptr;
 	vpp_t sub_close_ptr;
+	const vector_t *level;		/* The keywords vector this is in */
+	hlist_node_t e_hash;		/* keyword_hash */
 } keyword_t;
 
 
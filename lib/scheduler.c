@@ -56,6 +56,7 @@
 #include "process.h"
 #include "align.h"
 #include "systemd.h"
+#include "notify.h"
 
 
 #ifdef THREAD_DUMP
@@ -240,6 +241,183 @@ register_shutdown_function(void (*func)(int))
 }
 #endif
 
+#ifdef _WITH_TIMER_WHEEL_
+static inline unsigned long
+timer_wheel_tick(const timeval_t *sands)
+{
+	return timer_long(*sands) / TIMER_WHEEL_TICK;
+}
+
+/* Find the first non-empty slot in the range [base, base + num), searching
+ * cyclically from base + start. Returns -1 if all the slots are empty. */
+static int __attribute__ ((pure))
+timer_wheel_find_slot(const timer_wheel_t *w, unsigned base, unsigned num, unsigned start)
+{
+	unsigned n, idx, bit, avail;
+	uint64_t word;
+
+	for (n = 0; n < num; n += avail) {
+		idx = (start + n) % num;
+		bit = (base + idx) % 64;
+		word = w->map[(base + idx) / 64] >> bit;
+
+		avail = 64 - bit;
+		if (avail > num - idx)
+			avail = num - idx;
+		if (avail < 64)
+			word &= (UINT64_C(1) << avail) - 1;
+
+		if (word) {
+			if (n + (unsigned)__builtin_ctzll(word) >= num)
+				return -1;
+			return (int)(base + idx + (unsigned)__builtin_ctzll(word));
+		}
+	}
+
+	return -1;
+}
+
+/* Add a timer thread to the wheel. Returns false if the timer is beyond
+ * the horizon of the wheel, in which case it must go on the rb tree. */
+static bool
+timer_wheel_insert(timer_wheel_t *w, thread_t *thread)
+{
+	unsigned long tick;
+	unsigned slot;
+
+	if (thread->sands.tv_sec == TIMER_DISABLED)
+		return false;
+
+	tick = timer_wheel_tick(&thread->sands);
+	if (tick < w->tick)
+		tick = w->tick;
+
+	if (tick - w->tick < TIMER_WHEEL_L0_SLOTS)
+		slot = tick & (TIMER_WHEEL_L0_SLOTS - 1);
+	else if ((tick >> TIMER_WHEEL_L0_BITS) - (w->tick >> TIMER_WHEEL_L0_BITS) < TIMER_WHEEL_L1_SLOTS)
+		slot = TIMER_WHEEL_L0_SLOTS + ((tick >> TIMER_WHEEL_L0_BITS) & (TIMER_WHEEL_L1_SLOTS - 1));
+	else
+		return false;
+
+	list_add_tail(&thread->e_list, &w->slot[slot]);
+	w->map[slot / 64] |= UINT64_C(1) << (slot % 64);
+	thread->wheel_slot = slot + 1;
+	w->count++;
+
+	return true;
+}
+
+static void
+timer_wheel_del(timer_wheel_t *w, thread_t *thread)
+{
+	unsigned slot = thread->wheel_slot - 1;
+
+	list_del_init(&thread->e_list);
+	if (list_empty(&w->slot[slot]))
+		w->map[slot / 64] &= ~(UINT64_C(1) << (slot % 64));
+	thread->wheel_slot = 0;
+	w->count--;
+}
+
+/* Returns the earliest expiry time of the threads on the wheel */
+static bool
+timer_wheel_earliest(timer_wheel_t *w, timeval_t *sands)
+{
+	thread_t *thread;
+	int slot;
+
+	if (!w->count)
+		return false;
+
+	slot = timer_wheel_find_slot(w, 0, TIMER_WHEEL_L0_SLOTS, w->tick & (TIMER_WHEEL_L0_SLOTS - 1));
+	if (slot < 0)
+		slot = timer_wheel_find_slot(w, TIMER_WHEEL_L0_SLOTS, TIMER_WHEEL_L1_SLOTS,
+					     ((w->tick >> TIMER_WHEEL_L0_BITS) + 1) & (TIMER_WHEEL_L1_SLOTS - 1));
+	if (slot < 0)
+		return false;
+
+	/* Threads in a slot are not sorted */
+	timerclear(sands);
+	list_for_each_entry(thread, &w->slot[slot], e_list) {
+		if (!timerisset(sands) || timercmp(&thread->sands, sands, <))
+			*sands = thread->sands;
+	}
+
+	return true;
+}
+
+/* Move the threads of a level 1 slot down to level 0 */
+static void
+timer_wheel_cascade(timer_wheel_t *w)
+{
+	unsigned slot = TIMER_WHEEL_L0_SLOTS + ((w->tick >> TIMER_WHEEL_L0_BITS) & (TIMER_WHEEL_L1_SLOTS - 1));
+	thread_t *thread, *thread_tmp;
+
+	list_for_each_entry_safe(thread, thread_tmp, &w->slot[slot], e_list) {
+		timer_wheel_del(w, thread);
+		timer_wheel_insert(w, thread);
+	}
+}
+
+/* Move expired wheel threads into ready queue */
+static void
+timer_wheel_move_ready(thread_master_t *m)
+{
+	timer_wheel_t *w = &m->timer_wheel;
+	thread_t *thread, *thread_tmp;
+	unsigned long now_tick;
+	unsigned long next_tick;
+	unsigned i;
+
+	if (!w->count)
+		return;
+
+	now_tick = timer_wheel_tick(&time_now);
+
+	for (;;) {
+		list_for_each_entry_safe(thread, thread_tmp, &w->slot[w->tick & (TIMER_WHEEL_L0_SLOTS - 1)], e_list) {
+			if (timercmp(&time_now, &thread->sands, <))
+				continue;
+
+			timer_wheel_del(w, thread);
+			list_add_tail(&thread->e_list, &m->ready);
+			if (thread->type != THREAD_TIMER_SHUTDOWN)
+				thread->type = THREAD_READY_TIMER;
+		}
+
+		if (w->tick >= now_tick || !w->count)
+			break;
+
+		/* If level 0 is empty, skip straight to the next level 1 slot */
+		for (i = 0; i < TIMER_WHEEL_L0_SLOTS / 64; i++) {
+			if (w->map[i])
+				break;
+		}
+		if (i == TIMER_WHEEL_L0_SLOTS / 64) {
+			next_tick = (w->tick | (TIMER_WHEEL_L0_SLOTS - 1)) + 1;
+			if (next_tick > now_tick) {
+				w->tick = now_tick;
+				break;
+			}
+			w->tick = next_tick;
+		} else
+			w->tick++;
+
+		if (!(w->tick & (TIMER_WHEEL_L0_SLOTS - 1)))
+			timer_wheel_cascade(w);
+	}
+}
+
+static void
+timer_wheel_init(timer_wheel_t *w)
+{
+	unsigned i;
+
+	for (i = 0; i < TIMER_WHEEL_SLOTS; i++)
+		INIT_LIST_HEAD(&w->slot[i]);
+}
+#endif
+
 /* Move ready thread into ready queue */
 static void
 thread_move_ready(thread_master_t *m, rb_root_cached_t *root, thread_t *thread, int type)
@@ -298,11 +476,19 @@ static timeval_t
 thread_set_timer(thread_master_t *m)
 {
 	timeval_t timer_wait, timer_wait_time;
+#ifdef _WITH_TIMER_WHEEL_
+	timeval_t wheel_time;
+#endif
 	struct itimerspec its;
 
 	/* Prepare timer */
 	timerclear(&timer_wait_time);
 	thread_update_timer(&m->timer, &timer_wait_time);
+#ifdef _WITH_TIMER_WHEEL_
+	if (timer_wheel_earliest(&m->timer_wheel, &wheel_time) &&
+	    (!timerisset(&timer_wait_time) || timercmp(&wheel_time, &timer_wait_time, <)))
+		timer_wait_time = wheel_time;
+#endif
 	thread_update_timer(&m->write, &timer_wait_time);
 	thread_update_timer(&m->read, &timer_wait_time);
 	thread_update_timer(&m->child, &timer_wait_time);
@@ -363,6 +549,9 @@ thread_timerfd_handler(thread_ref_t thread)
 	thread_rb_move_ready(m, &m->read, THREAD_READ_TIMEOUT);
 	thread_rb_move_ready(m, &m->write, THREAD_WRITE_TIMEOUT);
 	thread_rb_move_ready(m, &m->timer, THREAD_READY_TIMER);
+#ifdef _WITH_TIMER_WHEEL_
+	timer_wheel_move_ready(m);
+#endif
 	thread_rb_move_ready(m, &m->child, THREAD_CHILD_TIMEOUT);
 
 	/* Register next timerfd thread */
@@ -781,6 +970,9 @@ thread_make_master(void)
 	new->read = RB_ROOT_CACHED;
 	new->write = RB_ROOT_CACHED;
 	new->timer = RB_ROOT_CACHED;
+#ifdef _WITH_TIMER_WHEEL_
+	timer_wheel_init(&new->timer_wheel);
+#endif
 	new->child = RB_ROOT_CACHED;
 	new->io_events = RB_ROOT;
 	new->child_pid = RB_ROOT;
@@ -870,6 +1062,30 @@ thread_list_dump(const list_head_t *l, const char *list_type, FILE *fp)
 	conf_write(fp, "----[ End list_dump ]----");
 }
 
+#ifdef _WITH_TIMER_WHEEL_
+static void
+timer_wheel_dump(const timer_wheel_t *w, FILE *fp)
+{
+	thread_t *thread;
+	unsigned i, slot;
+
+	conf_write(fp, "----[ Begin timer_wheel_dump tick %lu, %u threads ]----", w->tick, w->count);
+
+	for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+		if (list_empty(&w->slot[slot]))
+			continue;
+
+		conf_write(fp, "  Level %u slot %u", slot < TIMER_WHEEL_L0_SLOTS ? 0U : 1U,
+			   slot < TIMER_WHEEL_L0_SLOTS ? slot : slot - TIMER_WHEEL_L0_SLOTS);
+		i = 1;
+		list_for_each_entry(thread, &w->slot[slot], e_list)
+			write_thread_entry(fp, i++, thread);
+	}
+
+	conf_write(fp, "----[ End timer_wheel_dump ]----");
+}
+#endif
+
 static void
 event_rb_dump(const rb_root_t *root, const char *tree, FILE *fp)
 {
@@ -891,6 +1107,9 @@ dump_thread_data(const thread_master_t *m, FILE *fp)
 	thread_rb_dump(&m->write, "write", fp);
 	thread_rb_dump(&m->child, "child", fp);
 	thread_rb_dump(&m->timer, "timer", fp);
+#ifdef _WITH_TIMER_WHEEL_
+	timer_wheel_dump(&m->timer_wheel, fp);
+#endif
 	thread_list_dump(&m->event, "event", fp);
 	thread_list_dump(&m->ready, "ready", fp);
 #ifdef USE_SIGNAL_THREADS
@@ -934,6 +1153,55 @@ thread_add_unuse(thread_master_t *m, thread_t *thread)
 	list_add_tail(&thread->e_list, &m->unuse);
 }
 
+#ifdef _WITH_TIMER_WHEEL_
+static void
+timer_wheel_destroy(thread_master_t *m)
+{
+	timer_wheel_t *w = &m->timer_wheel;
+	thread_t *thread, *thread_tmp;
+	unsigned i;
+
+	for (i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+		list_for_each_entry_safe(thread, thread_tmp, &w->slot[i], e_list) {
+			thread->wheel_slot = 0;
+			thread_add_unuse(m, thread);
+		}
+		INIT_LIST_HEAD(&w->slot[i]);
+	}
+
+	memset(w->map, 0, sizeof(w->map));
+	w->count = 0;
+}
+#endif
+
+/* Add a timer thread to the timer wheel, or the timer rb tree */
+static void
+thread_timer_add(thread_master_t *m, thread_t *thread)
+{
+#ifdef _WITH_TIMER_WHEEL_
+	if (!m->timer_wheel.count)
+		m->timer_wheel.tick = timer_wheel_tick(&time_now);
+
+	if (timer_wheel_insert(&m->timer_wheel, thread))
+		return;
+#endif
+
+	rb_add_cached(&thread->n, &m->timer, thread_timer_less);
+}
+
+static void
+thread_timer_del(thread_master_t *m, thread_t *thread)
+{
+#ifdef _WITH_TIMER_WHEEL_
+	if (thread->wheel_slot) {
+		timer_wheel_del(&m->timer_wheel, thread);
+		return;
+	}
+#endif
+
+	rb_erase_cached(&thread->n, &m->timer);
+}
+
 /* Move list element to unuse queue */
 static void
 thread_destroy_list(thread_master_t *m, list_head_t *l)
@@ -1008,6 +1276,9 @@ thread_cleanup_master(thread_master_t * m, bool keep_children)
 	thread_destroy_rb(m, &m->read);
 	thread_destroy_rb(m, &m->write);
 	thread_destroy_rb(m, &m->timer);
+#ifdef _WITH_TIMER_WHEEL_
+	timer_wheel_destroy(m);
+#endif
 	if (!keep_children)
 		thread_destroy_rb(m, &m->child);
 	thread_destroy_list(m, &m->event);
@@ -1331,7 +1602,7 @@ thread_add_timer_uval(thread_master_t *m, thread_func_t func, void *arg, unsigne
 	}
 
 	/* Sort by timeval. */
-	rb_add_cached(&thread->n, &m->timer, thread_timer_less);
+	thread_timer_add(m, thread);
 
 	return thread;
 }
@@ -1367,9 +1638,15 @@ timer_thread_update_timeout(thread_ref_t thread_cp, unsigned long timer)
 	if (timercmp(&thread->sands, &sands, ==))
 		return;
 
+#ifdef _WITH_TIMER_WHEEL_
+	thread_timer_del(thread->master, thread);
+	thread->sands = sands;
+	thread_timer_add(thread->master, thread);
+#else
 	thread->sands = sands;
 
 	rb_move_cached(&thread->n, &thread->master->timer, thread_timer_less);
+#endif
 }
 
 thread_ref_t
@@ -1540,7 +1817,7 @@ thread_cancel(thread_ref_t thread_cp)
 		rb_erase_cached(&thread->n, &m->write);
 		break;
 	case THREAD_TIMER:
-		rb_erase_cached(&thread->n, &m->timer);
+		thread_timer_del(m, thread);
 		break;
 	case THREAD_CHILD:
 		/* Does this need to kill the child, or is that the
@@ -2118,7 +2395,7 @@ process_threads(thread_master_t *m)
 	return 0;
 }
 
-static void
+void
 process_child_termination(pid_t pid, int status)
 {
 	thread_master_t * m = master;
@@ -2158,6 +2435,11 @@ thread_child_handler(__attribute__((unused)) void *v, __attribute__((unused)) in
 	pid_t pid;
 	int status;
 
+#ifndef _ONE_PROCESS_DEBUG_
+	/* Scripts run by the script helper are not our children */
+	script_helper_read();
+#endif
+
 	while ((pid = waitpid(-1, &status, WNOHANG))) {
 		if (pid == -1) {
 			if (errno == ECHILD)
@@ -28,6 +28,9 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <sys/timerfd.h>
+#ifdef _WITH_TIMER_WHEEL_
+#include <stdint.h>
+#endif
 #ifdef _WITH_SNMP_
 #include <sys/select.h>
 #endif
@@ -80,6 +83,20 @@ enum thread_flags {
 /* epoll def */
 #define THREAD_EPOLL_REALLOC_THRESH	64
 
+#ifdef _WITH_TIMER_WHEEL_
+/* Timer wheel def. Level 0 slots are TIMER_WHEEL_TICK wide, and each level 1
+ * slot covers a full revolution of level 0, giving a horizon of
+ * TIMER_WHEEL_TICK * 2^(L0_BITS + L1_BITS) (163.84 seconds). Later timers,
+ * and timers set to TIMER_NEVER, are kept in thread_master.timer rb tree. */
+#define TIMER_WHEEL_TICK	(TIMER_HZ / 100)
+#define TIMER_WHEEL_L0_BITS	8
+#define TIMER_WHEEL_L1_BITS	6
+#define TIMER_WHEEL_L0_SLOTS	(1U << TIMER_WHEEL_L0_BITS)
+#define TIMER_WHEEL_L1_SLOTS	(1U << TIMER_WHEEL_L1_BITS)
+#define TIMER_WHEEL_SLOTS	(TIMER_WHEEL_L0_SLOTS + TIMER_WHEEL_L1_SLOTS)
+#define TIMER_WHEEL_MAP_WORDS	(TIMER_WHEEL_SLOTS / 64)
+#endif
+
 /* Thread flags for thread destruction */
 #define THREAD_DESTROY_CLOSE_FD	0x01
 #define THREAD_DESTROY_FREE_ARG	0x02
@@ -105,6 +122,9 @@ typedef union {
 struct _thread {
 	unsigned long id;
 	thread_type_t type;		/* thread type */
+#ifdef _WITH_TIMER_WHEEL_
+	unsigned wheel_slot;		/* timer wheel slot + 1, 0 if not on wheel */
+#endif
 	struct _thread_master *master;	/* pointer to the struct thread_master. */
 	thread_func_t func;		/* event function */
 	void *arg;			/* event argument */
@@ -130,11 +150,24 @@ typedef struct _thread_event {
 	rb_node_t		n;
 } thread_event_t;
 
+#ifdef _WITH_TIMER_WHEEL_
+/* Timer wheel */
+typedef struct _timer_wheel {
+	list_head_t		slot[TIMER_WHEEL_SLOTS];
+	uint64_t		map[TIMER_WHEEL_MAP_WORDS];	/* Non-empty slots */
+	unsigned long		tick;		/* Current level 0 tick */
+	unsigned		count;		/* Number of threads on the wheel */
+} timer_wheel_t;
+#endif
+
 /* Master of the threads. */
 typedef struct _thread_master {
 	rb_root_cached_t	read;
 	rb_root_cached_t	write;
 	rb_root_cached_t	timer;
+#ifdef _WITH_TIMER_WHEEL_
+	timer_wheel_t		timer_wheel;
+#endif
 	rb_root_cached_t	child;
 	list_head_t		event;
 #ifdef USE_SIGNAL_THREADS
@@ -282,6 +315,7 @@ extern void snmp_epoll_info(thread_master_t *);
 extern void snmp_epoll_clear(thread_master_t *);
 #endif
 extern int process_threads(thread_master_t *);
+extern void process_child_termination(pid_t, int);
 extern void thread_child_handler(void *, int);
 extern void thread_add_base_threads(thread_master_t *, bool);
 extern int launch_thread_scheduler(thread_master_t *);